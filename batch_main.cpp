@@ -0,0 +1,33 @@
+#include "include/batch/batch_runner.h"
+#include "include/game/game.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Пакетный режим: lab6_batch [прогонов] [потоков] [начальный_seed]
+int main(int argc, char* argv[]) {
+    size_t runs = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 1;
+    
+    std::cout << "Прогонов: " << runs << ", потоков: " << threads
+              << ", тиков на прогон: " << Game::GAME_DURATION_SECONDS << "\n";
+    
+    BatchRunner runner(threads);
+    BatchSummary summary = runner.run(runs, seed, Game::GAME_DURATION_SECONDS);
+    
+    std::cout << "\n=== ВЫЖИВШИЕ (в среднем на прогон) ===\n";
+    for (const auto& [type, count] : summary.survivors) {
+        std::cout << "  " << type << ": " << static_cast<double>(count) / summary.runs << "\n";
+    }
+    
+    std::cout << "\n=== УБИЙСТВА (всего) ===\n";
+    for (const auto& [pair, count] : summary.kills) {
+        std::cout << "  " << pair.first << " -> " << pair.second << ": " << count << "\n";
+    }
+    
+    std::cout << "\nВремя: " << summary.elapsed_seconds << " с ("
+              << summary.runs / summary.elapsed_seconds * 60.0 << " симуляций/мин)\n";
+    
+    return 0;
+}
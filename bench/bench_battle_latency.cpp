@@ -0,0 +1,59 @@
+#include "../include/game/game.h"
+#include "../include/battle/observer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Задержка от постановки боя в очередь до его разрешения
+class LatencyObserver : public Observer {
+public:
+    void notify(const BattleEvent& event) const override {
+        auto latency = std::chrono::steady_clock::now() - event.enqueued_at;
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.push_back(std::chrono::duration<double, std::micro>(latency).count());
+    }
+
+    std::vector<double> sorted() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<double> result = samples;
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    mutable std::mutex mutex;
+    mutable std::vector<double> samples;
+};
+
+} // namespace
+
+int main() {
+    const int games = 5;
+    LatencyObserver observer;
+    
+    for (int i = 0; i < games; ++i) {
+        Game game(1000 + i, true);
+        game.subscribe(&observer);
+        game.set_timing(std::chrono::milliseconds(20), std::chrono::milliseconds(1000));
+        game.start();
+    }
+    
+    auto samples = observer.sorted();
+    if (samples.empty()) {
+        std::cout << "Боев не было\n";
+        return 0;
+    }
+    
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    std::cout << "Боев: " << samples.size() << "\n"
+              << "Задержка очередь -> разрешение, мкс: p50 " << percentile(0.5)
+              << ", p99 " << percentile(0.99)
+              << ", max " << samples.back() << "\n";
+    return 0;
+}
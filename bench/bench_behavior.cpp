@@ -0,0 +1,75 @@
+#include "../include/behavior/behavior_scheduler.h"
+#include "../include/behavior/behaviors.h"
+#include "../include/npc/squirrel.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+class OpenWorld : public BehaviorWorld {
+public:
+    void step(NPC& npc, int dx, int dy) override { npc.move(dx, dy, 10000, 10000); }
+    std::optional<Point> locate(NPCHandle) const override { return std::nullopt; }
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+struct Scenario {
+    const char* title;
+    int reach;        // патрульная точка b не дальше reach клеток от a
+    uint32_t pause_max;
+};
+
+// Возобновления сценариев в секунду на миллионе NPC: "ходоки" с дальними
+// маршрутами просыпаются почти каждый тик, "часовые" с короткими маршрутами
+// и долгими паузами - редко, и тик стоит только их пробуждений
+// bench_behavior [NPC] [тиков]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int ticks = argc > 2 ? std::stoi(argv[2]) : 100;
+    
+    std::cout << "NPC: " << count << ", тиков: " << ticks << "\n";
+    for (const Scenario& scenario : {Scenario{"ходоки", 5000, 8}, Scenario{"часовые", 5, 64}}) {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> coord(0, 9999);
+        std::uniform_int_distribution<int> offset(-scenario.reach, scenario.reach);
+        std::uniform_int_distribution<uint32_t> pause(0, scenario.pause_max);
+        
+        OpenWorld world;
+        std::vector<std::unique_ptr<Squirrel>> npcs;
+        npcs.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            npcs.push_back(std::make_unique<Squirrel>("Белка", Point(coord(rng), coord(rng))));
+        }
+        
+        BehaviorScheduler scheduler;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            Point a = npcs[i]->get_position();
+            Point b(a.get_x() + offset(rng), a.get_y() + offset(rng));
+            scheduler.spawn(static_cast<uint32_t>(i), patrol(world, *npcs[i], a, b, pause(rng)));
+        }
+        double spawn_time = seconds_since(start);
+        
+        start = std::chrono::steady_clock::now();
+        for (int t = 0; t < ticks; ++t) {
+            scheduler.advance();
+        }
+        double run_time = seconds_since(start);
+        
+        std::cout << scenario.title << ": запуск " << spawn_time * 1e9 / count << " нс/NPC, кадры "
+                  << FramePool::instance().reserved_bytes() / count << " байт/NPC, возобновлений "
+                  << static_cast<double>(scheduler.resumptions()) / ticks / count * 100
+                  << "% NPC за тик, " << scheduler.resumptions() / run_time / 1e6 << " млн/с, тик "
+                  << run_time / ticks * 1e3 << " мс\n";
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "../include/battle/battle_visitor.h"
+#include "../include/battle/variant_battle.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Счетчик убийств: одинаковый для обоих путей
+class KillCounter : public Observer {
+public:
+    void notify(const BattleEvent&) const override { ++kills; }
+    mutable size_t kills = 0;
+};
+
+// Боев в секунду: виртуальный Visitor против std::visit по NPCVariant
+// bench_dispatch [число_NPC]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 3000;
+    const int map_size = 500;
+    const double radius = 10.0;
+    const int rounds = 5;
+    
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, map_size - 1);
+    std::vector<Point> positions;
+    for (size_t i = 0; i < count; ++i) positions.emplace_back(coord(rng), coord(rng));
+    
+    auto make_npcs = [&] {
+        std::vector<std::unique_ptr<NPC>> npcs;
+        for (size_t i = 0; i < count; ++i) {
+            std::string name = "NPC_" + std::to_string(i);
+            if (i % 3 == 0) npcs.push_back(std::make_unique<Orc>(name, positions[i]));
+            else if (i % 3 == 1) npcs.push_back(std::make_unique<Druid>(name, positions[i]));
+            else npcs.push_back(std::make_unique<Squirrel>(name, positions[i]));
+        }
+        return npcs;
+    };
+    
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    const double pairs = static_cast<double>(count) * (count - 1) / 2 * rounds;
+    
+    // Все пары, как в DungeonEditor::start_battle; каждый раунд - со свежими NPC
+    double virtual_time = 0;
+    KillCounter virtual_kills;
+    for (int r = 0; r < rounds; ++r) {
+        auto npcs = make_npcs();
+        BattleVisitor visitor(radius);
+        visitor.subscribe(&virtual_kills);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < npcs.size(); ++i) {
+            visitor.set_attacker(npcs[i].get());
+            for (size_t j = i + 1; j < npcs.size(); ++j) {
+                npcs[j]->accept(visitor);
+            }
+        }
+        virtual_time += seconds_since(start);
+    }
+    
+    double variant_time = 0;
+    KillCounter variant_kills;
+    for (int r = 0; r < rounds; ++r) {
+        auto npcs = make_npcs();
+        std::vector<NPCVariant> variants;
+        variants.reserve(npcs.size());
+        for (auto& npc : npcs) variants.push_back(to_variant(*npc));
+        VariantBattle battle(radius);
+        battle.subscribe(&variant_kills);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < variants.size(); ++i) {
+            for (size_t j = i + 1; j < variants.size(); ++j) {
+                battle.fight(variants[i], variants[j]);
+            }
+        }
+        variant_time += seconds_since(start);
+    }
+    
+    std::cout << "NPC: " << count << ", пар за раунд: " << static_cast<size_t>(pairs / rounds) << "\n";
+    std::cout << "Visitor (виртуальный): " << pairs / virtual_time / 1e6 << " млн пар/с, убийств "
+              << virtual_kills.kills << "\n";
+    std::cout << "std::visit (NPCVariant): " << pairs / variant_time / 1e6 << " млн пар/с, убийств "
+              << variant_kills.kills << " (x" << virtual_time / variant_time << ")"
+              << (virtual_kills.kills == variant_kills.kills ? "" : " РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ") << "\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "../include/battle/event_manager.h"
+#include "../include/battle/battle_stats.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Пропускная способность EventManager: поштучная публикация против пакетной
+// bench_events [число_событий]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t batch_size = 256;
+    
+    std::vector<BattleEvent> events(count);
+    for (size_t i = 0; i < count; ++i) {
+        events[i].attacker_type = "Орк";
+        events[i].target_type = "Друид";
+        events[i].location = Point(static_cast<int>(i % 500), static_cast<int>(i / 500 % 500));
+        events[i].attack_roll = static_cast<int>(i % 6) + 1;
+        events[i].defense_roll = static_cast<int>(i / 6 % 6) + 1;
+        events[i].killed = i % 3 == 0;
+        events[i].tick = i / 1000;
+    }
+    
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    for (size_t observers : {1, 4, 16}) {
+        EventManager manager;
+        std::vector<std::unique_ptr<BattleStats>> stats;
+        for (size_t i = 0; i < observers; ++i) {
+            stats.push_back(std::make_unique<BattleStats>(500, 500, 50));
+            manager.subscribe(stats.back().get());
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events) {
+            manager.publish(event);
+        }
+        double single = seconds_since(start);
+        
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i += batch_size) {
+            size_t n = std::min(batch_size, count - i);
+            manager.publish_batch(std::span<const BattleEvent>(events.data() + i, n));
+        }
+        double batched = seconds_since(start);
+        
+        uint64_t fights = 0;
+        for (const auto& s : stats) fights += s->summary().fights;
+        
+        std::cout << "наблюдателей " << observers
+                  << ": publish " << count / single / 1e6 << " млн событий/с, publish_batch("
+                  << batch_size << ") " << count / batched / 1e6 << " млн событий/с (x"
+                  << single / batched << ")"
+                  << (fights == 2 * count * observers ? "" : " ПОТЕРЯНЫ СОБЫТИЯ") << "\n";
+        
+        for (const auto& s : stats) manager.unsubscribe(s.get());
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "../include/game/flow_field.h"
+#include "../include/game/terrain.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Время пересчета поля направлений на больших картах
+// bench_flow [число_источников]
+int main(int argc, char* argv[]) {
+    const size_t sources_count = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const int repeats = 3;
+    
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    for (int side : {500, 1000, 2000, 4000}) {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> coord(0, side - 1);
+        
+        // Стены-перегородки с проходами и россыпь колонн
+        TerrainMap map(side, side);
+        for (int x = side / 8; x < side; x += side / 8) {
+            map.fill_rect(x, 0, x, side - 1, TerrainMap::Cell::WALL);
+            for (int gap = 0; gap < 4; ++gap) {
+                int y = coord(rng);
+                map.fill_rect(x, y, x, y + 3, TerrainMap::Cell::FLOOR);
+            }
+        }
+        for (long i = 0; i < static_cast<long>(side) * side / 50; ++i) {
+            map.set(coord(rng), coord(rng), TerrainMap::Cell::WALL);
+        }
+        
+        std::vector<Point> sources;
+        while (sources.size() < sources_count) {
+            Point p(coord(rng), coord(rng));
+            if (map.is_passable(p)) sources.push_back(p);
+        }
+        
+        FlowField field(side, side);
+        double open_time = 0;
+        double terrain_time = 0;
+        for (int r = 0; r < repeats; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            field.rebuild(sources);
+            open_time += seconds_since(start);
+            
+            start = std::chrono::steady_clock::now();
+            field.rebuild(sources, &map);
+            terrain_time += seconds_since(start);
+        }
+        
+        // Выборка направления для миллиона NPC
+        std::vector<Point> walkers;
+        for (int i = 0; i < 1000000; ++i) walkers.emplace_back(coord(rng), coord(rng));
+        auto start = std::chrono::steady_clock::now();
+        long checksum = 0;
+        for (const Point& p : walkers) {
+            auto [dx, dy] = field.descend(p);
+            checksum += dx + 3 * dy;
+        }
+        double sample_time = seconds_since(start);
+        
+        std::cout << side << "x" << side << ", источников " << sources_count
+                  << ": пересчет " << open_time / repeats * 1e3 << " мс (открытая карта), "
+                  << terrain_time / repeats * 1e3 << " мс (с рельефом, посещено "
+                  << field.last_visited() << "), направление " << sample_time * 1e9 / walkers.size()
+                  << " нс/NPC (" << checksum % 2 << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "../include/game/npc_pool.h"
+#include "../include/geometry/morton.h"
+#include "../include/npc/orc.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Аппаратный счетчик промахов кэша текущего потока (perf_event_open);
+// недоступен без прав или в виртуальной машине - тогда только время
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd >= 0) close(fd);
+    }
+    bool available() const { return fd >= 0; }
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    uint64_t stop() {
+        uint64_t value = 0;
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) value = 0;
+        return value;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Промахи кэша при поиске соседей в порядке хранилища: до и после перестановки в Z-порядке
+// bench_locality [число_NPC]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int map_size = 4096;
+    const int cell = 16;
+    const int cells = map_size / cell;
+    
+    // NPC создаются в случайном порядке мест - как после многих тиков движения
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, map_size - 1);
+    NPCPool pool;
+    std::vector<std::vector<NPCHandle>> grid(static_cast<size_t>(cells) * cells);
+    for (size_t i = 0; i < count; ++i) {
+        Point position(coord(rng), coord(rng));
+        NPCHandle handle = pool.insert(std::make_unique<Orc>("NPC_" + std::to_string(i), position), 0);
+        grid[static_cast<size_t>(position.get_y() / cell) * cells + position.get_x() / cell].push_back(handle);
+    }
+    
+    // Для каждого NPC по порядку хранилища - соседи из его клетки сетки по дескрипторам
+    auto neighbour_pass = [&] {
+        uint64_t close = 0;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            Point p = pool.at(i)->get_position();
+            const auto& bucket = grid[static_cast<size_t>(p.get_y() / cell) * cells + p.get_x() / cell];
+            for (NPCHandle h : bucket) {
+                if (pool.get(h)->get_position().within(p, 8)) ++close;
+            }
+        }
+        return close;
+    };
+    
+    auto measure = [&](const char* label) {
+        CacheMissCounter counter;
+        counter.start();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t close = neighbour_pass();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t misses = counter.stop();
+        std::cout << label << ": " << seconds * 1e3 << " мс, промахов кэша "
+                  << (counter.available() ? std::to_string(misses) : std::string("недоступно"))
+                  << " (пар рядом: " << close << ")\n";
+        return std::make_pair(seconds, misses);
+    };
+    
+    std::cout << "NPC: " << count << "\n";
+    auto scattered = measure("случайный порядок");
+    
+    std::vector<uint64_t> keys(pool.size());
+    for (size_t i = 0; i < pool.size(); ++i) keys[i] = morton_key(pool.at(i)->get_position());
+    auto start = std::chrono::steady_clock::now();
+    pool.sort_active(keys);
+    double sort_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "поразрядная сортировка: " << sort_seconds * 1e3 << " мс\n";
+    
+    auto sorted = measure("Z-порядок");
+    std::cout << "ускорение x" << scattered.first / sorted.first;
+    if (sorted.second > 0) std::cout << ", промахов в " << static_cast<double>(scattered.second) / sorted.second << " раз меньше";
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "../include/game/game.h"
+#include "../include/npc/druid.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Время тика с уровнем детализации и без: спокойный мир (орки и белки друг
+// другу не враги) и смешанный мир, который успокаивается по мере гибели друидов
+// bench_lod [число_NPC] [тиков]
+namespace {
+
+void populate(Game& game, size_t count, bool calm) {
+    if (calm) {
+        GameCheckpoint checkpoint = game.capture_checkpoint();
+        for (auto& record : checkpoint.npcs) {
+            if (checkpoint.types[record.type] == Druid::TYPE_NAME) record.alive = false;
+        }
+        game.restore_checkpoint(checkpoint);
+    }
+
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> coord(0, Game::MAP_WIDTH - 1);
+    const char* types[] = {"Орк", "Белка", "Друид"};
+    for (size_t i = 0; i < count; ++i) {
+        const char* type = types[i % (calm ? 2 : 3)];
+        game.spawn(type, std::string(type) + "_" + std::to_string(i), Point(coord(rng), coord(rng)));
+    }
+}
+
+double tick_micros(size_t count, bool calm, bool lod, int ticks, LevelOfDetailStats& stats) {
+    Game game(1, true);
+    populate(game, count, calm);
+    game.set_level_of_detail(lod);
+    game.run_headless(8); // прогрев
+    auto start = std::chrono::steady_clock::now();
+    game.run_headless(ticks);
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+    stats = game.level_of_detail_stats();
+    return elapsed.count() / ticks;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 5000;
+    const int ticks = argc > 2 ? std::stoi(argv[2]) : 32;
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (bool calm : {true, false}) {
+        LevelOfDetailStats off_stats, on_stats;
+        double off = tick_micros(count, calm, false, ticks, off_stats);
+        double on = tick_micros(count, calm, true, ticks, on_stats);
+        uint64_t updates = on_stats.full_updates + on_stats.aggregated_updates;
+        std::cout << (calm ? "спокойный" : "смешанный") << " мир, NPC: " << count
+                  << "  без детализации: " << off << " мкс/тик"
+                  << "  с детализацией: " << on << " мкс/тик"
+                  << "  (x" << std::setprecision(2) << off / on << std::setprecision(1) << ")"
+                  << "  пропусков на обновление: " << std::setprecision(2)
+                  << (updates ? static_cast<double>(on_stats.skipped) / updates : 0.0)
+                  << std::setprecision(1) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "../include/game/npc_pool.h"
+#include "../include/game/placement.h"
+#include "../include/npc/npc_arena.h"
+#include "../include/npc/orc.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Размещение памяти NPC: пул создает поток на первом узле, обходит поток
+// движения на последнем. Без привязки страницы остаются на узле создателя
+// (на многоузловой машине - удаленный доступ), с привязкой область арены
+// переносится на узел обходчика, а плотные массивы он перевыделяет сам.
+// На одноузловой машине удаленный узел эмулируется numactl, если он есть:
+//   numactl --cpunodebind=0 --membind=0 ./bench_numa
+// показывает базовую линию, доля "своих" страниц - по move_pages.
+// Каждый случай - в отдельном процессе: арена не возвращает куски системе.
+// bench_numa [число_NPC] [проходов]
+namespace {
+
+struct Result {
+    double ns_per_npc;
+    double local_share; // доля страниц области на узле обходчика (-1 - неизвестно)
+    size_t fallbacks;   // куски Explicit без hugetlbfs
+};
+
+// Память процесса на прозрачных больших страницах, КБ
+long anon_huge_kb() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string key;
+    long value = 0;
+    while (in >> key) {
+        if (key == "AnonHugePages:" && in >> value) return value;
+        in.ignore(4096, '\n');
+    }
+    return 0;
+}
+
+Result run(size_t count, int passes, const NumaNode& walker, bool bind, HugePages pages) {
+    NPCArena::HeapLease heap = NPCArena::instance().acquire();
+    heap->set_huge_pages(pages);
+
+    NPCPool pool;
+    {
+        NPCArena::Scope scope(*heap);
+        for (size_t i = 0; i < count; ++i) {
+            pool.insert(std::make_unique<Orc>("Орк", Point(static_cast<int>(i % 4096), static_cast<int>(i / 4096))), 0);
+        }
+    }
+    if (bind) {
+        heap->bind_to_node(walker.id);
+    }
+
+    // Случайный порядок обхода - нагрузка на TLB и удаленную память
+    std::vector<uint32_t> order(pool.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), std::mt19937(3));
+
+    double seconds = 0.0;
+    std::thread worker([&] {
+        pin_current_thread(walker.cpus);
+        if (bind) {
+            pool.reallocate();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            int step = pass % 2 == 0 ? 1 : -1;
+            for (uint32_t i : order) {
+                pool.at(i)->move(step, step, 1 << 20, 1 << 20);
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    });
+    worker.join();
+
+    std::vector<size_t> per_node = heap->pages_per_node();
+    size_t total = std::accumulate(per_node.begin(), per_node.end(), size_t{0});
+    double local = -1.0;
+    if (total > 0) {
+        size_t mine = static_cast<size_t>(walker.id) < per_node.size() ? per_node[static_cast<size_t>(walker.id)] : 0;
+        local = static_cast<double>(mine) / static_cast<double>(total);
+    }
+    return {seconds * 1e9 / (static_cast<double>(count) * passes), local, heap->huge_page_fallbacks()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int passes = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    NumaTopology topology = NumaTopology::detect();
+    const NumaNode& owner = topology.nodes().front();
+    const NumaNode& walker = topology.nodes().back();
+    pin_current_thread(owner.cpus);
+    std::cout << "узлов NUMA: " << topology.nodes().size() << ", создатель - узел " << owner.id
+              << ", обходчик - узел " << walker.id << ", NPC: " << count << "\n";
+
+    struct Case {
+        const char* label;
+        bool bind;
+        HugePages pages;
+    };
+    for (const Case& c : {Case{"первое касание создателем", false, HugePages::None},
+                          Case{"арена на узле обходчика", true, HugePages::None},
+                          Case{"то же + прозрачные большие страницы", true, HugePages::Transparent},
+                          Case{"то же + hugetlbfs (или прозрачные)", true, HugePages::Explicit}}) {
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            Result result = run(count, passes, walker, c.bind, c.pages);
+            std::cout << c.label << ": " << result.ns_per_npc << " нс/NPC, страниц на узле обходчика: ";
+            if (result.local_share < 0) {
+                std::cout << "неизвестно";
+            } else {
+                std::cout << result.local_share * 100.0 << "%";
+            }
+            std::cout << ", AnonHugePages: " << anon_huge_kb() << " КБ";
+            if (c.pages == HugePages::Explicit) {
+                std::cout << ", кусков без hugetlbfs: " << result.fallbacks;
+            }
+            std::cout << std::endl;
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+    }
+    return 0;
+}
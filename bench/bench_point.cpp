@@ -0,0 +1,58 @@
+#include "../include/geometry/point.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Микробенчмарк: проверка "в радиусе" через pow/sqrt против целого квадрата
+int main() {
+    const size_t count = 4096;
+    const int rounds = 200;
+    const int radius = 10;
+    
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, 1000);
+    std::vector<Point> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        points.emplace_back(coord(rng), coord(rng));
+    }
+    
+    auto measure = [&](const char* label, auto&& in_range) {
+        auto start = std::chrono::steady_clock::now();
+        size_t hits = 0;
+        for (int r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                for (size_t j = i + 1; j < count; ++j) {
+                    hits += in_range(points[i], points[j]) ? 1 : 0;
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double pairs = static_cast<double>(rounds) * count * (count - 1) / 2;
+        std::cout << label << ": " << pairs / seconds / 1e6 << " млн пар/с (попаданий " << hits << ")\n";
+    };
+    
+    measure("pow + sqrt (double)", [radius](const Point& a, const Point& b) {
+        return std::sqrt(std::pow(a.get_x() - b.get_x(), 2) + std::pow(a.get_y() - b.get_y(), 2)) <= radius;
+    });
+    measure("within (int64 квадрат)", [radius](const Point& a, const Point& b) {
+        return a.within(b, radius);
+    });
+    
+    // Пакетная версия
+    auto start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (size_t i = 0; i < count; ++i) {
+            hits += count_within(points[i], points, radius);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "count_within (пакет): "
+              << static_cast<double>(rounds) * count * count / seconds / 1e6
+              << " млн пар/с (попаданий " << hits << ")\n";
+    
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "../include/npc/npc_factory.h"
+#include "../include/io/block_codec.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Бенчмарк сохранений: текстовый формат против сжатого (размер и пропускная способность)
+// bench_save [число_NPC]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int map_size = 1000;
+    
+    NPCFactory factory;
+    auto types = factory.get_types();
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, map_size - 1);
+    std::uniform_int_distribution<size_t> type_dist(0, types.size() - 1);
+    std::uniform_int_distribution<int> name_dist(1, 9999);
+    
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& type = types[type_dist(rng)];
+        npcs.push_back(factory.create(type, type + "_" + std::to_string(name_dist(rng)),
+                                      Point(coord(rng), coord(rng))));
+    }
+    
+    auto seconds_of = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    const std::string text_file = "bench_save.txt";
+    double text_save = seconds_of([&]() { factory.save_to_file(text_file, npcs); });
+    double text_load = seconds_of([&]() { factory.load_from_file(text_file); });
+    double text_size = static_cast<double>(std::filesystem::file_size(text_file));
+    
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    const std::string parallel_file = "bench_save_parallel.txt";
+    double parallel_one = seconds_of([&]() { factory.save_to_file_parallel(parallel_file, npcs, 1); });
+    double parallel_all = seconds_of([&]() { factory.save_to_file_parallel(parallel_file, npcs, cores); });
+    bool identical = std::filesystem::file_size(parallel_file) == std::filesystem::file_size(text_file);
+    std::remove(parallel_file.c_str());
+    
+    std::cout << "NPC: " << count << "\n";
+    std::cout << "текст:  " << text_size / 1e6 << " МБ, сохранение " << text_save
+              << " с, загрузка " << text_load << " с\n";
+    std::cout << "текст, параллельная запись: 1 поток " << parallel_one << " с, "
+              << cores << " потоков " << parallel_all << " с ("
+              << (identical ? "размер совпадает" : "РАЗМЕР ОТЛИЧАЕТСЯ") << ")\n";
+    struct Variant {
+        const char* label;
+        BlockCodec::Kind kind;
+    };
+    for (const auto& variant : {Variant{"без сжатия", BlockCodec::Kind::NONE},
+                                Variant{"LZ", BlockCodec::Kind::LZ},
+                                Variant{"zstd", BlockCodec::Kind::ZSTD}}) {
+        if (!BlockCodec::is_available(variant.kind)) {
+            std::cout << variant.label << ": не собран\n";
+            continue;
+        }
+        const std::string file = "bench_save.npcz";
+        double save = seconds_of([&]() { factory.save_compressed(file, npcs, variant.kind); });
+        double load_one = seconds_of([&]() { factory.load_compressed(file, 1); });
+        double load_all = seconds_of([&]() { factory.load_compressed(file, cores); });
+        double size = static_cast<double>(std::filesystem::file_size(file));
+        
+        std::cout << variant.label << ": " << size / 1e6 << " МБ (x" << text_size / size
+                  << " к тексту), сохранение " << save << " с (" << text_size / 1e6 / save
+                  << " МБ/с текста), загрузка 1 поток " << load_one << " с, "
+                  << cores << " потоков " << load_all << " с\n";
+        std::remove(file.c_str());
+    }
+    
+    std::remove(text_file.c_str());
+    return 0;
+}
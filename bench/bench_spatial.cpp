@@ -0,0 +1,111 @@
+#include "../include/dungeon/dungeon.h"
+#include "../include/npc/npc.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Бенчмарк пространственных запросов DungeonEditor против полного перебора
+// bench_spatial [число_NPC]
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const int map_size = 10000;
+    const int queries = 1000;
+    const char* types[] = {"Орк", "Друид", "Белка"};
+    
+    struct Record {
+        Point position;
+        int type;
+    };
+    std::vector<Record> records;
+    records.reserve(count);
+    
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, map_size - 1);
+    
+    DungeonEditor editor;
+    std::ostringstream muted;
+    auto* original = std::cout.rdbuf(muted.rdbuf());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        int type = static_cast<int>(i % 3);
+        Point position(coord(rng), coord(rng));
+        records.push_back({position, type});
+        editor.add_npc(types[type], "NPC_" + std::to_string(i), position.get_x(), position.get_y());
+        if (muted.tellp() > (1 << 20)) muted.str("");
+    }
+    std::cout.rdbuf(original);
+    std::cout << "NPC: " << count << ", построение (с add_npc) " << seconds_since(start) << " с\n";
+    
+    std::vector<Point> centers;
+    for (int q = 0; q < queries; ++q) centers.emplace_back(coord(rng), coord(rng));
+    
+    auto report = [&](const char* label, double indexed, double brute, size_t checksum_a, size_t checksum_b) {
+        std::cout << label << ": индекс " << indexed * 1e6 / queries << " мкс/запрос, перебор "
+                  << brute * 1e6 / queries << " мкс/запрос (x" << brute / indexed << ")"
+                  << (checksum_a == checksum_b ? "" : " РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ") << "\n";
+    };
+    
+    // Прямоугольник 100x100
+    size_t found_index = 0, found_brute = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : centers) {
+        found_index += editor.find_in_rect(c.get_x(), c.get_y(), c.get_x() + 99, c.get_y() + 99).size();
+    }
+    double indexed = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : centers) {
+        for (const auto& r : records) {
+            int x = r.position.get_x(), y = r.position.get_y();
+            found_brute += (x >= c.get_x() && x <= c.get_x() + 99 && y >= c.get_y() && y <= c.get_y() + 99);
+        }
+    }
+    report("прямоугольник 100x100", indexed, seconds_since(start), found_index, found_brute);
+    
+    // 10 ближайших
+    int64_t distance_index = 0, distance_brute = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : centers) {
+        for (const NPC* npc : editor.find_nearest(c.get_x(), c.get_y(), 10)) {
+            distance_index += npc->get_position().distance_sq(c);
+        }
+    }
+    indexed = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    std::vector<int64_t> distances(records.size());
+    for (const auto& c : centers) {
+        for (size_t i = 0; i < records.size(); ++i) distances[i] = records[i].position.distance_sq(c);
+        std::nth_element(distances.begin(), distances.begin() + 10, distances.end());
+        for (int i = 0; i < 10; ++i) distance_brute += distances[i];
+    }
+    report("10 ближайших", indexed, seconds_since(start),
+           static_cast<size_t>(distance_index), static_cast<size_t>(distance_brute));
+    
+    // Подсчет по типам в радиусе 50
+    size_t counted_index = 0, counted_brute = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : centers) {
+        for (const auto& [type, n] : editor.count_by_type_in_radius(c.get_x(), c.get_y(), 50.0)) {
+            counted_index += n;
+        }
+    }
+    indexed = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (const auto& c : centers) {
+        size_t per_type[3] = {0, 0, 0};
+        for (const auto& r : records) {
+            if (r.position.within(c, 50.0)) ++per_type[r.type];
+        }
+        counted_brute += per_type[0] + per_type[1] + per_type[2];
+    }
+    report("типы в радиусе 50", indexed, seconds_since(start), counted_index, counted_brute);
+    
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "../include/game/terrain.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Проверки прямой видимости на большой карте: пословный обход против поклеточного
+// bench_terrain [сторона_карты]
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::stoi(argv[1]) : 10000;
+    const int checks = 2000000;
+    
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(0, side - 1);
+    auto start = std::chrono::steady_clock::now();
+    TerrainMap map(side, side);
+    // Комнаты: редкие длинные стены и россыпь колонн
+    for (int i = 0; i < side / 20; ++i) {
+        int x = coord(rng), y = coord(rng), length = coord(rng) % 400;
+        if (i % 2) map.fill_rect(x, y, x + length, y, TerrainMap::Cell::WALL);
+        else map.fill_rect(x, y, x, y + length, TerrainMap::Cell::WALL);
+    }
+    for (long i = 0; i < static_cast<long>(side) * side / 100; ++i) {
+        map.set(coord(rng), coord(rng), TerrainMap::Cell::WALL);
+    }
+    std::cout << "Карта " << side << "x" << side << ": " << map.memory_bytes() / 1e6 << " МБ, построение "
+              << seconds_since(start) << " с\n";
+    
+    for (int reach : {10, 100, 1000}) {
+        std::uniform_int_distribution<int> offset(-reach, reach);
+        std::vector<std::pair<Point, Point>> pairs;
+        pairs.reserve(checks);
+        for (int i = 0; i < checks; ++i) {
+            Point a(coord(rng), coord(rng));
+            Point b(std::clamp(a.get_x() + offset(rng), 0, side - 1),
+                    std::clamp(a.get_y() + offset(rng), 0, side - 1));
+            pairs.emplace_back(a, b);
+        }
+        
+        size_t visible = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& [a, b] : pairs) visible += map.line_of_sight(a, b);
+        double fast = seconds_since(start);
+        
+        // Эталон на части пар - иначе слишком долго для длинных отрезков
+        size_t sample = static_cast<size_t>(std::min(checks, 200000));
+        size_t visible_reference = 0, visible_sample = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sample; ++i) {
+            bool sight = true;
+            for (const Point& p : map.line_cells(pairs[i].first, pairs[i].second)) {
+                if (map.cell(p.get_x(), p.get_y()) == TerrainMap::Cell::WALL) { sight = false; break; }
+            }
+            visible_reference += sight;
+            visible_sample += map.line_of_sight(pairs[i].first, pairs[i].second);
+        }
+        double reference = seconds_since(start) / sample * checks;
+        
+        std::cout << "отрезки до " << reach << ": " << checks / fast / 1e6 << " млн проверок/с, поклеточно "
+                  << checks / reference / 1e6 << " млн/с (видно " << visible * 100 / checks << "%)"
+                  << (visible_reference == visible_sample ? "" : " РЕЗУЛЬТАТЫ РАЗЛИЧАЮТСЯ") << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+// Итоги одного headless-прогона Game
+struct RunSummary {
+    uint64_t seed = 0;
+    std::map<std::string, size_t> survivors;                          // тип -> выжило
+    std::map<std::pair<std::string, std::string>, uint64_t> kills;    // (убийца, жертва) -> убийств
+};
+
+// Сводка по пакету прогонов
+struct BatchSummary {
+    size_t runs = 0;
+    std::map<std::string, uint64_t> survivors;
+    std::map<std::pair<std::string, std::string>, uint64_t> kills;
+    double elapsed_seconds = 0.0;
+
+    // Command: добавить итоги прогона/другой сводки
+    void merge(const RunSummary& run);
+    void merge(const BatchSummary& other);
+};
+
+// Пакетный Монте-Карло запуск независимых симуляций без рендера и задержек
+class BatchRunner {
+public:
+    explicit BatchRunner(size_t thread_count);
+
+    // Command: runs прогонов с сидами base_seed, base_seed + 1, ...
+    BatchSummary run(size_t runs, uint64_t base_seed, int ticks) const;
+
+    // Command: один детерминированный прогон в текущем потоке
+    static RunSummary run_single(uint64_t seed, int ticks);
+
+private:
+    size_t thread_count;
+};
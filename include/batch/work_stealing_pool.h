@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Пул потоков с кражей работы для набора независимых задач.
+// Каждый поток берет задачи с конца своей очереди, а опустевший поток
+// крадет с начала чужих очередей - так длинные прогоны не оставляют ядра без дела.
+class WorkStealingPool {
+public:
+    // Задача: (номер задачи, номер потока-исполнителя)
+    using Task = std::function<void(size_t task_index, size_t worker_index)>;
+
+    explicit WorkStealingPool(size_t thread_count);
+    ~WorkStealingPool();
+
+    // Запрет копирования
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Query: число потоков
+    size_t size() const;
+
+    // Command: выполнить task_count задач и дождаться завершения всех
+    void run(size_t task_count, const Task& task);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    size_t thread_count;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    bool pop_local(size_t worker, size_t& task_index);
+    bool steal(size_t thief, size_t& task_index);
+    void worker_loop(size_t worker, const Task& task);
+};
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include "../geometry/point.h"
+
+class PopulationCounters;
 
 struct BattleEvent {
     std::string action;
+    
+    // Структурированные данные боя (для статистики)
+    std::string attacker_type;
+    std::string target_type;
+    Point location;          // место встречи
+    int attack_roll = 0;     // 0 - бой без кубиков
+    int defense_roll = 0;
+    bool killed = false;
+    uint64_t tick = 0;
+    std::chrono::steady_clock::time_point enqueued_at{}; // постановка в очередь боев
+    const PopulationCounters* population = nullptr; // живые счетчики источника (уже с учетом боя)
 };
-
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "observer.h"
+#include "battle_event.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Потоковая статистика боев.
+// Каждый поток-публикатор пишет в собственный аккумулятор (шард) без блокировок,
+// шарды сливаются только при чтении - сбор не трогает npcs_mutex и cout_mutex.
+// Шард завершившегося потока достается следующему новому писателю.
+class BattleStats : public Observer {
+public:
+    static constexpr int DICE_SIDES = 6;
+
+    // Точка кривой выживания: сколько NPC типа живо после тика
+    struct SurvivalPoint {
+        uint64_t tick;
+        std::string type;
+        int64_t alive;
+    };
+
+    // Слитый результат на момент чтения
+    struct Summary {
+        uint64_t fights = 0;
+        std::map<std::pair<std::string, std::string>, uint64_t> kills; // (убийца, жертва)
+        std::array<uint64_t, DICE_SIDES> attack_rolls{};
+        std::array<uint64_t, DICE_SIDES> defense_rolls{};
+        std::vector<SurvivalPoint> survival;
+        int regions_x = 0;
+        int regions_y = 0;
+        std::vector<uint64_t> heatmap; // regions_y * regions_x, построчно
+    };
+
+    BattleStats(int map_width, int map_height, int region_size);
+    ~BattleStats() override;
+
+    // Запрет копирования
+    BattleStats(const BattleStats&) = delete;
+    BattleStats& operator=(const BattleStats&) = delete;
+
+    // Command: учет события боя (вызывается из потока боя)
+    void notify(const BattleEvent& event) const override;
+    
+    // Command: пакет событий в шард вызывающего потока
+    void notify_batch(std::span<const BattleEvent> events) const override;
+
+    // Command: начальная численность типа (основа кривой выживания)
+    void add_population(const std::string& type, size_t count);
+
+    // Query: слияние всех шардов
+    Summary summary() const;
+
+    // Query: число шардов (не больше числа одновременно писавших потоков)
+    size_t shard_count() const;
+
+    // Command: экспорт результатов
+    void export_csv(const std::string& filename) const;
+    void export_json(const std::string& filename) const;
+
+private:
+    struct Shard;
+    struct ThreadShards;
+
+    const uint64_t id;
+    const int region_size;
+    const int regions_x;
+    const int regions_y;
+
+    std::map<std::string, size_t> population;
+
+    mutable std::mutex shards_mutex; // регистрация шардов, словарь типов и слияние
+    mutable std::vector<std::unique_ptr<Shard>> shards;
+    mutable std::vector<std::string> type_names; // индексы типов в журналах убийств
+
+    Shard& local_shard() const;
+    uint32_t type_id(Shard& shard, const std::string& type) const; // поток-владелец шарда
+    int region_index(const Point& location) const;
+    void record(Shard& shard, const BattleEvent& event) const; // поток-владелец шарда
+};
@@ -4,6 +4,7 @@
 #include "event_manager.h"
 #include "observer.h"
 #include "../npc/npc.h"
+#include "../npc/population.h"
 #include <memory>
 
 // Forward declarations
@@ -29,6 +30,9 @@ public:
     // Command: добавление наблюдателя
     void subscribe(Observer* observer);
     
+    // Command: счетчики численности, уменьшаемые при убийствах (nullptr - не вести)
+    void set_population(PopulationCounters* counters);
+    
     // Command: выполнение боя
     void perform_battle(NPC& target);
     
@@ -40,10 +44,11 @@ public:
 private:
     NPC* current_attacker;
     double battle_radius;
+    PopulationCounters* population = nullptr;
     EventManager event_manager;
     
     // Приватный метод для логики боя (Tell Don't Ask)
     void execute_battle_logic(NPC& attacker, NPC& target);
-    void notify_kill(const std::string& action, const std::string& killer_name, const std::string& victim_name);
+    void notify_kill(const std::string& action, const NPC& killer, const NPC& victim);
 };
 
@@ -3,8 +3,13 @@
 #include "observer.h"
 #include "battle_event.h"
 #include <memory>
+#include <span>
 
-// PIMPL pattern для инкапсуляции и уменьшения связности
+// PIMPL pattern для инкапсуляции и уменьшения связности.
+// Список подписчиков - неизменяемый вектор (копирование при записи):
+// публикация под коротким мьютексом берет текущий список и отмечается
+// в его счетчике, наблюдателей вызывает без блокировок; подписка и
+// отписка из других потоков подменяют список целиком.
 class EventManager {
 public:
     EventManager();
@@ -16,12 +21,19 @@ public:
     EventManager(EventManager&&) noexcept;
     EventManager& operator=(EventManager&&) noexcept;
     
-    // Command: изменение состояния
+    // Command: изменение состояния (безопасно при одновременных публикациях).
+    // unsubscribe ждет (без активного ожидания), пока публикации, видевшие
+    // прежний список, завершатся - после него наблюдателя можно уничтожать.
+    // std::logic_error при вызове unsubscribe из notify этого же менеджера;
+    // subscribe из notify допустим и действует со следующей публикации.
     void subscribe(Observer* observer);
     void unsubscribe(Observer* observer);
     
     // Command: уведомление наблюдателей
     void publish(const BattleEvent& event) const;
+    
+    // Command: пакет событий - каждый наблюдатель получает его одним notify_batch
+    void publish_batch(std::span<const BattleEvent> events) const;
 
 private:
     class Impl;
@@ -1,10 +1,18 @@
 #pragma once
 
 #include "battle_event.h"
+#include <span>
 
 class Observer {
 public:
     virtual ~Observer() = default;
     virtual void notify(const BattleEvent& event) const = 0;
+    
+    // Пакет событий за одну публикацию; переопределяется наблюдателями,
+    // которым выгоднее обработать много событий разом (одна блокировка, один flush)
+    virtual void notify_batch(std::span<const BattleEvent> events) const {
+        for (const auto& event : events) {
+            notify(event);
+        }
+    }
 };
-
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "event_manager.h"
+#include "observer.h"
+#include "../npc/npc_variant.h"
+#include "../npc/population.h"
+
+// Бой для закрытого представления NPCVariant: тот же результат, что у
+// BattleVisitor, но пара (атакующий, цель) разбирается одним std::visit,
+// а вызовы методов конечных классов не виртуальные
+class VariantBattle {
+public:
+    explicit VariantBattle(double radius);
+    
+    // Запрет копирования
+    VariantBattle(const VariantBattle&) = delete;
+    VariantBattle& operator=(const VariantBattle&) = delete;
+    
+    // Query: получение радиуса
+    double get_radius() const { return battle_radius; }
+    
+    // Command: добавление наблюдателя
+    void subscribe(Observer* observer);
+    
+    // Command: счетчики численности, уменьшаемые при убийствах (nullptr - не вести)
+    void set_population(PopulationCounters* counters);
+    
+    // Command: бой пары в пределах радиуса (взаимные убийства, как в BattleVisitor)
+    void fight(NPCVariant& attacker, NPCVariant& target) {
+        std::visit([this](auto& a, auto& t) { resolve(a, t); }, attacker, target);
+    }
+
+private:
+    double battle_radius;
+    PopulationCounters* population = nullptr;
+    EventManager event_manager;
+    
+    template <typename Attacker, typename Target>
+    void resolve(Attacker& attacker, Target& target) {
+        // Пары, где никто никого не убивает, сводятся к пустому телу
+        if constexpr (kills_v<Attacker, Target> || kills_v<Target, Attacker>) {
+            if (!attacker.is_alive() || !target.is_alive() ||
+                !attacker.get_position().within(target.get_position(), battle_radius)) {
+                return;
+            }
+            if constexpr (kills_v<Attacker, Target>) {
+                target.kill();
+                notify_kill(Attacker::KILL_MESSAGE, attacker, target);
+            }
+            if constexpr (kills_v<Target, Attacker>) {
+                attacker.kill();
+                notify_kill(Target::KILL_MESSAGE, target, attacker);
+            }
+        }
+    }
+    
+    void notify_kill(const char* action, const NPC& killer, const NPC& victim);
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "behavior_task.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Планировщик сценариев по тикам: хешированное колесо таймеров на
+// WHEEL_SLOTS ячеек. На тике просматривается одна ячейка, поэтому
+// стоимость тика пропорциональна числу сценариев, срок которых наступил
+// (плюс редкие записи, ждущие дольше оборота колеса), а не числу NPC.
+// Задача адресуется ключом - для Game это индекс слота дескриптора NPC.
+// Не потокобезопасен: владелец вызывает методы под своей блокировкой.
+class BehaviorScheduler {
+public:
+    static constexpr size_t WHEEL_SLOTS = 256;
+
+    BehaviorScheduler() = default;
+    ~BehaviorScheduler();
+
+    // Запрет копирования
+    BehaviorScheduler(const BehaviorScheduler&) = delete;
+    BehaviorScheduler& operator=(const BehaviorScheduler&) = delete;
+
+    // Command: запустить сценарий под ключом (прежний сценарий ключа отменяется);
+    // первый шаг - на ближайшем advance
+    void spawn(uint32_t key, BehaviorTask task);
+
+    // Command: отменить сценарий ключа; кадры освобождаются сразу
+    void cancel(uint32_t key);
+
+    // Command: отменить все сценарии
+    void clear();
+
+    // Command: следующий тик - возобновить сценарии, срок которых наступил.
+    // Завершившиеся сценарии удаляются; исключение сценария пробрасывается
+    // после того, как остальные сценарии тика отработали
+    void advance();
+
+    // Query: ключи, возобновленные последним advance
+    const std::vector<uint32_t>& last_resumed() const { return resumed; }
+
+    // Query: есть ли у ключа активный сценарий
+    bool has_task(uint32_t key) const {
+        return key < tasks.size() && static_cast<bool>(tasks[key].handle);
+    }
+
+    // Query: активных сценариев, текущий тик, всего возобновлений
+    size_t active() const { return active_count; }
+    uint64_t now() const { return tick; }
+    uint64_t resumptions() const { return resume_count; }
+
+private:
+    struct Task {
+        BehaviorTask::Handle handle;
+        uint32_t generation = 0; // отличает отмененный сценарий ключа от нового
+    };
+
+    struct Timer {
+        uint32_t key;
+        uint32_t generation;
+        uint64_t due;
+    };
+
+    std::vector<Task> tasks;
+    std::array<std::vector<Timer>, WHEEL_SLOTS> wheel;
+    std::vector<Timer> due_now;
+    std::vector<uint32_t> resumed;
+    size_t active_count = 0;
+    uint64_t tick = 0;
+    uint64_t resume_count = 0;
+
+    void schedule(uint32_t key, uint64_t due);
+};
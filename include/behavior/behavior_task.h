@@ -0,0 +1,116 @@
+#pragma once
+
+#include "frame_pool.h"
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+// Сценарий поведения NPC - сопрограмма C++20. Кадр берется из FramePool,
+// выполнение начинается с первого тика планировщика (BehaviorScheduler).
+// Внутри сценария:
+//   co_await wait_ticks{n};     - продолжить через n тиков (0 считается как 1)
+//   co_await other_script(...); - выполнить вложенный сценарий до конца
+// Вложенные сценарии ждут тиков сами: планировщик возобновляет самую
+// глубокую приостановленную сопрограмму (leaf), а не корень.
+class BehaviorTask {
+public:
+    struct promise_type {
+        promise_type* root = this;            // корень цепочки вложенных сценариев
+        std::coroutine_handle<> leaf;         // у корня: что возобновлять на тике
+        std::coroutine_handle<> continuation; // у вложенного: кто его ждет
+        uint32_t wake_after = 1;              // у корня: через сколько тиков
+        std::exception_ptr error;
+
+        BehaviorTask get_return_object() noexcept {
+            return BehaviorTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Вложенный сценарий по окончании передает управление ждущему
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                promise_type& promise = self.promise();
+                if (promise.continuation) {
+                    promise.root->leaf = promise.continuation;
+                    return promise.continuation;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        static void* operator new(size_t size) { return FramePool::instance().allocate(size); }
+        static void operator delete(void* frame, size_t size) noexcept {
+            FramePool::instance().deallocate(frame, size);
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    BehaviorTask() = default;
+    explicit BehaviorTask(Handle handle) : handle(handle) {}
+    ~BehaviorTask() {
+        if (handle) handle.destroy();
+    }
+
+    BehaviorTask(BehaviorTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    BehaviorTask& operator=(BehaviorTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    // Запрет копирования
+    BehaviorTask(const BehaviorTask&) = delete;
+    BehaviorTask& operator=(const BehaviorTask&) = delete;
+
+    // Command: передать владение кадром (планировщику)
+    Handle release() noexcept { return std::exchange(handle, {}); }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(handle); }
+
+    // Ожидание вложенного сценария: он стартует сразу (симметричная передача),
+    // его ошибка пробрасывается в ждущий сценарий
+    struct Awaiter {
+        Handle child;
+
+        bool await_ready() const noexcept { return !child || child.done(); }
+        std::coroutine_handle<> await_suspend(Handle parent) noexcept {
+            promise_type& promise = child.promise();
+            promise.root = parent.promise().root;
+            promise.continuation = parent;
+            promise.root->leaf = child;
+            return child;
+        }
+        void await_resume() const {
+            if (child && child.promise().error) {
+                std::rethrow_exception(child.promise().error);
+            }
+        }
+    };
+    Awaiter operator co_await() && noexcept { return Awaiter{handle}; }
+
+private:
+    Handle handle;
+};
+
+// Приостановка сценария на ticks тиков планировщика
+struct wait_ticks {
+    uint32_t ticks = 1;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(BehaviorTask::Handle self) const noexcept {
+        BehaviorTask::promise_type* root = self.promise().root;
+        root->leaf = self;
+        root->wake_after = ticks > 0 ? ticks : 1;
+    }
+    void await_resume() const noexcept {}
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "behavior_task.h"
+#include "../game/npc_handle.h"
+#include "../npc/npc.h"
+#include <cstdint>
+#include <optional>
+
+// Мир, в котором выполняются сценарии: владелец NPC применяет ход с учетом
+// границ карты и рельефа и находит других NPC по дескриптору
+class BehaviorWorld {
+public:
+    virtual ~BehaviorWorld() = default;
+
+    // Command: сдвинуть NPC на (dx, dy) в пределах правил мира
+    virtual void step(NPC& npc, int dx, int dy) = 0;
+
+    // Query: позиция живого NPC; пусто, если дескриптор устарел или NPC погиб
+    virtual std::optional<Point> locate(NPCHandle target) const = 0;
+};
+
+// Базовые сценарии. Все шаги не длиннее хода NPC (get_move_distance), один шаг
+// за тик; NPC и мир должны пережить сценарий (Game отменяет сценарий при гибели).
+
+// Command: шаг к цели; true - цель достигнута
+bool step_towards(BehaviorWorld& world, NPC& self, const Point& goal);
+
+// Идти к точке; сценарий заканчивается на месте или когда путь прегражден
+BehaviorTask walk_to(BehaviorWorld& world, NPC& self, Point goal);
+
+// Обход между a и b с паузой pause_ticks в каждой точке; laps = 0 - бесконечно
+BehaviorTask patrol(BehaviorWorld& world, NPC& self, Point a, Point b, uint32_t pause_ticks, uint32_t laps = 0);
+
+// Преследовать цель, пока она жива и прошло не больше give_up_ticks тиков;
+// в пределах расстояния убийства NPC держится рядом с целью
+BehaviorTask chase(BehaviorWorld& world, NPC& self, NPCHandle target, uint32_t give_up_ticks);
+
+// Часовой: ждет wait_ticks тиков, проходит круг патруля a-b, затем преследует цель
+BehaviorTask sentry(BehaviorWorld& world, NPC& self, uint32_t wait_ticks_before, Point a, Point b,
+                    NPCHandle target, uint32_t give_up_ticks);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../memory/size_class_pool.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Пул кадров сопрограмм поведения. Кадры одного сценария одинакового размера,
+// поэтому память раздается SizeClassPool классами по SIZE_CLASS байт из общих
+// кусков по CHUNK_BYTES и возвращается в список свободных блоков своего класса:
+// миллион NPC - несколько сотен выделений у системы вместо миллиона.
+// Кадры больше MAX_POOLED_SIZE идут в обычный operator new.
+class FramePool {
+public:
+    static constexpr size_t SIZE_CLASS = 64;
+    static constexpr size_t MAX_POOLED_SIZE = 1024;
+    static constexpr size_t CHUNK_BYTES = 256 * 1024;
+
+    // Query: общий пул процесса (кадр может освобождаться в другом потоке)
+    static FramePool& instance();
+
+    // Command: блок не меньше size байт; size передается и при освобождении
+    void* allocate(size_t size);
+    void deallocate(void* block, size_t size) noexcept;
+
+    // Query: память, взятая у системы под классы, и число выданных кадров
+    size_t reserved_bytes() const;
+    size_t frames_in_use() const;
+
+private:
+    mutable std::mutex mutex;
+    SizeClassPool pool{SIZE_CLASS, MAX_POOLED_SIZE};
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    size_t oversized = 0; // кадры в обычном operator new
+};
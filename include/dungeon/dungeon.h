@@ -3,6 +3,11 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <map>
+#include <unordered_set>
+#include "../geometry/point.h"
+#include "../geometry/quadtree.h"
+#include "../npc/population.h"
 
 // Forward declarations для уменьшения связности
 class NPC;
@@ -37,22 +42,50 @@ public:
     // Command: запуск боя (изменяет состояние)
     void start_battle(double radius);
     
-    // Query: количество живых NPC
+    // Query: количество живых NPC (O(1), без перебора)
     size_t get_alive_count() const;
     
+    // Query: счетчики численности всего и по типам (чтение без блокировок)
+    const PopulationCounters& population() const { return alive_counters; }
+    
     // Query: проверка существования имени
     bool is_name_exists(const std::string& name) const;
     
     // Command: удаление мертвых NPC
     void remove_dead_npcs();
+    
+    // Пространственные запросы через индекс, без перебора всех NPC.
+    // Возвращаются указатели на NPC подземелья (без копирования),
+    // действительные до следующего изменения подземелья.
+    
+    // Query: NPC в прямоугольнике [x_min, x_max] x [y_min, y_max]
+    std::vector<const NPC*> find_in_rect(int x_min, int y_min, int x_max, int y_max) const;
+    
+    // Query: k ближайших к точке NPC по возрастанию расстояния
+    std::vector<const NPC*> find_nearest(int x, int y, size_t k) const;
+    
+    // Query: число NPC каждого типа в радиусе (граница включительно)
+    std::map<std::string, size_t> count_by_type_in_radius(int x, int y, double radius) const;
 
 private:
+    // Элемент пространственного индекса
+    struct IndexedNPC {
+        Point position;
+        const NPC* npc;
+        uint8_t type; // индекс типа в alive_counters
+    };
+    
     std::vector<std::unique_ptr<NPC>> npcs;
+    PointQuadtree<IndexedNPC> index; // все NPC из npcs
+    std::unordered_multiset<std::string> names; // загруженный файл может повторять имена
     std::unique_ptr<NPCFactory> factory;
     std::unique_ptr<ConsoleObserver> console_observer;
     std::unique_ptr<FileObserver> file_observer;
+    PopulationCounters alive_counters; // типы - в порядке фабрики
     
     // Приватные вспомогательные методы (Tell Don't Ask)
     void initialize_observers();
     void cleanup_dead_npcs();
+    void index_npc(const NPC& npc);
+    void rebuild_index();
 };
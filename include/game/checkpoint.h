@@ -0,0 +1,81 @@
+#pragma once
+
+#include "npc_handle.h"
+#include "../geometry/point.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Контрольная точка игры: все, что нужно для точного продолжения
+// (тик, состояния генераторов, раскладка хранилища NPC с дескрипторами,
+// ожидающие задачи боев, счетчики уплотнения и предфильтра).
+//
+// Бинарный формат (little-endian, varint/zigzag как в ByteWriter):
+//   u32 MAGIC, u32 VERSION, u64 тик, словарь типов, состояния трех генераторов,
+//   счетчики, поколения слотов, свободные слоты, плотный массив NPC,
+//   задачи боев, источники полей направлений (varint число типов - 0 или
+//   размер словаря, на тип varint число точек и точки), уровень детализации
+//   (varint число слотов - 0 или число поколений, на слот varint тик
+//   обновления и u8 период), u64 контрольная сумма FNV-1a всего предыдущего.
+struct GameCheckpoint {
+    static constexpr uint32_t MAGIC = 0x4B504348; // "HCPK"
+    static constexpr uint32_t VERSION = 1;
+
+    struct NPCRecord {
+        NPCHandle handle; // нулевой у сохраненных объектов погибших
+        uint8_t type = 0; // индекс в types
+        std::string name;
+        Point position;
+        bool alive = false;
+    };
+
+    struct TaskRecord {
+        NPCHandle attacker;
+        NPCHandle target;
+        Point location;
+    };
+
+    uint64_t tick = 0;
+    std::vector<std::string> types;
+
+    // Текстовые состояния std::default_random_engine (operator<<)
+    std::string movement_rng;
+    std::string battle_rng;
+    std::string init_rng;
+
+    uint64_t kills_since_compaction = 0;
+    uint64_t ticks_since_compaction = 0;
+    uint64_t filter_candidates = 0;
+    uint64_t filter_impossible = 0;
+    uint64_t filter_duplicates = 0;
+    uint64_t filter_pushed = 0;
+
+    std::vector<uint32_t> slot_generations;
+    std::vector<uint32_t> free_slots;
+    uint64_t active_count = 0;
+    std::vector<NPCRecord> npcs; // плотный порядок хранилища, затем сохраненные погибшие по типам
+    std::vector<TaskRecord> pending;
+
+    // Позиции живых по типам на последнем пересчете полей направлений;
+    // пусто, если поля не строились
+    std::vector<std::vector<Point>> flow_sources;
+
+    // Уровень детализации по слотам: тик следующего обновления и текущий
+    // период; пусто, если периоды не выбирались
+    std::vector<uint64_t> lod_due;
+    std::vector<uint8_t> lod_period;
+
+    // Command: сериализация (дописывается в out)
+    void encode(std::vector<uint8_t>& out) const;
+
+    // std::runtime_error при поврежденных данных
+    static GameCheckpoint decode(const uint8_t* data, size_t size);
+
+    // Command: запись через временный файл и rename - прежняя точка
+    // остается целой, если запись прервется
+    void save(const std::string& filename) const;
+
+    // std::runtime_error, если файл не открыт или поврежден
+    static GameCheckpoint load(const std::string& filename);
+};
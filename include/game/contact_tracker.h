@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../geometry/point.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Инкрементальный поиск контактов на равномерной сетке.
+// Контакт - неупорядоченная пара сущностей на расстоянии не больше
+// max(reach_a, reach_b). Сетка и список контактов живут между тиками;
+// refresh() пересчитывает только окрестности сущностей, которые сдвинулись,
+// появились или исчезли с прошлого вызова. Результат совпадает с полным
+// перебором (brute_force_contacts).
+class ContactTracker {
+public:
+    // cell_size должен быть не меньше максимального reach
+    ContactTracker(int map_width, int map_height, int cell_size);
+
+    // Command: положение и радиус сущности id; неизменное положение не делает ее "грязной"
+    void update(uint32_t id, const Point& position, int reach);
+
+    // Command: убрать сущность вместе с ее контактами
+    void remove(uint32_t id);
+
+    // Command: пересчитать контакты "грязных" сущностей
+    void refresh();
+
+    // Query: обход контактов, каждая пара один раз (a < b)
+    template <typename Fn>
+    void for_each_contact(Fn&& fn) const {
+        for (uint32_t a = 0; a < entities.size(); ++a) {
+            if (!entities[a].present) continue;
+            for (uint32_t b : entities[a].contacts) {
+                if (a < b) fn(a, b);
+            }
+        }
+    }
+
+    // Query: обход сущностей в ячейках, накрывающих квадрат со стороной
+    // 2 * radius вокруг center (с запасом до границ ячеек)
+    template <typename Fn>
+    void for_each_near(const Point& center, int radius, Fn&& fn) const {
+        int x0 = std::max(0, center.get_x() - radius) / cell_size;
+        int x1 = std::min(cells_x - 1, std::max(0, center.get_x() + radius) / cell_size);
+        int y0 = std::max(0, center.get_y() - radius) / cell_size;
+        int y1 = std::min(cells_y - 1, std::max(0, center.get_y() + radius) / cell_size);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                for (uint32_t id : cells[static_cast<size_t>(y) * cells_x + x]) {
+                    fn(id);
+                }
+            }
+        }
+    }
+
+    // Query: все контакты, отсортированные (для сравнения)
+    std::vector<std::pair<uint32_t, uint32_t>> contacts() const;
+
+    // Query: эталонный полный перебор по текущим положениям
+    std::vector<std::pair<uint32_t, uint32_t>> brute_force_contacts() const;
+
+    // Query: статистика последнего refresh
+    size_t last_dirty_count() const { return dirty_count; }
+    size_t last_pair_checks() const { return pair_checks; }
+
+private:
+    struct Entity {
+        Point position;
+        int reach = 0;
+        int cell = -1;
+        bool present = false;
+        bool dirty = false;
+        std::vector<uint32_t> contacts;
+    };
+
+    int cell_size;
+    int cells_x;
+    int cells_y;
+    std::vector<std::vector<uint32_t>> cells;
+    std::vector<Entity> entities;
+    std::vector<uint32_t> dirty;
+
+    size_t dirty_count = 0;
+    size_t pair_checks = 0;
+
+    int cell_of(const Point& position) const;
+    void mark_dirty(uint32_t id);
+    void unlink_contacts(uint32_t id);
+    void move_to_cell(uint32_t id, int cell);
+    static bool in_contact(const Entity& a, const Entity& b);
+};
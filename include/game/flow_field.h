@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../geometry/point.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class TerrainMap;
+
+// Поле расстояний до ближайшего из источников (многоисточниковый BFS по
+// 8 соседям, шаг - одна клетка по Чебышеву). Одно поле обслуживает всех
+// NPC, которые за этими источниками гонятся или от них бегут: направление
+// выбирается по соседним клеткам за O(1).
+class FlowField {
+public:
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    FlowField(int width, int height);
+
+    // Command: пересчитать поле; клетки, непроходимые по рельефу (если задан),
+    // не посещаются. Источники вне карты и на непроходимых клетках пропускаются
+    void rebuild(const std::vector<Point>& sources, const TerrainMap* terrain = nullptr);
+
+    // Query: расстояние до ближайшего источника (UNREACHABLE вне карты и без пути)
+    uint32_t distance(const Point& p) const;
+
+    // Query: шаг (-1..1, -1..1) к соседу с наименьшим расстоянием - к источникам;
+    // (0, 0), если ближе не подойти
+    std::pair<int, int> descend(const Point& p) const;
+
+    // Query: шаг к достижимому соседу с наибольшим расстоянием - от источников
+    std::pair<int, int> ascend(const Point& p) const;
+
+    // Query: клеток, посещенных последним пересчетом
+    size_t last_visited() const { return visited; }
+
+    int width() const { return field_width; }
+    int height() const { return field_height; }
+
+private:
+    int field_width;
+    int field_height;
+    std::vector<uint32_t> distances;
+    std::vector<uint32_t> queue; // буфер BFS (переиспользуется)
+    size_t visited = 0;
+
+    bool in_bounds(int x, int y) const {
+        return x >= 0 && y >= 0 && x < field_width && y < field_height;
+    }
+    size_t index(int x, int y) const {
+        return static_cast<size_t>(y) * field_width + x;
+    }
+    template <typename Better>
+    std::pair<int, int> best_neighbour(const Point& p, Better better) const;
+};
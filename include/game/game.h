@@ -7,16 +7,64 @@
 #include <shared_mutex>
 #include <atomic>
 #include <queue>
+#include <deque>
+#include <unordered_set>
+#include <condition_variable>
+#include <chrono>
 #include <random>
+#include <optional>
+#include <array>
+#include <functional>
 #include "../npc/npc.h"
 #include "../npc/npc_factory.h"
+#include "../npc/population.h"
+#include "world_snapshot.h"
+#include "kill_matrix.h"
+#include "npc_pool.h"
+#include "contact_tracker.h"
+#include "checkpoint.h"
+#include "type_kernels.h"
+#include "terrain.h"
+#include "flow_field.h"
+#include "placement.h"
+#include "../behavior/behavior_scheduler.h"
+#include "../behavior/behaviors.h"
+#include "../battle/event_manager.h"
+#include "../battle/observer.h"
 
-// Структура для задачи боя
+// Структура для задачи боя: дескрипторы вместо сырых указателей,
+// задача с устаревшим дескриптором отбрасывается при разрешении
 struct BattleTask {
-    NPC* attacker;
-    NPC* target;
+    NPCHandle attacker;
+    NPCHandle target;
+    Point location; // место встречи на момент обнаружения
+    std::chrono::steady_clock::time_point enqueued_at;
     
-    BattleTask(NPC* a, NPC* t) : attacker(a), target(t) {}
+    BattleTask(NPCHandle a, NPCHandle t, const Point& where = Point())
+        : attacker(a), target(t), location(where), enqueued_at(std::chrono::steady_clock::now()) {}
+    
+    // Ключ упорядоченной пары для дедупликации
+    uint64_t pair_key() const {
+        return (static_cast<uint64_t>(attacker.index) << 32) | target.index;
+    }
+};
+
+// Счетчики предфильтра пар боев (накопительные)
+struct PairFilterStats {
+    uint64_t candidates = 0; // упорядоченных пар в радиусе убийства
+    uint64_t impossible = 0; // отброшено матрицей убийств или стенами (нет видимости)
+    uint64_t duplicates = 0; // пара уже ждет разрешения
+    uint64_t pushed = 0;     // поставлено в очередь
+    
+    // Query: сэкономленные добавления в очередь
+    uint64_t saved() const { return impossible + duplicates; }
+};
+
+// Счетчики уровня детализации (накопительные)
+struct LevelOfDetailStats {
+    uint64_t full_updates = 0;       // обычных шагов
+    uint64_t aggregated_updates = 0; // суммарных шагов за несколько тиков
+    uint64_t skipped = 0;            // тиков NPC без обновления
 };
 
 // Класс для управления игрой с потоками
@@ -26,8 +74,26 @@ public:
     static constexpr int MAP_HEIGHT = 50;
     static constexpr int GAME_DURATION_SECONDS = 30;
     static constexpr int NUM_NPCS = 50;
+    // Уплотнение хранилища: не реже раза в N тиков при наличии погибших,
+    // либо сразу, когда погибших больше 1/COMPACTION_DEAD_RATIO активной области
+    static constexpr int COMPACTION_INTERVAL_TICKS = 8;
+    static constexpr int COMPACTION_DEAD_RATIO = 8;
+    // Перестановка хранилища в Z-порядке (Мортон), когда соседей по хранилищу,
+    // идущих против этого порядка, больше 1/REORDER_DESCENT_RATIO активной области
+    static constexpr int REORDER_DESCENT_RATIO = 4;
+    // Погоня и бегство: поля направлений пересчитываются раз в N тиков,
+    // добыча бежит, когда хищник ближе FLOW_FLEE_DISTANCE клеток пути
+    static constexpr int FLOW_FIELD_INTERVAL_TICKS = 4;
+    static constexpr uint32_t FLOW_FLEE_DISTANCE = 15;
+    // Уровень детализации: спокойные NPC обновляются раз в 2..LOD_MAX_PERIOD тиков,
+    // врагов ищут по сетке числа NPC каждого типа с ячейкой LOD_CELL
+    static constexpr int LOD_MAX_PERIOD = 8;
+    static constexpr int LOD_CELL = 8;
     
     Game();
+    // Детерминированная игра: все генераторы выводятся из seed,
+    // quiet отключает вывод боев в std::cout
+    explicit Game(unsigned seed, bool quiet = false);
     ~Game();
     
     // Запрет копирования
@@ -40,14 +106,154 @@ public:
     // Остановка игры
     void stop();
     
+    // Command: темп потоковой игры (по умолчанию тик 1 с, игра 30 с), до вызова start
+    void set_timing(std::chrono::milliseconds tick, std::chrono::milliseconds duration);
+    
+    // Command: размещение потоков start и памяти NPC на узлах NUMA (до вызова
+    // start и attach_behavior). std::invalid_argument для узла, которого нет
+    // в NumaTopology::detect(). Без больших страниц и узла потока движения NPC
+    // живут в обычной куче; первый запрос любого из них берет игре область
+    // NPCArena и переносит в нее уже созданных NPC (std::logic_error, если
+    // к ним привязаны сценарии). Режим и узел применяются только к области
+    // этой игры (std::runtime_error, если ядро отказало). Потоки привязываются
+    // при start; отказ ядра там - предупреждение в std::cerr
+    void set_placement(const PlacementOptions& options);
+    
+    // Query: область арены с объектами NPC этой игры; nullptr, пока
+    // set_placement ее не запросил
+    const NPCHeap* npc_memory() const { return npc_heap.get(); }
+    
+    // Command: один тик без потоков и задержек (движение, поиск и разрешение боев)
+    void step();
+    
+    // Command: headless-прогон заданного числа тиков в текущем потоке
+    void run_headless(int ticks);
+    
     // Получить список выживших NPC
     std::vector<std::string> get_survivors() const;
+    
+    // Query: последний опубликованный снимок мира (без блокировок симуляции)
+    std::shared_ptr<const WorldSnapshot> snapshot() const;
+    
+    // Command: сохранение текущего снимка в файл (формат NPCFactory)
+    void save_to_file(const std::string& filename) const;
+    
+    // Command: подписка на события боев (до вызова start)
+    void subscribe(Observer* observer);
+    
+    // Query: статистика предфильтра пар боев
+    PairFilterStats pair_filter_stats() const;
+    
+    // Command: добавить NPC, по возможности переиспользуя объект погибшего того же типа;
+    // std::invalid_argument для неизвестного типа или непроходимой клетки
+    NPCHandle spawn(const std::string& type, const std::string& name, const Point& position);
+    
+    // Query: счетчики живых всего и по типам (O(1), без блокировок;
+    // индексы типов - как в фабрике)
+    const PopulationCounters& population() const { return alive_counters; }
+    
+    // Query: число NPC в активной области хранилища (погибшие убираются между тиками)
+    size_t storage_size() const;
+    
+    // Query: число сохраненных для повторного использования объектов погибших
+    size_t retained_size() const;
+    
+    // Query: сколько раз хранилище переставлялось в Z-порядке
+    size_t locality_reorders() const;
+    
+    // Query: контрольная точка на момент последней публикации снимка (конец
+    // фазы тика). Собирается из снимка и записанного с ним состояния, без
+    // блокировок симуляции; задачи, взятые потоком боев, но еще не
+    // разрешенные, входят в точку как ожидающие
+    GameCheckpoint capture_checkpoint() const;
+    
+    // Command: сохранить контрольную точку в файл (запись вне блокировок)
+    void save_checkpoint(const std::string& filename) const;
+    
+    // Command: продолжить с контрольной точки (до вызова start);
+    // std::runtime_error, если точка повреждена или не подходит к игре
+    void load_checkpoint(const std::string& filename);
+    void restore_checkpoint(const GameCheckpoint& checkpoint);
+    
+    // Command: периодические контрольные точки в потоковой игре (до вызова start),
+    // каждые every_ticks тиков; 0 отключает
+    void set_checkpointing(const std::string& filename, uint64_t every_ticks);
+    
+    // Command: обработка по типам (до вызова start). Движение и поиск боев идут
+    // корзинами по типу через шаблонные ядра с константами типа; пары типов,
+    // где убийство невозможно, не проверяются вовсе (и не попадают в
+    // candidates/impossible статистики предфильтра). Траектории и бои те же,
+    // что в обычном режиме. std::runtime_error, если тип фабрики вне NPCVariant
+    void set_type_buckets(bool enabled);
+    
+    // Command: рельеф подземелья (до вызова start). NPC не проходят сквозь стены
+    // и воду, бой требует прямой видимости; NPC на непроходимых клетках
+    // переносятся на ближайшие проходимые. Рельеф не входит в контрольную
+    // точку - перед load_checkpoint задается та же карта.
+    // std::invalid_argument, если размеры не MAP_WIDTH x MAP_HEIGHT;
+    // std::runtime_error, если живым NPC некуда перейти (игра не меняется)
+    void set_terrain(TerrainMap map);
+    
+    // Command: погоня и бегство вместо случайного блуждания (до вызова start).
+    // На каждый тип - общее поле расстояний до NPC этого типа; хищник идет
+    // вниз по полю своей добычи, добыча при близком хищнике - вверх по его полю,
+    // остальные блуждают. Поля пересчитываются каждые every_ticks тиков; в контрольную
+    // точку входят позиции последнего пересчета, и после продолжения поля строятся
+    // по ним - траектории совпадают с непрерывным прогоном.
+    // std::invalid_argument при every_ticks < 1
+    void set_flow_movement(bool enabled, int every_ticks = FLOW_FIELD_INTERVAL_TICKS);
+    
+    // Command: сценарий поведения NPC вместо блуждания и погони. script вызывается
+    // сразу (под блокировкой) с миром игры и NPC; полученная сопрограмма
+    // возобновляется в фазе движения тех тиков, на которые она назначила себя.
+    // Сценарий отменяется при гибели NPC и не входит в контрольную точку
+    // (restore_checkpoint снимает все сценарии); сценарий, бросивший исключение,
+    // снимается с сообщением в std::cerr.
+    // std::invalid_argument, если дескриптор устарел или NPC погиб
+    void attach_behavior(NPCHandle handle, const std::function<BehaviorTask(BehaviorWorld&, NPC&)>& script);
+    
+    // Query: число NPC со сценарием поведения
+    size_t behavior_count() const;
+    
+    // Command: уровень детализации (до вызова start). NPC обновляется раз в P тиков
+    // (P - степень двойки до LOD_MAX_PERIOD) одним шагом суммарного блуждания,
+    // если ни один враждебный ему NPC (кто может убить его или кого может убить он)
+    // не ближе расстояния боя пары + P * (ход NPC + ход врага): за P тиков пара
+    // не сойдется до боя, даже идя навстречу, поэтому ни один бой не пропускается.
+    // Период выбирается заново на каждом обновлении - вошедший в радиус враг
+    // возвращает NPC к каждому тику. Погоня (set_flow_movement) и сценарии
+    // поведения идут каждый тик. Появление NPC перепланирует только соседей в
+    // радиусе угрозы. Периоды входят в контрольную точку: включенный до или после
+    // загрузки уровень детализации продолжает прогон точно; выключение сбрасывает их
+    void set_level_of_detail(bool enabled);
+    
+    // Query: текущий период обновления NPC (1 - каждый тик, 0 - дескриптор устарел)
+    int update_period(NPCHandle handle) const;
+    
+    // Query: счетчики уровня детализации
+    LevelOfDetailStats level_of_detail_stats() const;
 
 private:
-    std::vector<std::unique_ptr<NPC>> npcs;
+    // Своя область арены (только после set_placement с большими страницами или
+    // узлом): объекты NPC игры создаются в ней (NPCArena::Scope) и разрушаются
+    // раньше нее; пустая - обычная куча
+    NPCArena::HeapLease npc_heap;
+    NPCPool npcs; // тип NPC в пуле - индекс в kill_matrix
     std::unique_ptr<NPCFactory> factory;
+    KillMatrix kill_matrix;
+    ContactTracker contacts; // id контакта - индекс слота дескриптора (под npcs_mutex)
+    PopulationCounters alive_counters; // меняются под npcs_mutex, читаются без него
+    
+    // Учет для уплотнения (под npcs_mutex)
+    size_t kills_since_compaction = 0;
+    int ticks_since_compaction = 0;
+    
+    // Пространственный порядок хранилища (под npcs_mutex)
+    std::vector<uint64_t> locality_keys;
+    size_t reorders = 0;
     
     // Потоки
+    PlacementOptions placement;
     std::thread movement_thread;
     std::thread battle_thread;
     std::thread main_thread;
@@ -56,17 +262,108 @@ private:
     mutable std::shared_mutex npcs_mutex; // Для чтения/записи NPC
     mutable std::mutex cout_mutex; // Для защиты std::cout
     mutable std::mutex battle_queue_mutex; // Для очереди боев
+    std::condition_variable battle_queue_cv; // Пробуждение потока боев
     
-    // Очередь задач боев
+    // Состояние мира для читателей (RCU): каждая публикация - новый снимок,
+    // читатели копируют указатель front_state; старый снимок живет, пока его
+    // держит последний читатель. Публикуется раз за фазу тика (движение,
+    // пакет боев), а не на каждое убийство
+    std::shared_ptr<const std::vector<std::string>> snapshot_types; // словарь типов снимков
+    std::vector<std::shared_ptr<const std::string>> slot_names; // имена по слоту (под npcs_mutex)
+
+    // Остальное состояние для контрольной точки, записанное вместе со снимком
+    // под эксклюзивной блокировкой: NPC берутся из world, слоты вне снимка - свободные
+    struct PublishedState {
+        std::shared_ptr<const WorldSnapshot> world;
+        std::default_random_engine movement_rng;
+        std::default_random_engine battle_rng;
+        std::default_random_engine init_rng;
+        uint64_t kills_since_compaction = 0;
+        uint64_t ticks_since_compaction = 0;
+        PairFilterStats filter;
+        size_t slot_capacity = 0;
+        std::vector<uint32_t> free_slots;
+        std::vector<uint32_t> free_generations; // поколения слотов free_slots
+        std::vector<size_t> retained; // объекты погибших по типу
+        std::shared_ptr<const std::vector<std::vector<Point>>> flow_sources;
+        std::vector<uint64_t> lod_due;
+        std::vector<uint8_t> lod_period;
+        std::vector<BattleTask> pending; // взятые потоком боев, затем очередь
+    };
+    // Замена и копия указателя - под коротким publish_mutex, а не через
+    // std::atomic<std::shared_ptr>: его load в libstdc++ 12 снимает свой
+    // спинлок relaxed-записью, и следующая замена не упорядочена с чтением
+    std::shared_ptr<const PublishedState> front_state;
+    mutable std::mutex publish_mutex;
+    std::atomic<uint64_t> tick_count{0};
+    
+    // События боев (статистика, журналы)
+    EventManager event_manager;
+    
+    // Очередь задач боев. Разбираемый пакет лежит в battle_batch (под
+    // battle_queue_mutex): задача снимается с него только вместе с итогом
+    // боя, поэтому публикация видит ее либо ожидающей, либо разрешенной
     std::queue<BattleTask> battle_queue;
+    std::deque<BattleTask> battle_batch;
+    std::unordered_set<uint64_t> pending_pairs; // пары в очереди (под battle_queue_mutex)
+    
+    // Счетчики предфильтра
+    std::atomic<uint64_t> filter_candidates{0};
+    std::atomic<uint64_t> filter_impossible{0};
+    std::atomic<uint64_t> filter_duplicates{0};
+    std::atomic<uint64_t> filter_pushed{0};
     
     // Флаги управления
     std::atomic<bool> running;
     std::atomic<bool> game_over;
+    const bool quiet;
+    std::chrono::milliseconds tick_interval{1000};
+    std::chrono::milliseconds game_duration{GAME_DURATION_SECONDS * 1000};
+    
+    std::unique_ptr<TerrainMap> terrain; // nullptr - открытая карта
+    
+    // Погоня и бегство (под npcs_mutex): поле на тип, добыча и хищники типа
+    bool flow_movement = false;
+    bool flow_fields_built = false; // поля соответствуют flow_sources
+    // Позиции последнего пересчета по типам (nullptr - полей еще нет);
+    // неизменяемы, публикация делит их со снимком без копии
+    std::shared_ptr<const std::vector<std::vector<Point>>> flow_sources;
+    int flow_interval = FLOW_FIELD_INTERVAL_TICKS;
+    std::vector<FlowField> flow_fields;
+    std::vector<std::vector<size_t>> prey_of;
+    std::vector<std::vector<size_t>> predators_of;
+    
+    // Уровень детализации (под npcs_mutex): сетка живых по типам строится
+    // заново на каждом тике; период и тик следующего обновления - по слоту дескриптора,
+    // план тика (0 - пропуск, иначе период) - по плотному индексу
+    bool level_of_detail = false;
+    std::vector<uint32_t> lod_counts; // ячейка * число типов + тип
+    std::vector<uint64_t> lod_due;
+    std::vector<uint8_t> lod_period;
+    std::vector<uint8_t> lod_plan;
+    LevelOfDetailStats lod_stats;
+    
+    // Сценарии поведения (под эксклюзивной блокировкой npcs_mutex);
+    // ключ планировщика - индекс слота дескриптора NPC
+    class ScriptWorld;
+    std::unique_ptr<ScriptWorld> script_world;
+    BehaviorScheduler behaviors;
+    
+    // Режим обработки по типам и его буферы (только поток движения)
+    bool type_buckets = false;
+    std::vector<int> variant_of_type; // тип пула -> индекс в NPCVariant (-1 - вне набора)
+    std::vector<double> move_angles;
+    std::vector<int> move_limits;
+    std::array<std::vector<uint32_t>, NPC_TYPE_COUNT> move_buckets;
+    std::array<std::vector<std::pair<NPCHandle, NPCHandle>>, NPC_TYPE_COUNT * NPC_TYPE_COUNT> contact_buckets;
+    
+    // Периодические контрольные точки (пишет main_worker)
+    std::string checkpoint_path;
+    uint64_t checkpoint_interval = 0;
     
     // Генераторы случайных чисел (по одному на поток для thread-safety)
     mutable std::default_random_engine movement_rng; // движение
-    mutable std::default_random_engine battle_rng;  // кубики
+    mutable std::default_random_engine battle_rng;  // кубики (под эксклюзивной npcs_mutex)
     mutable std::default_random_engine init_rng;   // npc
     
     // Приватные методы потоков
@@ -74,11 +371,50 @@ private:
     void battle_worker();
     void main_worker();
     
+    // Фазы тика
+    void move_npcs();
+    void move_bucketed(); // под эксклюзивной блокировкой npcs_mutex
+    void compact_if_needed(); // под эксклюзивной блокировкой npcs_mutex
+    void reorder_if_scattered(); // под эксклюзивной блокировкой npcs_mutex
+    void run_behaviors(); // под эксклюзивной блокировкой npcs_mutex
+    void place_current_thread(int node, const char* role); // привязка рабочего потока
+    // Уровень детализации (под эксклюзивной блокировкой npcs_mutex)
+    void plan_level_of_detail();
+    int calm_period(size_t type, const Point& position, int limit) const;
+    bool type_within(size_t type, const Point& position, int radius) const;
+    int lod_radius(size_t type) const; // дальше угрозы типу нет при любом периоде
+    void reset_level_of_detail(); // все NPC перепланируются на следующем тике
+    // Шаг NPC плотного индекса с учетом рельефа и обновлением сетки контактов
+    void apply_move(size_t dense, NPC* npc, double angle, int distance);
+    void detect_battles();
+    bool resolve_next_battle(); // false - очередь пуста
+    void take_battle_queue(); // очередь - в battle_batch (под battle_queue_mutex)
+    // Кандидаты боев по корзинам пар типов (под разделяемой блокировкой npcs_mutex)
+    void collect_battles_bucketed(std::vector<BattleTask>& found, uint64_t& candidates, uint64_t& impossible);
+    // Поля направлений и выбор направления NPC (под npcs_mutex)
+    void rebuild_flow_fields(); // по текущим позициям
+    void build_flow_fields(); // по flow_sources
+    // Направление и предел шага: погоня останавливается на расстоянии до добычи
+    std::pair<double, int> flow_step(size_t dense, double random_angle, int move_distance) const;
+    // Смещение с учетом рельефа: путь обрывается перед первой преградой
+    std::pair<int, int> terrain_step(const Point& from, int dx, int dy) const;
+    bool in_sight(const Point& a, const Point& b) const {
+        return !terrain || terrain->line_of_sight(a, b);
+    }
+    
     // Вспомогательные методы
     void initialize_npcs();
     void print_map() const;
     int roll_dice() const; // Бросок 6-гранного кубика
-    void process_battle(NPC* attacker, NPC* target);
+    // Бой первой задачи battle_batch; задача снимается с пакета вместе с итогом.
+    // Событие для наблюдателей; пусто, если задача устарела или убийство невозможно
+    std::optional<BattleEvent> process_battle(const BattleTask& task);
+    void finish_battle(); // снять первую задачу battle_batch
     Point random_position() const;
+    // Снимок и состояние для контрольных точек; под эксклюзивной блокировкой
+    // npcs_mutex, battle_queue_mutex не должен быть захвачен
+    void publish_snapshot();
+    void publish_world(); // конец фазы тика: движение и поиск боев, пакет боев
+    void remember_name(NPCHandle handle, const std::string& name); // под npcs_mutex
 };
 
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NPCFactory;
+
+// Матрица "тип A может убить тип B", построенная по правилам NPC::vs
+// для всех зарегистрированных в фабрике типов
+class KillMatrix {
+public:
+    explicit KillMatrix(const NPCFactory& factory);
+
+    // Query: матрица закрытого набора NPCVariant (индекс - альтернатива
+    // варианта) по kills_v и константам классов, без фабрики
+    static const KillMatrix& closed_set();
+
+    // Query: число известных типов
+    size_t type_count() const;
+
+    // Query: индекс типа или -1, если тип неизвестен
+    int type_index(const std::string& type) const;
+
+    // Query: имя типа по индексу
+    const std::string& type_name(size_t index) const;
+
+    // Query: может ли attacker убить target
+    bool can_kill(size_t attacker, size_t target) const {
+        return matrix[attacker * types.size() + target] != 0;
+    }
+
+    // Query: может ли тип убить хоть кого-нибудь
+    bool is_predator(size_t attacker) const;
+
+    // Query: расстояние убийства типа и максимум по всем типам
+    int kill_distance(size_t type) const { return kill_distances[type]; }
+    int max_kill_distance() const;
+
+    // Query: расстояние хода типа
+    int move_distance(size_t type) const { return move_distances[type]; }
+
+private:
+    KillMatrix() = default;
+
+    std::vector<std::string> types;
+    std::vector<uint8_t> matrix;
+    std::vector<int> kill_distances;
+    std::vector<int> move_distances;
+};
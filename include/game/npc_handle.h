@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// Поколенческий дескриптор NPC: индекс в таблице дескрипторов + поколение.
+// После освобождения слота поколение растет, и старые дескрипторы
+// перестают разрешаться - устаревшие задачи боев отбрасываются безопасно.
+struct NPCHandle {
+    static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    constexpr bool is_null() const { return index == INVALID_INDEX; }
+
+    constexpr bool operator==(const NPCHandle&) const = default;
+};
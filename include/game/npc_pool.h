@@ -0,0 +1,134 @@
+#pragma once
+
+#include "npc_handle.h"
+#include "../npc/npc.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Хранилище NPC с поколенческими дескрипторами.
+// Плотные массивы (NPC, дескриптор, тип) обходятся в циклах симуляции и
+// уплотняются между тиками; разреженная таблица переводит дескриптор в
+// плотную позицию, поэтому дескрипторы переживают перестановки.
+//
+// Плотные массивы - активная область [0, size()): живые и еще не убранные
+// погибшие. Объекты убранных погибших хранятся отдельно, в списках по типу,
+// для повторного использования при спавне (не больше retained_limit на тип).
+class NPCPool {
+public:
+    static constexpr size_t DEFAULT_RETAINED_PER_TYPE = 256;
+
+    explicit NPCPool(size_t retained_per_type = DEFAULT_RETAINED_PER_TYPE)
+        : retained_limit(retained_per_type) {}
+
+    // Запрет копирования
+    NPCPool(const NPCPool&) = delete;
+    NPCPool& operator=(const NPCPool&) = delete;
+
+    // Command: добавить NPC, вернуть его дескриптор
+    NPCHandle insert(std::unique_ptr<NPC> npc, uint8_t type);
+
+    // Command: оживить сохраненный объект погибшего NPC того же типа (O(1));
+    // нулевой дескриптор, если подходящего объекта нет
+    NPCHandle recycle(uint8_t type, const std::string& name, const Point& position);
+
+    // Query: NPC по дескриптору или nullptr для устаревшего
+    NPC* get(NPCHandle handle) const;
+
+    // Query: действителен ли дескриптор
+    bool contains(NPCHandle handle) const;
+
+    // Query: текущий дескриптор занятого слота (нулевой, если слот свободен)
+    NPCHandle handle_of_slot(uint32_t index) const;
+
+    // Query: тип NPC по действительному дескриптору
+    uint8_t type_of(NPCHandle handle) const { return types[slots[handle.index].dense]; }
+
+    // Command: стабильно убрать погибших из активной области: объекты уходят
+    // в списки своего типа, сверх предела на тип - разрушаются; дескрипторы
+    // живых остаются действительны. Возвращает число убранных.
+    size_t compact();
+
+    // Command: устойчиво переставить активную область по возрастанию keys[dense]
+    // (поразрядная сортировка, O(n)); дескрипторы остаются действительны.
+    // std::invalid_argument, если ключей не size()
+    void sort_active(const std::vector<uint64_t>& keys);
+
+    // Query: плотный доступ для горячих циклов (активная область)
+    size_t size() const { return npcs.size(); }
+    NPC* at(size_t dense) const { return npcs[dense].get(); }
+    NPCHandle handle_at(size_t dense) const { return handles[dense]; }
+    uint8_t type_at(size_t dense) const { return types[dense]; }
+
+    // Command: перевыделить плотные массивы, списки погибших и таблицу дескрипторов в
+    // вызывающем потоке: страницы копий достаются его узлу NUMA (первое касание).
+    // Буферы уплотнения освобождаются и выделяются заново при следующем уплотнении
+    void reallocate();
+
+    // Command: заменить каждый объект (активной области и сохраненных
+    // погибших) результатом copy(объект, тип); дескрипторы и порядок не
+    // меняются. Если copy бросает, пул остается прежним
+    void replace_objects(const std::function<std::unique_ptr<NPC>(const NPC&, uint8_t)>& copy);
+
+    // Query: число сохраненных объектов погибших (всего и типа)
+    size_t retained() const { return retained_total; }
+    size_t retained_of(uint8_t type) const {
+        return type < retained_objects.size() ? retained_objects[type].size() : 0;
+    }
+
+    // Query: сохраненный объект погибшего по типу и номеру в списке
+    const NPC& retained_at(uint8_t type, size_t index) const { return *retained_objects[type][index]; }
+
+    // Query: число слотов таблицы дескрипторов (занятых и свободных)
+    size_t slot_capacity() const { return slots.size(); }
+
+    // Query: раскладка таблицы дескрипторов для контрольных точек
+    std::vector<uint32_t> slot_generations() const;
+    uint32_t slot_generation(uint32_t index) const { return slots[index].generation; }
+    const std::vector<uint32_t>& free_list() const { return free_slots; }
+
+    // Command: заменить содержимое сохраненной раскладкой: плотные массивы,
+    // за активной областью - объекты погибших без дескрипторов (по типам,
+    // в порядке списков), поколения слотов и порядок свободных.
+    // std::invalid_argument при несогласованных данных
+    void restore(std::vector<std::unique_ptr<NPC>> dense_npcs,
+                 std::vector<NPCHandle> dense_handles,
+                 std::vector<uint8_t> dense_types,
+                 size_t active,
+                 const std::vector<uint32_t>& generations,
+                 std::vector<uint32_t> free_list);
+
+private:
+    struct Slot {
+        uint32_t dense = 0;
+        uint32_t generation = 0;
+        bool occupied = false;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+
+    std::vector<std::unique_ptr<NPC>> npcs;
+    std::vector<NPCHandle> handles;
+    std::vector<uint8_t> types;
+
+    // Объекты убранных погибших: список на тип, спавн берет последний
+    std::vector<std::vector<std::unique_ptr<NPC>>> retained_objects;
+    size_t retained_total = 0;
+    size_t retained_limit;
+
+    // Буферы уплотнения (переиспользуются, чтобы не выделять память каждый тик)
+    std::vector<std::unique_ptr<NPC>> scratch_npcs;
+    std::vector<NPCHandle> scratch_handles;
+    std::vector<uint8_t> scratch_types;
+    std::vector<uint32_t> scratch_order;
+    std::vector<uint32_t> scratch_order_swap;
+
+    NPCHandle acquire_slot(uint32_t dense);
+    void release_slot(NPCHandle handle);
+    NPCHandle push_active(std::unique_ptr<NPC> npc, uint8_t type);
+    void retain(std::unique_ptr<NPC> npc, uint8_t type); // разрушает сверх предела
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../npc/npc_arena.h"
+#include <string>
+#include <vector>
+
+// Узел NUMA и его процессоры
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// Топология NUMA машины по /sys/devices/system/node
+class NumaTopology {
+public:
+    explicit NumaTopology(std::vector<NumaNode> nodes);
+
+    // Query: узлы с процессорами; без sysfs - один узел 0 со всеми
+    // процессорами, доступными процессу
+    static NumaTopology detect();
+
+    // Query: узлы и узел по номеру (nullptr, если его нет)
+    const std::vector<NumaNode>& nodes() const { return node_list; }
+    const NumaNode* find(int id) const;
+
+private:
+    std::vector<NumaNode> node_list;
+};
+
+// Query: номера процессоров из списка sysfs ("0-3,8,10-11");
+// std::invalid_argument при ошибке формата
+std::vector<int> parse_cpu_list(const std::string& text);
+
+// Command: привязать вызывающий поток к процессорам из cpus, доступным
+// процессу; std::runtime_error, если таких нет или ядро отказало
+void pin_current_thread(const std::vector<int>& cpus);
+
+// Размещение рабочих потоков Game::start и памяти NPC. Узел -1 - поток не
+// привязан. Поток движения - владелец NPC: он пишет их каждый тик, поэтому
+// область арены с NPC этой игры закрепляется за его узлом, а плотные массивы
+// пула он перевыделяет сам (страница достается узлу первого касания)
+struct PlacementOptions {
+    int movement_node = -1;
+    int battle_node = -1;
+    int main_node = -1;
+    HugePages huge_pages = HugePages::None;
+};
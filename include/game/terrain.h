@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../geometry/point.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Рельеф подземелья: упакованные битовые слои по 64 клетки в слове.
+// Стены непроходимы и непрозрачны, вода непроходима, но прозрачна.
+// Слой воды выделяется только при первой водной клетке, поэтому карта
+// 10000x10000 из одних стен занимает ~12.5 МБ.
+//
+// Отрезок между клетками a и b: по главной оси t = 0..major, по второй
+// k(t) = floor((2 * t * minor + major) / (2 * major)); концы упорядочиваются,
+// поэтому отрезок (и видимость) симметричны.
+class TerrainMap {
+public:
+    enum class Cell : uint8_t { FLOOR, WALL, WATER };
+
+    // Пустая карта: все клетки - пол. std::invalid_argument при неположительных размерах
+    TerrainMap(int width, int height);
+
+    // Command: тип клетки (вне карты - std::out_of_range)
+    void set(int x, int y, Cell cell);
+
+    // Command: прямоугольник [x0, x1] x [y0, y1] (обрезается по карте)
+    void fill_rect(int x0, int y0, int x1, int y1, Cell cell);
+
+    // Query: размеры
+    int width() const { return map_width; }
+    int height() const { return map_height; }
+
+    // Query: тип клетки; вне карты - стена
+    Cell cell(int x, int y) const;
+
+    // Query: можно ли стоять в клетке (в пределах карты, не стена и не вода)
+    bool is_passable(const Point& p) const;
+
+    // Query: нет ли стен на отрезке a-b, включая концы; вне карты - false.
+    // Строки пологого отрезка проверяются целыми словами по маске
+    bool line_of_sight(const Point& a, const Point& b) const;
+
+    // Query: последняя проходимая клетка на пути from -> to (движение
+    // останавливается перед первой непроходимой); from, если шагнуть некуда
+    Point walk(const Point& from, const Point& to) const;
+
+    // Query: ближайшая по Чебышеву проходимая клетка (при равенстве - первая
+    // в порядке обхода кольца); std::runtime_error, если проходимых нет
+    Point nearest_passable(const Point& p) const;
+
+    // Query: байт под битовыми слоями
+    size_t memory_bytes() const;
+
+    // Command/Query: текстовый формат - "ширина высота", затем строки
+    // из '.', '#' (стена) и '~' (вода); std::runtime_error при ошибке
+    void save(const std::string& filename) const;
+    static TerrainMap load(const std::string& filename);
+
+    // Query: клетки отрезка по порядку от a к b (эталон для проверок)
+    std::vector<Point> line_cells(const Point& a, const Point& b) const;
+
+private:
+    int map_width;
+    int map_height;
+    size_t words_per_row;
+    std::vector<uint64_t> walls;
+    std::vector<uint64_t> water; // пусто, пока воды нет
+
+    bool in_bounds(int x, int y) const {
+        return x >= 0 && y >= 0 && x < map_width && y < map_height;
+    }
+    static bool test(const std::vector<uint64_t>& layer, size_t row_offset, int x) {
+        return (layer[row_offset + (static_cast<size_t>(x) >> 6)] >> (x & 63)) & 1u;
+    }
+    bool is_wall(int x, int y) const {
+        return test(walls, static_cast<size_t>(y) * words_per_row, x);
+    }
+    bool is_blocked(int x, int y) const;
+    // Есть ли стена в строке y на [x0, x1]
+    bool any_wall_in_row(int y, int x0, int x1) const;
+};
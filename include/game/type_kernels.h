@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../npc/npc_variant.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// Обход закрытого набора типов NPCVariant во время компиляции: тело
+// инстанцируется отдельно для каждого типа (пары типов), поэтому расстояния
+// хода и убийства - константы, а вызовы методов конечных классов не виртуальные
+
+// Число типов закрытого набора
+inline constexpr size_t NPC_TYPE_COUNT = std::variant_size_v<NPCVariant>;
+
+// Тип закрытого набора по индексу альтернативы
+template <size_t I>
+using NPCTypeAt = std::variant_alternative_t<I, NPCVariant>;
+
+// Может ли тип убить хоть кого-нибудь из закрытого набора
+template <typename Attacker>
+inline constexpr bool is_predator_v = []<size_t... I>(std::index_sequence<I...>) {
+    return (kills_v<Attacker, NPCTypeAt<I>> || ...);
+}(std::make_index_sequence<NPC_TYPE_COUNT>{});
+
+// fn(std::integral_constant<size_t, I>) для каждого типа
+template <typename Fn>
+void for_each_npc_type(Fn&& fn) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (fn(std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<NPC_TYPE_COUNT>{});
+}
+
+// fn(I, J) для неупорядоченных пар типов I <= J, где возможно убийство хотя бы
+// в одну сторону; пары, в которых никто никого не убивает, не инстанцируются
+template <typename Fn>
+void for_each_hostile_type_pair(Fn&& fn) {
+    for_each_npc_type([&](auto i) {
+        for_each_npc_type([&](auto j) {
+            constexpr size_t I = decltype(i)::value;
+            constexpr size_t J = decltype(j)::value;
+            if constexpr (I <= J && (kills_v<NPCTypeAt<I>, NPCTypeAt<J>> ||
+                                     kills_v<NPCTypeAt<J>, NPCTypeAt<I>>)) {
+                fn(i, j);
+            }
+        });
+    });
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../geometry/point.h"
+#include "npc_handle.h"
+
+// Состояние одного NPC на момент публикации снимка
+struct NPCState {
+    NPCHandle handle; // стабильный идентификатор между снимками
+    std::shared_ptr<const std::string> name; // общая строка слота, не копия; nullptr - пустой слот
+    uint8_t type = 0; // индекс в WorldSnapshot::types
+    Point position;
+    bool alive = false;
+};
+
+// Неизменяемый снимок мира: публикуется симуляцией атомарной заменой указателя,
+// читатели (рендер, статистика, сохранение) работают с ним без блокировок
+struct WorldSnapshot {
+    uint64_t tick = 0;
+    std::shared_ptr<const std::vector<std::string>> types; // словарь типов игры
+    std::vector<NPCState> npcs;
+
+    // Query: количество живых NPC в снимке
+    size_t alive_count() const;
+
+    // Query: имя типа и имя NPC (пустая строка для пустого слота)
+    const std::string& type_name(const NPCState& state) const;
+    static const std::string& name_of(const NPCState& state);
+};
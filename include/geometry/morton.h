@@ -0,0 +1,24 @@
+#pragma once
+
+#include "point.h"
+#include <cstdint>
+
+// Ключ Мортона (Z-порядок): близкие на карте точки получают близкие ключи
+
+// Биты value на четных позициях 64-битного числа
+constexpr uint64_t morton_spread_bits(uint32_t value) {
+    uint64_t x = value;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x;
+}
+
+// Query: чередование битов x и y (сдвиг знака сохраняет порядок отрицательных)
+constexpr uint64_t morton_key(const Point& position) {
+    uint32_t x = static_cast<uint32_t>(position.get_x()) ^ 0x80000000u;
+    uint32_t y = static_cast<uint32_t>(position.get_y()) ^ 0x80000000u;
+    return morton_spread_bits(x) | (morton_spread_bits(y) << 1);
+}
@@ -2,24 +2,82 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 
+// Header-only тривиально копируемая точка: все операции встраиваются
+// в вызывающий код, сравнения расстояний выполняются в целых квадратах
 class Point {
 private:
-    int x;
-    int y;
+    int x = 0;
+    int y = 0;
 
 public:
-    Point();
+    constexpr Point() = default;
 
-    Point(int x, int y);
+    constexpr Point(int x, int y) : x(x), y(y) {}
 
-    void set_x(int x);
+    constexpr void set_x(int x) { this->x = x; }
 
-    void set_y(int y);
+    constexpr void set_y(int y) { this->y = y; }
 
-    int get_x() const;
+    constexpr int get_x() const { return x; }
 
-    int get_y() const;
+    constexpr int get_y() const { return y; }
 
-    double distance_to(const Point& other) const;
+    // Query: квадрат расстояния (точный, без sqrt)
+    constexpr int64_t distance_sq(const Point& other) const {
+        int64_t dx = static_cast<int64_t>(x) - other.x;
+        int64_t dy = static_cast<int64_t>(y) - other.y;
+        return dx * dx + dy * dy;
+    }
+
+    // Query: находится ли other в радиусе r (граница включительно)
+    constexpr bool within(const Point& other, int radius) const {
+        int64_t r = radius;
+        return radius >= 0 && distance_sq(other) <= r * r;
+    }
+
+    constexpr bool within(const Point& other, double radius) const {
+        return radius >= 0.0 && static_cast<double>(distance_sq(other)) <= radius * radius;
+    }
+
+    double distance_to(const Point& other) const {
+        return std::sqrt(static_cast<double>(distance_sq(other)));
+    }
 };
+
+static_assert(std::is_trivially_copyable_v<Point>);
+
+// Пакетные версии над непрерывными массивами точек
+
+// Command: out[i] = квадрат расстояния от origin до points[i]
+inline void distance_sq_batch(const Point& origin, std::span<const Point> points, std::span<int64_t> out) {
+    const size_t count = points.size() < out.size() ? points.size() : out.size();
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = origin.distance_sq(points[i]);
+    }
+}
+
+// Query: число точек в радиусе
+inline size_t count_within(const Point& origin, std::span<const Point> points, int radius) {
+    size_t count = 0;
+    for (const Point& point : points) {
+        count += origin.within(point, radius) ? 1 : 0;
+    }
+    return count;
+}
+
+// Command: индексы точек в радиусе записываются в out, возвращается их число
+inline size_t select_within(const Point& origin, std::span<const Point> points, int radius,
+                            std::span<uint32_t> out) {
+    size_t found = 0;
+    for (size_t i = 0; i < points.size() && found < out.size(); ++i) {
+        if (origin.within(points[i], radius)) {
+            out[found++] = static_cast<uint32_t>(i);
+        }
+    }
+    return found;
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "point.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Точечное дерево квадрантов для элементов с полем `Point position`.
+// Листья хранят до leaf_capacity элементов и делятся при переполнении;
+// после удаления поддерево, где осталось не больше leaf_capacity элементов,
+// снова сворачивается в лист. Корень растет удвоением, поэтому координаты
+// не ограничены заранее. Указатели на элементы действительны до следующего
+// изменения дерева.
+template <typename Item>
+class PointQuadtree {
+public:
+    explicit PointQuadtree(size_t leaf_capacity = 16) : capacity(std::max<size_t>(1, leaf_capacity)) {}
+
+    // Command: добавить элемент
+    void insert(const Item& item) {
+        const Point& p = item.position;
+        if (root < 0) {
+            root = allocate(align_down(p.get_x()), align_down(p.get_y()), INITIAL_SIZE);
+        }
+        while (!contains(nodes[root], p)) {
+            grow_towards(p);
+        }
+        insert_into(root, item);
+    }
+
+    // Command: удалить первый элемент в position, для которого matches(item) истинно
+    template <typename Pred>
+    bool remove(const Point& position, Pred&& matches) {
+        if (root < 0 || !contains(nodes[root], position)) {
+            return false;
+        }
+        return remove_from(root, position, matches);
+    }
+
+    // Query: обход элементов в прямоугольнике [min_x, max_x] x [min_y, max_y]
+    template <typename Fn>
+    void for_each_in_rect(int min_x, int min_y, int max_x, int max_y, Fn&& fn) const {
+        if (root >= 0 && min_x <= max_x && min_y <= max_y) {
+            visit_rect(root, min_x, min_y, max_x, max_y, fn);
+        }
+    }
+
+    // Query: обход элементов в круге (граница включительно)
+    template <typename Fn>
+    void for_each_in_radius(const Point& center, double radius, Fn&& fn) const {
+        if (radius < 0) {
+            return;
+        }
+        int reach = static_cast<int>(std::ceil(radius));
+        for_each_in_rect(center.get_x() - reach, center.get_y() - reach,
+                         center.get_x() + reach, center.get_y() + reach,
+                         [&](const Item& item) {
+                             if (item.position.within(center, radius)) fn(item);
+                         });
+    }
+
+    // Query: k ближайших к точке элементов по возрастанию расстояния
+    std::vector<const Item*> nearest(const Point& target, size_t k) const {
+        std::vector<const Item*> result;
+        if (root < 0 || k == 0) {
+            return result;
+        }
+
+        // Поиск по возрастанию нижней оценки: узлы - по расстоянию до квадрата,
+        // элементы - точно; элемент, вынутый из очереди, ближе всего оставшегося
+        struct Candidate {
+            int64_t distance_sq;
+            int32_t node;       // -1 - элемент
+            const Item* item;
+            bool operator>(const Candidate& other) const { return distance_sq > other.distance_sq; }
+        };
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+        queue.push({box_distance_sq(nodes[root], target), root, nullptr});
+
+        while (!queue.empty() && result.size() < k) {
+            Candidate top = queue.top();
+            queue.pop();
+            if (top.node < 0) {
+                result.push_back(top.item);
+                continue;
+            }
+            const Node& node = nodes[top.node];
+            if (node.is_leaf()) {
+                for (const Item& item : node.items) {
+                    queue.push({item.position.distance_sq(target), -1, &item});
+                }
+            } else {
+                for (int32_t child : node.children) {
+                    if (nodes[child].count > 0) {
+                        queue.push({box_distance_sq(nodes[child], target), child, nullptr});
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    // Query: число элементов
+    size_t size() const { return root < 0 ? 0 : nodes[root].count; }
+
+    // Command: удалить все элементы
+    void clear() {
+        nodes.clear();
+        free_nodes.clear();
+        root = -1;
+    }
+
+private:
+    static constexpr int64_t INITIAL_SIZE = 64;
+
+    struct Node {
+        int64_t x = 0;
+        int64_t y = 0;
+        int64_t size = 0; // сторона квадрата [x, x + size) x [y, y + size)
+        int32_t children[4] = {-1, -1, -1, -1};
+        size_t count = 0; // элементов в поддереве
+        std::vector<Item> items; // только у листьев
+
+        bool is_leaf() const { return children[0] < 0; }
+    };
+
+    size_t capacity;
+    std::vector<Node> nodes;
+    std::vector<int32_t> free_nodes;
+    int32_t root = -1;
+
+    static int64_t align_down(int64_t value) {
+        int64_t remainder = value % INITIAL_SIZE;
+        return value - (remainder < 0 ? remainder + INITIAL_SIZE : remainder);
+    }
+
+    static bool contains(const Node& node, const Point& p) {
+        return p.get_x() >= node.x && p.get_x() < node.x + node.size &&
+               p.get_y() >= node.y && p.get_y() < node.y + node.size;
+    }
+
+    static int quadrant(const Node& node, const Point& p) {
+        int64_t half = node.size / 2;
+        return (p.get_x() >= node.x + half ? 1 : 0) | (p.get_y() >= node.y + half ? 2 : 0);
+    }
+
+    static int64_t box_distance_sq(const Node& node, const Point& p) {
+        int64_t dx = std::max<int64_t>({node.x - p.get_x(), 0, p.get_x() - (node.x + node.size - 1)});
+        int64_t dy = std::max<int64_t>({node.y - p.get_y(), 0, p.get_y() - (node.y + node.size - 1)});
+        return dx * dx + dy * dy;
+    }
+
+    int32_t allocate(int64_t x, int64_t y, int64_t size) {
+        int32_t index;
+        if (!free_nodes.empty()) {
+            index = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[index] = Node{};
+        } else {
+            index = static_cast<int32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[index].x = x;
+        nodes[index].y = y;
+        nodes[index].size = size;
+        return index;
+    }
+
+    // Новый корень вдвое больше; прежний становится его квадрантом
+    void grow_towards(const Point& p) {
+        Node& old = nodes[root];
+        int64_t x = p.get_x() < old.x ? old.x - old.size : old.x;
+        int64_t y = p.get_y() < old.y ? old.y - old.size : old.y;
+
+        if (old.is_leaf()) {
+            old.x = x;
+            old.y = y;
+            old.size *= 2; // лист просто расширяется
+            return;
+        }
+
+        int32_t previous = root;
+        int64_t size = old.size * 2;
+        size_t count = old.count;
+        root = allocate(x, y, size);
+        nodes[root].count = count;
+        for (int q = 0; q < 4; ++q) {
+            int64_t half = size / 2;
+            int64_t cx = x + ((q & 1) ? half : 0);
+            int64_t cy = y + ((q & 2) ? half : 0);
+            if (cx == nodes[previous].x && cy == nodes[previous].y) {
+                nodes[root].children[q] = previous;
+            } else {
+                int32_t child = allocate(cx, cy, half); // до записи: allocate может переместить nodes
+                nodes[root].children[q] = child;
+            }
+        }
+    }
+
+    void insert_into(int32_t index, const Item& item) {
+        while (true) {
+            Node& node = nodes[index];
+            ++node.count;
+            if (!node.is_leaf()) {
+                index = node.children[quadrant(node, item.position)];
+                continue;
+            }
+            node.items.push_back(item);
+            if (node.items.size() > capacity && node.size > 1) {
+                split(index);
+            }
+            return;
+        }
+    }
+
+    void split(int32_t index) {
+        int64_t half = nodes[index].size / 2;
+        for (int q = 0; q < 4; ++q) {
+            int32_t child = allocate(nodes[index].x + ((q & 1) ? half : 0),
+                                     nodes[index].y + ((q & 2) ? half : 0), half);
+            nodes[index].children[q] = child;
+        }
+        std::vector<Item> items = std::move(nodes[index].items);
+        nodes[index].items.clear();
+        for (const Item& item : items) {
+            // Дети заполняются напрямую: счетчик родителя уже учтен
+            Node& node = nodes[index];
+            insert_into(node.children[quadrant(node, item.position)], item);
+        }
+    }
+
+    template <typename Pred>
+    bool remove_from(int32_t index, const Point& position, Pred& matches) {
+        Node& node = nodes[index];
+        if (node.is_leaf()) {
+            for (size_t i = 0; i < node.items.size(); ++i) {
+                const Point& p = node.items[i].position;
+                if (p.get_x() == position.get_x() && p.get_y() == position.get_y() && matches(node.items[i])) {
+                    node.items[i] = std::move(node.items.back());
+                    node.items.pop_back();
+                    --node.count;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        if (!remove_from(node.children[quadrant(node, position)], position, matches)) {
+            return false;
+        }
+        Node& parent = nodes[index];
+        --parent.count;
+        if (parent.count <= capacity) {
+            collapse(index);
+        }
+        return true;
+    }
+
+    // Поддерево сворачивается в лист
+    void collapse(int32_t index) {
+        std::vector<Item> items;
+        items.reserve(nodes[index].count);
+        for (int q = 0; q < 4; ++q) {
+            release(nodes[index].children[q], items);
+            nodes[index].children[q] = -1;
+        }
+        nodes[index].items = std::move(items);
+    }
+
+    void release(int32_t index, std::vector<Item>& items) {
+        Node& node = nodes[index];
+        if (node.is_leaf()) {
+            std::move(node.items.begin(), node.items.end(), std::back_inserter(items));
+        } else {
+            for (int q = 0; q < 4; ++q) {
+                release(node.children[q], items);
+            }
+        }
+        nodes[index].items.clear();
+        free_nodes.push_back(index);
+    }
+
+    template <typename Fn>
+    void visit_rect(int32_t index, int min_x, int min_y, int max_x, int max_y, Fn& fn) const {
+        const Node& node = nodes[index];
+        if (node.count == 0 || node.x > max_x || node.y > max_y ||
+            node.x + node.size - 1 < min_x || node.y + node.size - 1 < min_y) {
+            return;
+        }
+        if (node.is_leaf()) {
+            for (const Item& item : node.items) {
+                int x = item.position.get_x();
+                int y = item.position.get_y();
+                if (x >= min_x && x <= max_x && y >= min_y && y <= max_y) {
+                    fn(item);
+                }
+            }
+            return;
+        }
+        for (int32_t child : node.children) {
+            visit_rect(child, min_x, min_y, max_x, max_y, fn);
+        }
+    }
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Сжатие блоков сохранений. ZSTD доступен, если библиотека найдена при сборке
+// (LAB6_HAVE_ZSTD); встроенный LZ - всегда. Встроенный формат - последовательности
+// в духе LZ4: токен (4 бита длины литералов | 4 бита длины совпадения - 4),
+// байты продолжения 255, литералы, u16 смещение, последняя последовательность -
+// только литералы.
+class BlockCodec {
+public:
+    enum class Kind : uint8_t {
+        NONE = 0,
+        LZ = 1,   // встроенный
+        ZSTD = 2,
+    };
+
+    // Query: собран ли кодек
+    static bool is_available(Kind kind);
+
+    // Query: запрошенный кодек или встроенный LZ, если запрошенный не собран
+    static Kind resolve(Kind requested);
+
+    // Query: верхняя граница размера сжатого блока
+    static size_t max_compressed_size(Kind kind, size_t raw_size);
+
+    // Command: сжать src, результат дописывается в out
+    static void compress(Kind kind, const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+
+    // Command: распаковать ровно raw_size байт в dst;
+    // std::runtime_error при поврежденных данных или несобранном кодеке
+    static void decompress(Kind kind, const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size);
+};
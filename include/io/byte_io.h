@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Запись бинарных форматов: целые little-endian, varint (LEB128), zigzag
+// для знаковых, строки как varint длина + байты. Данные дописываются в out.
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void u8(uint8_t value) { out.push_back(value); }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void zigzag(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    // Command: перезаписать ранее зарезервированное u32 по смещению
+    void patch_u32(size_t offset, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    size_t size() const { return out.size(); }
+
+private:
+    std::vector<uint8_t>& out;
+};
+
+// Чтение форматов ByteWriter с проверкой границ.
+// std::runtime_error с префиксом context при выходе за данные
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size, const char* context)
+        : data(data), length(size), context(context) {}
+
+    uint8_t u8() {
+        need(1);
+        return data[pos++];
+    }
+
+    uint32_t u32() {
+        need(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data[pos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t u64() {
+        need(8);
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(data[pos++]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = u8();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        fail("слишком длинный varint");
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string string() {
+        uint64_t size = varint();
+        need(size);
+        std::string value(reinterpret_cast<const char*>(data + pos), size);
+        pos += size;
+        return value;
+    }
+
+    // Command: пропустить bytes байт
+    void skip(size_t bytes) {
+        need(bytes);
+        pos += bytes;
+    }
+
+    // Query: все данные прочитаны
+    bool done() const { return pos == length; }
+
+    // Query: сколько байт осталось
+    size_t remaining() const { return length - pos; }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(std::string(context) + ": " + what);
+    }
+
+private:
+    const uint8_t* data;
+    size_t length;
+    const char* context;
+    size_t pos = 0;
+
+    void need(uint64_t bytes) const {
+        if (bytes > length - pos) {
+            fail("неожиданный конец данных");
+        }
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Раздача блоков классами по size_class байт: освобожденный блок попадает в
+// односвязный список своего класса (ссылка лежит в самом блоке), новый
+// отрезается подряд от текущего куска. Куски дает владелец (FramePool,
+// NPCHeap) - пул их не освобождает и не синхронизирует доступ: мьютекс и
+// происхождение памяти тоже на владельце
+class SizeClassPool {
+public:
+    SizeClassPool(size_t size_class, size_t max_pooled_size);
+
+    // Query: обслуживается ли размер пулом (иначе - обычный operator new)
+    bool pooled(size_t size) const { return size != 0 && size <= max_pooled; }
+
+    // Command: блок класса size (pooled(size)); nullptr, если свободных блоков
+    // нет и текущий кусок исчерпан - владелец добавляет кусок и повторяет
+    void* allocate(size_t size);
+
+    // Command: вернуть блок в список класса; size тот же, что при выделении
+    void deallocate(void* block, size_t size) noexcept;
+
+    // Command: новый текущий кусок; остаток прежнего меньше блока не используется
+    void add_chunk(std::byte* base, size_t bytes);
+
+    // Query: число выданных блоков
+    size_t blocks_in_use() const { return in_use; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t size_class;
+    size_t max_pooled;
+    std::vector<FreeBlock*> free_lists;
+    std::byte* chunk_cursor = nullptr;
+    size_t chunk_left = 0;
+    size_t in_use = 0;
+
+    size_t class_of(size_t size) const { return (size - 1) / size_class; }
+};
@@ -2,8 +2,16 @@
 
 #include "npc.h"
 
-class Druid : public NPC {
+class Druid final : public NPC {
 public:
+    // Характеристики типа как константы времени компиляции (ядра по типам)
+    static constexpr const char* TYPE_NAME = "Друид";
+    static constexpr int MOVE_DISTANCE = 10;
+    static constexpr int KILL_DISTANCE = 10;
+
+    // Сообщение об убийстве (общее для vs и закрытой диспетчеризации)
+    static constexpr const char* KILL_MESSAGE = "Друид уничтожил Белку!";
+
     Druid(const std::string& name, const Point& position);
 
     std::string get_type() const override;
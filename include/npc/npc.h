@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include "../geometry/point.h"
+#include "npc_arena.h"
 
 // Forward declaration для уменьшения связности
 class Visitor;
@@ -17,6 +19,14 @@ protected:
 public:
     virtual ~NPC() = default;
 
+    // Объекты NPC, созданные внутри NPCArena::Scope, живут в области арены
+    // (большие страницы, привязка к узлу NUMA), остальные - в обычной куче;
+    // виртуальный деструктор передает размер конкретного типа
+    static void* operator new(std::size_t size) { return NPCArena::allocate(size); }
+    static void operator delete(void* block, std::size_t size) noexcept {
+        NPCArena::deallocate(block, size);
+    }
+
     NPC(const std::string& name, const Point& position);
 
     // Qeries
@@ -42,4 +52,7 @@ public:
     
     // Command: убить NPC (изменяет состояние)
     void kill();
+    
+    // Command: вернуть погибшего NPC в игру под новым именем (повторное использование объекта)
+    void respawn(const std::string& new_name, const Point& new_position);
 };
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "npc.h"
+#include "../io/block_codec.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class NPCFactory;
+
+// Сжатое бинарное сохранение живых NPC.
+//
+// Заголовок: u32 MAGIC, u32 VERSION, u8 кодек, словарь типов (varint число + строки).
+// Далее блоки: u32 сырой размер, u32 сжатый размер, u32 число записей,
+// u64 FNV-1a сырых данных, сжатые данные. Конец - u32 0.
+// Записи блока (varint/zigzag как в ByteWriter): индекс типа, dx, dy, имя.
+// NPC упорядочены по кривой Мортона, координаты - разности с предыдущей записью
+// блока (первая - от нуля), поэтому блоки распаковываются независимо.
+class NPCArchive {
+public:
+    static constexpr uint32_t MAGIC = 0x5A43504E; // "NPCZ"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t BLOCK_SIZE = 64 * 1024; // сырой размер блока
+    // Блок закрывается на первой записи сверх BLOCK_SIZE; больший сырой
+    // размер при загрузке - повреждение, при сохранении - слишком длинное имя
+    static constexpr size_t MAX_BLOCK_SIZE = 2 * BLOCK_SIZE;
+
+    // Command: сохранить живых NPC через буферы фиксированного размера.
+    // Несобранный кодек заменяется встроенным LZ; std::runtime_error, если
+    // запись не помещается в MAX_BLOCK_SIZE
+    static void save(const std::string& filename, const std::vector<std::unique_ptr<NPC>>& npcs,
+                     BlockCodec::Kind codec = BlockCodec::Kind::LZ);
+
+    // Command: загрузка с параллельной распаковкой блоков (threads = 0 - по числу ядер).
+    // Файл читается поблочно: в памяти не больше 2 * threads сжатых блоков.
+    // Порядок NPC - пространственный, а не исходный.
+    // std::runtime_error при поврежденном файле или неизвестном типе
+    static std::vector<std::unique_ptr<NPC>> load(const NPCFactory& factory, const std::string& filename,
+                                                  unsigned threads = 0);
+};
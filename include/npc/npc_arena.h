@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../memory/size_class_pool.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Режим больших страниц для памяти NPC
+enum class HugePages {
+    None,        // обычные страницы (MADV_NOHUGEPAGE)
+    Transparent, // прозрачные большие страницы (MADV_HUGEPAGE)
+    Explicit     // страницы hugetlbfs (MAP_HUGETLB); без резерва - как Transparent
+};
+
+// Область памяти NPC одного владельца (игры). Блоки раздаются SizeClassPool
+// классами по NPCArena::SIZE_CLASS байт из кусков арены, выровненных по
+// большой странице; у области свой мьютекс, свой режим больших страниц и
+// свой узел NUMA, поэтому привязка одной игры не трогает память другой,
+// а выделения разных игр не ждут друг друга. Области не разрушаются:
+// отпущенная область достается следующему владельцу вместе с кусками
+class NPCHeap {
+public:
+    NPCHeap(const NPCHeap&) = delete;
+    NPCHeap& operator=(const NPCHeap&) = delete;
+
+    // Command: блок не меньше size байт (size <= NPCArena::MAX_POOLED_SIZE);
+    // освобождать можно из любого потока - блок вернется в эту область.
+    // Если ядро не дает новый кусок, блок берется из обычного operator new
+    void* allocate(size_t size);
+    void deallocate(void* block, size_t size) noexcept;
+
+    // Command: режим больших страниц. Новые куски отображаются в этом режиме,
+    // уже выделенным меняется только совет ядру (madvise)
+    void set_huge_pages(HugePages mode);
+
+    // Command: предпочтительный узел NUMA для памяти области: страницы уже
+    // выделенных кусков переносятся, новые куски размещаются там же;
+    // -1 - снять привязку (страница достается узлу первого касания).
+    // std::invalid_argument для узла вне [-1, NPCArena::MAX_NODES),
+    // std::runtime_error, если ядро отказало
+    void bind_to_node(int node);
+
+    // Query: режим больших страниц, узел привязки (-1 - нет)
+    HugePages huge_pages() const;
+    int bound_node() const;
+
+    // Query: память кусков, выданные из кусков объекты, куски Explicit без
+    // резерва hugetlbfs, блоки из обычной кучи (кусок отобразить не удалось)
+    size_t reserved_bytes() const;
+    size_t objects_in_use() const;
+    size_t huge_page_fallbacks() const;
+    size_t plain_allocations() const;
+
+    // Query: число затронутых страниц кусков на каждом узле (индекс - узел);
+    // пусто, если ядро не сообщает размещение страниц
+    std::vector<size_t> pages_per_node() const;
+
+private:
+    friend class NPCArena;
+
+    NPCHeap();
+
+    bool map_chunk(); // под mutex; false, если ядро не дало кусок
+    void reset() noexcept; // настройки по умолчанию для следующего владельца
+
+    struct Chunk {
+        std::byte* base;
+        bool hugetlb;
+    };
+
+    mutable std::mutex mutex;
+    SizeClassPool pool;
+    std::vector<Chunk> chunks;
+    size_t fallbacks = 0;
+    size_t plain = 0;
+    HugePages mode = HugePages::None;
+    int node = -1;
+};
+
+// Память объектов NPC: NPC::operator new берет блок из области, выбранной
+// вызывающим потоком через NPCArena::Scope, а вне Scope - из обычного
+// operator new (без общего мьютекса: фабрики, архивы, параллельная загрузка).
+// Куски всех областей лежат в диапазонах адресов по REGION_CHUNKS кусков,
+// которые резервируются по мере надобности; delete узнает блок арены
+// сравнением адреса с диапазонами, а область - по заголовку куска.
+// Куски не возвращаются системе
+class NPCArena {
+public:
+    static constexpr size_t SIZE_CLASS = 16;
+    static constexpr size_t MAX_POOLED_SIZE = 256;
+    static constexpr size_t CHUNK_BYTES = 2 * 1024 * 1024;
+    static constexpr size_t REGION_CHUNKS = 64; // резервируется по 128 МБ адресов
+    static constexpr size_t MAX_CHUNKS = 8192;  // не больше 16 ГБ на процесс
+    static constexpr int MAX_NODES = 64;
+
+    // Отпускает область при разрушении владельца
+    struct Release {
+        void operator()(NPCHeap* heap) const noexcept;
+    };
+    using HeapLease = std::unique_ptr<NPCHeap, Release>;
+
+    // Привязка вызывающего потока к области на время жизни объекта (вложенные
+    // Scope восстанавливают прежнюю область)
+    class Scope {
+    public:
+        explicit Scope(NPCHeap& heap);
+        explicit Scope(NPCHeap* heap); // nullptr - обычный operator new
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        NPCHeap* previous;
+    };
+
+    // Query: общая арена процесса
+    static NPCArena& instance();
+
+    // Command: свободная область (режим None, без привязки) или новая
+    HeapLease acquire();
+
+    // Command: для NPC::operator new/delete; size передается и при освобождении
+    static void* allocate(size_t size);
+    static void deallocate(void* block, size_t size) noexcept;
+
+    // Query: лежит ли блок в кусках арены
+    static bool owns(const void* block) noexcept;
+
+    // Query: область, выбранная вызывающим потоком (nullptr - вне Scope)
+    static NPCHeap* current();
+
+    // Query: число созданных областей (занятых и свободных)
+    size_t heap_count() const;
+
+private:
+    NPCArena() = default;
+
+    mutable std::mutex heaps_mutex;
+    std::vector<std::unique_ptr<NPCHeap>> heaps;
+    std::vector<NPCHeap*> idle;
+};
@@ -2,6 +2,7 @@
 
 #include "npc.h"
 #include "../geometry/point.h"
+#include "../io/block_codec.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -19,11 +20,26 @@ public:
     // Command: создание NPC по типу
     std::unique_ptr<NPC> create(const std::string& type, const std::string& name, const Point& position) const;
     
+    // Query: зарегистрированные типы в порядке регистрации
+    std::vector<std::string> get_types() const;
+    
     // Command: загрузка NPC из файла
     std::vector<std::unique_ptr<NPC>> load_from_file(const std::string& filename) const;
     
     // Command: сохранение NPC в файл
     void save_to_file(const std::string& filename, const std::vector<std::unique_ptr<NPC>>& npcs) const;
+    
+    // Command: то же сохранение, что save_to_file (байт в байт), в threads потоках
+    // (0 - по числу ядер): куски форматируются независимо и пишутся pwrite по смещениям
+    void save_to_file_parallel(const std::string& filename, const std::vector<std::unique_ptr<NPC>>& npcs,
+                               unsigned threads = 0) const;
+    
+    // Command: сжатое бинарное сохранение (формат NPCArchive)
+    void save_compressed(const std::string& filename, const std::vector<std::unique_ptr<NPC>>& npcs,
+                         BlockCodec::Kind codec = BlockCodec::Kind::LZ) const;
+    
+    // Command: загрузка сжатого сохранения, блоки распаковываются в threads потоках (0 - по числу ядер)
+    std::vector<std::unique_ptr<NPC>> load_compressed(const std::string& filename, unsigned threads = 0) const;
 
 private:
     // Внутренняя структура для регистрации создателей
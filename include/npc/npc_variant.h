@@ -0,0 +1,36 @@
+#pragma once
+
+#include <type_traits>
+#include <variant>
+#include "npc.h"
+#include "orc.h"
+#include "druid.h"
+#include "squirrel.h"
+
+// Закрытый набор типов NPC: значение вместо указателя на базовый класс.
+// Двойная диспетчеризация через std::visit разворачивается компилятором
+// в таблицу переходов по паре индексов, а правила боя - константы времени
+// компиляции. Открытая иерархия с Visitor остается для расширения.
+using NPCVariant = std::variant<Orc, Druid, Squirrel>;
+
+// Правило "Attacker убивает Target" для закрытого набора; должно совпадать с NPC::vs
+template <typename Attacker, typename Target>
+inline constexpr bool kills_v = false;
+
+template <>
+inline constexpr bool kills_v<Orc, Druid> = true;
+
+template <>
+inline constexpr bool kills_v<Druid, Squirrel> = true;
+
+// Query: копия NPC в закрытом представлении
+NPCVariant to_variant(NPC& npc);
+
+// Query: доступ к общему интерфейсу без знания конкретного типа
+inline NPC& as_npc(NPCVariant& npc) {
+    return std::visit([](auto& concrete) -> NPC& { return concrete; }, npc);
+}
+
+inline const NPC& as_npc(const NPCVariant& npc) {
+    return std::visit([](const auto& concrete) -> const NPC& { return concrete; }, npc);
+}
@@ -2,8 +2,16 @@
 
 #include "npc.h"
 
-class Orc : public NPC {
+class Orc final : public NPC {
 public:
+    // Характеристики типа как константы времени компиляции (ядра по типам)
+    static constexpr const char* TYPE_NAME = "Орк";
+    static constexpr int MOVE_DISTANCE = 20;
+    static constexpr int KILL_DISTANCE = 10;
+
+    // Сообщение об убийстве (общее для vs и закрытой диспетчеризации)
+    static constexpr const char* KILL_MESSAGE = "Орк разорвал бедолагу Друида!";
+
     Orc(const std::string& name, const Point& position);
 
     std::string get_type() const override;
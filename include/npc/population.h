@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Счетчики численности живых NPC: всего и по типам.
+// Владелец обновляет их при появлении и гибели NPC, читатели (карта, списки,
+// наблюдатели) получают значения за O(1) без блокировок. Общий счетчик и
+// счетчики типов обновляются раздельно, поэтому при одновременной записи
+// их сумма может на мгновение расходиться.
+class PopulationCounters {
+public:
+    static constexpr size_t MAX_TYPES = 16;
+
+    // Типы в порядке индексов (не больше MAX_TYPES)
+    explicit PopulationCounters(std::vector<std::string> type_names);
+
+    // Запрет копирования
+    PopulationCounters(const PopulationCounters&) = delete;
+    PopulationCounters& operator=(const PopulationCounters&) = delete;
+
+    // Command: NPC типа появился / погиб
+    void on_spawn(size_t type);
+    void on_death(size_t type);
+
+    // Command: обнулить все счетчики (перед пересчетом при загрузке)
+    void reset();
+
+    // Query: живых всего и по типу
+    size_t alive() const { return static_cast<size_t>(total.load(std::memory_order_relaxed)); }
+    size_t alive_of(size_t type) const;
+    size_t alive_of(const std::string& type) const;
+
+    // Query: индекс типа или -1
+    int type_index(const std::string& type) const;
+
+    // Query: известные типы
+    const std::vector<std::string>& types() const { return names; }
+
+private:
+    std::vector<std::string> names;
+    std::atomic<int64_t> total{0};
+    std::array<std::atomic<int64_t>, MAX_TYPES> per_type{};
+};
@@ -2,8 +2,13 @@
 
 #include "npc.h"
 
-class Squirrel : public NPC {
+class Squirrel final : public NPC {
 public:
+    // Характеристики типа как константы времени компиляции (ядра по типам)
+    static constexpr const char* TYPE_NAME = "Белка";
+    static constexpr int MOVE_DISTANCE = 5;
+    static constexpr int KILL_DISTANCE = 5;
+
     Squirrel(const std::string& name, const Point& position);
 
     std::string get_type() const override;
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../batch/batch_runner.h"
+#include "shard_link.h"
+#include "strip_shard.h"
+#include <cstdint>
+#include <vector>
+
+// Итоги распределенного прогона
+struct ShardedRunResult {
+    std::vector<ShardNPC> survivors; // по возрастанию id
+    RunSummary summary;              // выжившие и убийства по типам
+    uint64_t migrations = 0;         // переходов NPC между полосами
+    uint64_t halo_records = 0;       // записей NPC, отправленных в ореол соседям
+    double elapsed_seconds = 0.0;
+};
+
+// Локальный запуск распределенного мира: по процессу (fork) на полосу,
+// соседние полосы связаны socketpair, итоги возвращаются родителю
+class ShardLauncher {
+public:
+    // Command: прогон на config.shards процессах; std::invalid_argument для
+    // некорректной конфигурации, std::runtime_error, если процесс полосы упал
+    static ShardedRunResult run(const ShardConfig& config, int ticks);
+
+    // Command: тот же мир одной полосой в текущем процессе (эталон для сравнения)
+    static ShardedRunResult run_single_process(const ShardConfig& config, int ticks);
+
+    // Command: цикл тиков полосы; у крайних полос соответствующий сосед - nullptr
+    static ShardedRunResult run_strip(StripShard& shard, ShardLink* up, ShardLink* down, int ticks);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "strip_shard.h"
+#include "../io/byte_io.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Соединение с соседней полосой поверх Unix domain socket (socketpair).
+// Сообщение: [u32 длина][нагрузка]. Отправка и прием неблокирующие и идут
+// одним циклом poll по всем соединениям полосы, поэтому встречные большие
+// сообщения не блокируют друг друга при заполненных буферах сокетов.
+class ShardLink {
+public:
+    // Владеет fd; std::runtime_error, если fd не удалось перевести в неблокирующий режим
+    explicit ShardLink(int fd);
+    ~ShardLink();
+
+    // Запрет копирования
+    ShardLink(const ShardLink&) = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    // Command: поставить сообщение в очередь отправки
+    void post(const std::vector<uint8_t>& payload);
+
+    // Command: отправить поставленное всеми соединениями и дождаться
+    // по одному сообщению от каждого (nullptr пропускаются);
+    // std::runtime_error, если соседний процесс закрыл соединение
+    static void exchange(const std::vector<ShardLink*>& links);
+
+    // Query: сообщение, полученное последним exchange
+    const std::vector<uint8_t>& received() const { return message; }
+
+    // Сериализация списков NPC для переходов, ореола и итогов полосы;
+    // decode дописывает в out, std::runtime_error при поврежденных данных
+    static void encode(const std::vector<ShardNPC>& npcs, ByteWriter& writer);
+    static void decode(ByteReader& reader, std::vector<ShardNPC>& out);
+
+private:
+    int fd;
+    std::vector<uint8_t> outbox;
+    size_t sent = 0;
+    std::vector<uint8_t> inbox; // может содержать начало следующего сообщения
+    std::vector<uint8_t> message;
+
+    bool send_some();    // true - очередь отправки пуста
+    bool receive_some(); // true - в inbox есть целое сообщение
+    bool take_message();
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "../geometry/point.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Параметры распределенного мира: карта режется на горизонтальные полосы,
+// полоса i - строки [height * i / shards, height * (i + 1) / shards)
+struct ShardConfig {
+    uint64_t seed = 1;
+    int width = 1000;
+    int height = 1000;
+    size_t npc_count = 10000;
+    int shards = 1;
+};
+
+// NPC распределенного мира; тип - индекс в NPCVariant
+struct ShardNPC {
+    uint32_t id = 0;
+    uint8_t type = 0;
+    Point position;
+
+    bool operator==(const ShardNPC& other) const {
+        return id == other.id && type == other.type &&
+               position.get_x() == other.position.get_x() && position.get_y() == other.position.get_y();
+    }
+};
+
+// Одна полоса распределенного мира. Это отдельная модель, а не Game:
+// правила типов (кто кого убивает, расстояния хода и убийства) берутся
+// из KillMatrix::closed_set(), то есть из тех же kills_v и констант
+// классов, но порядок боев и случайность свои, и с Game результаты не
+// совпадают. Правила не зависят от разбиения: случайность NPC - хеш от
+// (seed, тик, id), а не общий генератор, бои тика разрешаются одновременно
+// по позициям после хода (погибший в этом тике тоже успевает атаковать),
+// убийство засчитывается атакующему с меньшим id. Поэтому прогон на N
+// полосах совпадает с прогоном на одной.
+//
+// Тик: move() -> обмен take_migrants()/add_owned() с соседями ->
+// обмен collect_halo() -> resolve_battles(ореол соседей)
+class StripShard {
+public:
+    // std::invalid_argument, если полоса ниже максимального хода или
+    // расстояния убийства (переход и ореол только между соседними полосами)
+    StripShard(const ShardConfig& config, int index);
+
+    // Query: строки полосы [row_begin, row_end)
+    int row_begin() const { return rows_begin; }
+    int row_end() const { return rows_end; }
+    int index() const { return shard_index; }
+
+    // Command: ход всех своих NPC
+    void move();
+
+    // Command: забрать NPC, ушедших за границы полосы (up - к меньшим y)
+    void take_migrants(std::vector<ShardNPC>& up, std::vector<ShardNPC>& down);
+
+    // Command: принять NPC, перешедших из соседней полосы
+    void add_owned(const std::vector<ShardNPC>& migrants);
+
+    // Query: свои NPC не дальше максимального расстояния убийства от границ
+    void collect_halo(std::vector<ShardNPC>& up, std::vector<ShardNPC>& down) const;
+
+    // Command: бои за своих NPC с участием ореола соседей, затем следующий тик
+    void resolve_battles(const std::vector<ShardNPC>& halo);
+
+    // Query: живые NPC полосы (порядок не определен)
+    const std::vector<ShardNPC>& owned() const { return npcs; }
+
+    // Query: убийства, где жертва была в этой полосе
+    const std::map<std::pair<std::string, std::string>, uint64_t>& kills() const { return kill_counts; }
+
+    uint64_t tick() const { return ticks; }
+
+    // Query: имя типа NPCVariant (std::out_of_range для неизвестного)
+    static const std::string& type_name(uint8_t type);
+
+    // std::invalid_argument, если мир нельзя разрезать на config.shards полос
+    static void check_config(const ShardConfig& config);
+
+    // Query: дальность ореола - максимальное расстояние убийства среди типов
+    static int halo_distance();
+
+    // Query: побеждает ли attacker цель target в тике tick (кости по mix)
+    static bool attack_wins(uint64_t seed, uint64_t tick, uint32_t attacker, uint32_t target);
+
+    // Query: псевдослучайное 64-битное значение для (seed, a, b, c)
+    static uint64_t mix(uint64_t seed, uint64_t a, uint64_t b, uint64_t c);
+
+private:
+    ShardConfig config;
+    int shard_index;
+    int rows_begin;
+    int rows_end;
+    uint64_t ticks = 0;
+    std::vector<ShardNPC> npcs;
+    std::map<std::pair<std::string, std::string>, uint64_t> kill_counts;
+
+    // Буферы разрешения боев: NPC полосы и ореола в сетке ячеек halo_distance
+    std::vector<ShardNPC> fighters;
+    std::vector<uint32_t> cell_start;
+    std::vector<uint32_t> cell_items;
+    std::vector<uint8_t> killed;
+};
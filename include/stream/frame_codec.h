@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../game/world_snapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Бинарные кадры состояния мира для внешних визуализаторов.
+//
+// Кадр: [u32 длина нагрузки][нагрузка], нагрузка:
+//   u32 MAGIC, u8 VERSION, u8 флаги (FLAG_KEYFRAME), varint тик, u32 число записей,
+//   записи: u8 вид + данные
+//     SPAWN: varint id, varint поколение, строка тип, строка имя, zigzag x, zigzag y
+//     MOVE:  varint id, zigzag dx, zigzag dy (относительно прошлого кадра)
+//     DEATH: varint id
+// Целые - little-endian. Строка: varint длина + байты UTF-8. Ключевой кадр содержит только SPAWN
+// для всех живых и сбрасывает состояние читателя. В разностном кадре все DEATH идут
+// раньше SPAWN и MOVE: id слота, освобожденного и занятого заново между кадрами,
+// сначала освобождается, затем получает нового NPC.
+class FrameEncoder {
+public:
+    static constexpr uint32_t MAGIC = 0x5346504E; // "NPFS"
+    static constexpr uint8_t VERSION = 1;
+    static constexpr uint8_t FLAG_KEYFRAME = 1;
+
+    enum class RecordKind : uint8_t {
+        SPAWN = 0,
+        MOVE = 1,
+        DEATH = 2,
+    };
+
+    // Command: ключевой кадр - все живые NPC снимка (дописывается в out)
+    static void encode_keyframe(const WorldSnapshot& current, std::vector<uint8_t>& out);
+
+    // Command: разностный кадр относительно previous (дописывается в out)
+    static void encode_delta(const WorldSnapshot& previous, const WorldSnapshot& current,
+                             std::vector<uint8_t>& out);
+};
+
+// Состояние мира на стороне читателя, восстановленное из кадров
+class FrameDecoder {
+public:
+    struct DecodedNPC {
+        uint32_t generation = 0;
+        std::string type;
+        std::string name;
+        int x = 0;
+        int y = 0;
+    };
+
+    struct FrameInfo {
+        uint64_t tick = 0;
+        bool keyframe = false;
+        size_t spawned = 0;
+        size_t moved = 0;
+        size_t died = 0;
+    };
+
+    // Command: применить нагрузку одного кадра (без префикса длины);
+    // std::runtime_error при поврежденных данных
+    FrameInfo apply(const uint8_t* data, size_t size);
+
+    // Query: текущее состояние (id -> NPC)
+    const std::map<uint32_t, DecodedNPC>& state() const { return npcs; }
+
+private:
+    std::map<uint32_t, DecodedNPC> npcs;
+};
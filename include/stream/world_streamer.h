@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../game/world_snapshot.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Потоковая выдача кадров мира через Unix domain socket.
+// Новый клиент получает ключевой кадр, затем разностные кадры (FrameEncoder).
+// Отправка неблокирующая: клиент, не успевающий читать (кадр не влез
+// в буфер сокета целиком), отключается, а тик симуляции не ждет.
+class WorldStreamer {
+public:
+    using SnapshotSource = std::function<std::shared_ptr<const WorldSnapshot>()>;
+
+    // std::runtime_error, если сокет не удалось создать
+    explicit WorldStreamer(const std::string& socket_path);
+    ~WorldStreamer();
+
+    // Запрет копирования
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    // Command: принять новых клиентов и разослать кадр для снимка
+    // (повторная публикация того же снимка ничего не отправляет)
+    void publish(const std::shared_ptr<const WorldSnapshot>& snapshot);
+
+    // Command: фоновый поток, опрашивающий источник снимков
+    void start(SnapshotSource source, std::chrono::milliseconds poll_interval);
+    void stop();
+
+    // Query: статистика
+    size_t client_count() const { return clients_connected.load(); }
+    uint64_t dropped_clients() const { return clients_dropped.load(); }
+    uint64_t frames_sent() const { return frames.load(); }
+
+private:
+    struct Client {
+        int fd;
+        bool needs_keyframe;
+    };
+
+    std::string path;
+    int listen_fd = -1;
+    std::vector<Client> clients;
+    std::shared_ptr<const WorldSnapshot> previous;
+    std::vector<uint8_t> delta_frame;
+    std::vector<uint8_t> key_frame;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> clients_connected{0};
+    std::atomic<uint64_t> clients_dropped{0};
+    std::atomic<uint64_t> frames{0};
+
+    void accept_clients();
+    bool send_frame(int fd, const std::vector<uint8_t>& frame);
+};
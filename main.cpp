@@ -1,13 +1,94 @@
 #include "include/game/game.h"
+#include "include/battle/battle_stats.h"
+#include "include/stream/world_streamer.h"
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
 
-int main() {
+// lab6 [--stream <путь_сокета>] [--checkpoint <файл>] [--resume <файл>] [--terrain <файл>]
+//      [--hunt <тиков>]
+//   --stream     трансляция кадров мира для визуализатора
+//   --checkpoint контрольная точка каждые CHECKPOINT_TICKS тиков
+//   --resume     продолжить игру с контрольной точки
+//   --terrain    рельеф подземелья (формат TerrainMap)
+//   --hunt       погоня и бегство, поля направлений пересчитываются раз в N тиков
+int main(int argc, char* argv[]) {
+    constexpr uint64_t CHECKPOINT_TICKS = 5;
+    
+    std::string stream_path;
+    std::string checkpoint_path;
+    std::string resume_path;
+    std::string terrain_path;
+    int hunt_ticks = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--stream") stream_path = argv[i + 1];
+        else if (option == "--checkpoint") checkpoint_path = argv[i + 1];
+        else if (option == "--resume") resume_path = argv[i + 1];
+        else if (option == "--terrain") terrain_path = argv[i + 1];
+        else if (option == "--hunt") hunt_ticks = std::atoi(argv[i + 1]);
+    }
+    
     std::cout << "Создается " << Game::NUM_NPCS << " NPC на карте " 
               << Game::MAP_WIDTH << "x" << Game::MAP_HEIGHT << "\n";
     std::cout << "Игра продлится " << Game::GAME_DURATION_SECONDS << " секунд\n\n";
     
     Game game;
+    
+    if (!terrain_path.empty()) {
+        try {
+            game.set_terrain(TerrainMap::load(terrain_path));
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка загрузки рельефа: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (hunt_ticks > 0) {
+        game.set_flow_movement(true, hunt_ticks);
+    }
+    if (!resume_path.empty()) {
+        try {
+            game.load_checkpoint(resume_path);
+            std::cout << "Игра продолжена с тика " << game.snapshot()->tick << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка загрузки контрольной точки: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (!checkpoint_path.empty()) {
+        game.set_checkpointing(checkpoint_path, CHECKPOINT_TICKS);
+    }
+    
+    // Статистика боев: регионы 10x10 клеток
+    BattleStats stats(Game::MAP_WIDTH, Game::MAP_HEIGHT, 10);
+    auto world = game.snapshot();
+    for (const auto& npc : world->npcs) {
+        if (npc.alive) {
+            stats.add_population(world->type_name(npc), 1);
+        }
+    }
+    game.subscribe(&stats);
+    
+    std::unique_ptr<WorldStreamer> streamer;
+    if (!stream_path.empty()) {
+        try {
+            streamer = std::make_unique<WorldStreamer>(stream_path);
+            streamer->start([&game]() { return game.snapshot(); }, std::chrono::milliseconds(10));
+            std::cout << "Трансляция кадров: " << stream_path << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка трансляции: " << e.what() << std::endl;
+        }
+    }
     game.start();
     
+    if (streamer) {
+        streamer->stop();
+    }
+    
+    stats.export_csv("battle_stats.csv");
+    stats.export_json("battle_stats.json");
+    std::cout << "Статистика боев сохранена в battle_stats.csv и battle_stats.json\n";
+    
     return 0;
 }
@@ -0,0 +1,76 @@
+#include "include/shard/shard_launcher.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+// Аргумент командной строки целиком - неотрицательное число типа T
+template <typename T>
+T parse_argument(const char* text, const char* what) {
+    T value{};
+    const char* end = text + std::strlen(text);
+    auto [ptr, error] = std::from_chars(text, end, value);
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+        negative = value < 0;
+    }
+    if (error != std::errc() || ptr != end || negative) {
+        throw std::invalid_argument(std::string("неверное значение ") + what + ": " + text);
+    }
+    return value;
+}
+
+} // namespace
+
+// Распределенный мир: lab6_shards [полос] [тиков] [seed] [NPC] [сторона_карты]
+// Полосы - отдельные процессы; для сравнения тот же мир прогоняется одним процессом
+int main(int argc, char* argv[]) {
+    ShardConfig config;
+    int ticks = 100;
+    try {
+        config.shards = argc > 1 ? parse_argument<int>(argv[1], "числа полос") : 4;
+        ticks = argc > 2 ? parse_argument<int>(argv[2], "числа тиков") : ticks;
+        config.seed = argc > 3 ? parse_argument<uint64_t>(argv[3], "seed") : 1;
+        config.npc_count = argc > 4 ? parse_argument<size_t>(argv[4], "числа NPC") : config.npc_count;
+        if (argc > 5) {
+            config.width = config.height = parse_argument<int>(argv[5], "стороны карты");
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Ошибка: " << e.what() << "\n"
+                  << "Использование: " << argv[0] << " [полос] [тиков] [seed] [NPC] [сторона_карты]" << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Карта " << config.width << "x" << config.height << ", NPC: " << config.npc_count
+              << ", полос: " << config.shards << ", тиков: " << ticks << "\n";
+    
+    try {
+        ShardedRunResult sharded = ShardLauncher::run(config, ticks);
+        ShardedRunResult single = ShardLauncher::run_single_process(config, ticks);
+        
+        std::cout << "\n=== ВЫЖИВШИЕ ===\n";
+        for (const auto& [type, count] : sharded.summary.survivors) {
+            std::cout << "  " << type << ": " << count << "\n";
+        }
+        std::cout << "\n=== УБИЙСТВА ===\n";
+        for (const auto& [pair, count] : sharded.summary.kills) {
+            std::cout << "  " << pair.first << " -> " << pair.second << ": " << count << "\n";
+        }
+        
+        std::cout << "\nПереходов между полосами: " << sharded.migrations
+                  << ", записей ореола: " << sharded.halo_records << "\n";
+        std::cout << "Время: " << sharded.elapsed_seconds << " с на " << config.shards
+                  << " процессах, " << single.elapsed_seconds << " с одним процессом\n";
+        
+        bool same = sharded.survivors == single.survivors && sharded.summary.kills == single.summary.kills;
+        std::cout << "Совпадение с однопроцессным прогоном: " << (same ? "да" : "НЕТ") << "\n";
+        return same ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+}
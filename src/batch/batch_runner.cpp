@@ -0,0 +1,85 @@
+#include "../../include/batch/batch_runner.h"
+#include "../../include/batch/work_stealing_pool.h"
+#include "../../include/battle/observer.h"
+#include "../../include/game/game.h"
+#include <chrono>
+#include <vector>
+
+namespace {
+
+// Подсчет убийств одного прогона; step() вызывается в одном потоке
+class KillCounter : public Observer {
+public:
+    explicit KillCounter(RunSummary& summary) : summary(summary) {}
+
+    void notify(const BattleEvent& event) const override {
+        if (event.killed) {
+            ++summary.kills[{event.attacker_type, event.target_type}];
+        }
+    }
+
+private:
+    RunSummary& summary;
+};
+
+} // namespace
+
+void BatchSummary::merge(const RunSummary& run) {
+    ++runs;
+    for (const auto& [type, count] : run.survivors) {
+        survivors[type] += count;
+    }
+    for (const auto& [pair, count] : run.kills) {
+        kills[pair] += count;
+    }
+}
+
+void BatchSummary::merge(const BatchSummary& other) {
+    runs += other.runs;
+    for (const auto& [type, count] : other.survivors) {
+        survivors[type] += count;
+    }
+    for (const auto& [pair, count] : other.kills) {
+        kills[pair] += count;
+    }
+}
+
+BatchRunner::BatchRunner(size_t thread_count) : thread_count(thread_count) {}
+
+RunSummary BatchRunner::run_single(uint64_t seed, int ticks) {
+    RunSummary summary;
+    summary.seed = seed;
+
+    Game game(static_cast<unsigned>(seed), true);
+    KillCounter counter(summary);
+    game.subscribe(&counter);
+    game.run_headless(ticks);
+
+    auto world = game.snapshot();
+    for (const auto& npc : world->npcs) {
+        if (npc.alive) {
+            ++summary.survivors[world->type_name(npc)];
+        }
+    }
+    return summary;
+}
+
+BatchSummary BatchRunner::run(size_t runs, uint64_t base_seed, int ticks) const {
+    auto start = std::chrono::steady_clock::now();
+
+    WorkStealingPool pool(thread_count);
+    // Аккумулятор на поток - слияние только после завершения пула
+    std::vector<BatchSummary> partial(pool.size());
+
+    pool.run(runs, [&](size_t task_index, size_t worker_index) {
+        partial[worker_index].merge(run_single(base_seed + task_index, ticks));
+    });
+
+    BatchSummary result;
+    for (const auto& part : partial) {
+        result.merge(part);
+    }
+    result.elapsed_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
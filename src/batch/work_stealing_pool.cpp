@@ -0,0 +1,72 @@
+#include "../../include/batch/work_stealing_pool.h"
+#include <algorithm>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : thread_count(std::max<size_t>(1, thread_count)) {
+    for (size_t i = 0; i < this->thread_count; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() = default;
+
+size_t WorkStealingPool::size() const {
+    return thread_count;
+}
+
+void WorkStealingPool::run(size_t task_count, const Task& task) {
+    // Раздаем задачи непрерывными блоками, чтобы кража была редкой
+    for (size_t worker = 0; worker < thread_count; ++worker) {
+        size_t begin = task_count * worker / thread_count;
+        size_t end = task_count * (worker + 1) / thread_count;
+        std::lock_guard<std::mutex> lock(queues[worker]->mutex);
+        for (size_t i = begin; i < end; ++i) {
+            queues[worker]->tasks.push_back(i);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t worker = 1; worker < thread_count; ++worker) {
+        threads.emplace_back(&WorkStealingPool::worker_loop, this, worker, std::cref(task));
+    }
+    worker_loop(0, task); // вызывающий поток тоже работает
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool WorkStealingPool::pop_local(size_t worker, size_t& task_index) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task_index = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, size_t& task_index) {
+    for (size_t offset = 1; offset < thread_count; ++offset) {
+        WorkerQueue& victim = *queues[(thief + offset) % thread_count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task_index = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(size_t worker, const Task& task) {
+    size_t task_index = 0;
+    // Новые задачи во время run не появляются, поэтому пустота
+    // всех очередей означает завершение работы потока
+    while (pop_local(worker, task_index) || steal(worker, task_index)) {
+        task(task_index, worker);
+    }
+}
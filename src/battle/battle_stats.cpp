@@ -0,0 +1,344 @@
+#include "../../include/battle/battle_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+std::atomic<uint64_t> next_stats_id{1};
+
+// Живые экземпляры: завершающийся поток отпускает шарды только у них.
+// Поколение растет при каждом разрушении - по нему потоки чистят свои кэши
+std::mutex live_mutex;
+std::unordered_set<uint64_t> live_ids;
+std::atomic<uint64_t> destroyed_generation{0};
+
+// Счетчик с единственным писателем: чтение-запись без RMW, читатели видят
+// значение атомарно
+void bump(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+std::string json_escape(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+} // namespace
+
+// Аккумулятор одного потока. Пишет только поток-владелец и без блокировок:
+// счетчики - атомарные, убийства дописываются в журнал кусками, длина
+// журнала публикуется release-записью после самой записи. Читатель берет
+// длину (acquire) и проходит куски до нее.
+struct BattleStats::Shard {
+    struct Kill {
+        uint32_t killer;
+        uint32_t victim;
+        uint64_t tick;
+    };
+    struct KillChunk {
+        static constexpr size_t SIZE = 256;
+        std::array<Kill, SIZE> kills;
+        std::unique_ptr<KillChunk> next; // пишется до публикации длины
+    };
+
+    explicit Shard(size_t regions)
+        : heatmap(std::make_unique<std::atomic<uint64_t>[]>(regions)) {}
+
+    std::atomic<bool> owned{true}; // передача шарда новому потоку (release/acquire)
+    std::atomic<uint64_t> fights{0};
+    std::array<std::atomic<uint64_t>, DICE_SIDES> attack_rolls{};
+    std::array<std::atomic<uint64_t>, DICE_SIDES> defense_rolls{};
+    std::unique_ptr<std::atomic<uint64_t>[]> heatmap;
+    std::atomic<uint64_t> kill_count{0};
+    KillChunk first;
+
+    // Только владелец
+    KillChunk* tail = &first;
+    size_t tail_used = 0;
+    std::unordered_map<std::string, uint32_t> type_ids;
+};
+
+// Шарды потока по идентификаторам экземпляров. Записи разрушенных
+// экземпляров удаляются при смене поколения; при завершении потока
+// его шарды у живых экземпляров освобождаются для новых писателей
+struct BattleStats::ThreadShards {
+    uint64_t generation = 0;
+    std::unordered_map<uint64_t, Shard*> shards;
+
+    ~ThreadShards() {
+        std::lock_guard<std::mutex> lock(live_mutex);
+        for (const auto& [owner, shard] : shards) {
+            if (live_ids.count(owner)) {
+                shard->owned.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    void prune() {
+        uint64_t current = destroyed_generation.load(std::memory_order_acquire);
+        if (current == generation) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(live_mutex);
+        std::erase_if(shards, [](const auto& entry) { return !live_ids.count(entry.first); });
+        generation = current;
+    }
+};
+
+BattleStats::BattleStats(int map_width, int map_height, int region_size)
+    : id(next_stats_id.fetch_add(1)),
+      region_size(std::max(1, region_size)),
+      regions_x((std::max(1, map_width) + this->region_size - 1) / this->region_size),
+      regions_y((std::max(1, map_height) + this->region_size - 1) / this->region_size) {
+    std::lock_guard<std::mutex> lock(live_mutex);
+    live_ids.insert(id);
+}
+
+BattleStats::~BattleStats() {
+    // После удаления из живых ни один поток не обратится к шардам экземпляра
+    std::lock_guard<std::mutex> lock(live_mutex);
+    live_ids.erase(id);
+    destroyed_generation.fetch_add(1, std::memory_order_release);
+}
+
+BattleStats::Shard& BattleStats::local_shard() const {
+    thread_local ThreadShards cache;
+    cache.prune();
+    auto it = cache.shards.find(id);
+    if (it != cache.shards.end()) {
+        return *it->second;
+    }
+
+    Shard* shard = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (const auto& candidate : shards) {
+            bool expected = false;
+            if (candidate->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                shard = candidate.get(); // шард завершившегося потока
+                break;
+            }
+        }
+        if (!shard) {
+            shards.push_back(std::make_unique<Shard>(static_cast<size_t>(regions_x) * regions_y));
+            shard = shards.back().get();
+        }
+    }
+    cache.shards.emplace(id, shard);
+    return *shard;
+}
+
+uint32_t BattleStats::type_id(Shard& shard, const std::string& type) const {
+    auto it = shard.type_ids.find(type);
+    if (it != shard.type_ids.end()) {
+        return it->second;
+    }
+
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        auto known = std::find(type_names.begin(), type_names.end(), type);
+        index = static_cast<uint32_t>(known - type_names.begin());
+        if (known == type_names.end()) {
+            type_names.push_back(type);
+        }
+    }
+    shard.type_ids.emplace(type, index);
+    return index;
+}
+
+int BattleStats::region_index(const Point& location) const {
+    int rx = std::clamp(location.get_x() / region_size, 0, regions_x - 1);
+    int ry = std::clamp(location.get_y() / region_size, 0, regions_y - 1);
+    return ry * regions_x + rx;
+}
+
+void BattleStats::notify(const BattleEvent& event) const {
+    record(local_shard(), event);
+}
+
+void BattleStats::notify_batch(std::span<const BattleEvent> events) const {
+    Shard& shard = local_shard();
+    for (const auto& event : events) {
+        record(shard, event);
+    }
+}
+
+void BattleStats::record(Shard& shard, const BattleEvent& event) const {
+    bump(shard.fights);
+    if (event.attack_roll >= 1 && event.attack_roll <= DICE_SIDES) {
+        bump(shard.attack_rolls[event.attack_roll - 1]);
+    }
+    if (event.defense_roll >= 1 && event.defense_roll <= DICE_SIDES) {
+        bump(shard.defense_rolls[event.defense_roll - 1]);
+    }
+    bump(shard.heatmap[region_index(event.location)]);
+
+    if (event.killed) {
+        if (shard.tail_used == Shard::KillChunk::SIZE) {
+            shard.tail->next = std::make_unique<Shard::KillChunk>();
+            shard.tail = shard.tail->next.get();
+            shard.tail_used = 0;
+        }
+        shard.tail->kills[shard.tail_used++] = {type_id(shard, event.attacker_type),
+                                                type_id(shard, event.target_type), event.tick};
+        shard.kill_count.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void BattleStats::add_population(const std::string& type, size_t count) {
+    population[type] += count;
+}
+
+size_t BattleStats::shard_count() const {
+    std::lock_guard<std::mutex> lock(shards_mutex);
+    return shards.size();
+}
+
+BattleStats::Summary BattleStats::summary() const {
+    Summary result;
+    result.regions_x = regions_x;
+    result.regions_y = regions_y;
+    result.heatmap.assign(static_cast<size_t>(regions_x) * regions_y, 0);
+
+    std::map<std::string, std::map<uint64_t, uint64_t>> deaths;
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex);
+        for (const auto& shard : shards) {
+            // Длина журнала - первой: счетчики прочитаны не раньше его записей
+            uint64_t kills = shard->kill_count.load(std::memory_order_acquire);
+            const Shard::KillChunk* chunk = &shard->first;
+            for (uint64_t i = 0; i < kills; ++i) {
+                if (i > 0 && i % Shard::KillChunk::SIZE == 0) {
+                    chunk = chunk->next.get();
+                }
+                const Shard::Kill& kill = chunk->kills[i % Shard::KillChunk::SIZE];
+                const std::string& victim = type_names[kill.victim];
+                ++result.kills[{type_names[kill.killer], victim}];
+                ++deaths[victim][kill.tick];
+            }
+
+            result.fights += shard->fights.load(std::memory_order_relaxed);
+            for (int i = 0; i < DICE_SIDES; ++i) {
+                result.attack_rolls[i] += shard->attack_rolls[i].load(std::memory_order_relaxed);
+                result.defense_rolls[i] += shard->defense_rolls[i].load(std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < result.heatmap.size(); ++i) {
+                result.heatmap[i] += shard->heatmap[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Кривая выживания: начальная численность минус накопленные смерти
+    std::set<std::string> types;
+    for (const auto& [type, count] : population) types.insert(type);
+    for (const auto& [type, per_tick] : deaths) types.insert(type);
+
+    for (const auto& type : types) {
+        auto pop = population.find(type);
+        int64_t alive = pop != population.end() ? static_cast<int64_t>(pop->second) : 0;
+
+        const auto& per_tick = deaths[type];
+        if (per_tick.empty() || per_tick.begin()->first > 0) {
+            result.survival.push_back({0, type, alive});
+        }
+        for (const auto& [tick, count] : per_tick) {
+            alive -= static_cast<int64_t>(count);
+            result.survival.push_back({tick, type, alive});
+        }
+    }
+
+    return result;
+}
+
+void BattleStats::export_csv(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+
+    Summary data = summary();
+
+    file << "section,key,subkey,value\n";
+    file << "fights,,," << data.fights << "\n";
+    for (const auto& [pair, count] : data.kills) {
+        file << "kills," << pair.first << "," << pair.second << "," << count << "\n";
+    }
+    for (int i = 0; i < DICE_SIDES; ++i) {
+        file << "attack_roll," << (i + 1) << ",," << data.attack_rolls[i] << "\n";
+    }
+    for (int i = 0; i < DICE_SIDES; ++i) {
+        file << "defense_roll," << (i + 1) << ",," << data.defense_rolls[i] << "\n";
+    }
+    for (const auto& point : data.survival) {
+        file << "survival," << point.type << "," << point.tick << "," << point.alive << "\n";
+    }
+    for (int ry = 0; ry < data.regions_y; ++ry) {
+        for (int rx = 0; rx < data.regions_x; ++rx) {
+            file << "heatmap," << rx << "," << ry << ","
+                 << data.heatmap[static_cast<size_t>(ry) * data.regions_x + rx] << "\n";
+        }
+    }
+}
+
+void BattleStats::export_json(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+
+    Summary data = summary();
+
+    file << "{\n  \"fights\": " << data.fights << ",\n";
+
+    file << "  \"kills\": [";
+    bool first = true;
+    for (const auto& [pair, count] : data.kills) {
+        file << (first ? "\n" : ",\n")
+             << "    {\"killer\": \"" << json_escape(pair.first)
+             << "\", \"victim\": \"" << json_escape(pair.second)
+             << "\", \"count\": " << count << "}";
+        first = false;
+    }
+    file << (first ? "],\n" : "\n  ],\n");
+
+    auto write_rolls = [&file](const char* key, const std::array<uint64_t, DICE_SIDES>& rolls) {
+        file << "  \"" << key << "\": [";
+        for (int i = 0; i < DICE_SIDES; ++i) {
+            file << (i ? ", " : "") << rolls[i];
+        }
+        file << "],\n";
+    };
+    write_rolls("attack_rolls", data.attack_rolls);
+    write_rolls("defense_rolls", data.defense_rolls);
+
+    file << "  \"survival\": [";
+    first = true;
+    for (const auto& point : data.survival) {
+        file << (first ? "\n" : ",\n")
+             << "    {\"type\": \"" << json_escape(point.type)
+             << "\", \"tick\": " << point.tick
+             << ", \"alive\": " << point.alive << "}";
+        first = false;
+    }
+    file << (first ? "],\n" : "\n  ],\n");
+
+    file << "  \"heatmap\": {\"regions_x\": " << data.regions_x
+         << ", \"regions_y\": " << data.regions_y << ", \"fights\": [";
+    for (size_t i = 0; i < data.heatmap.size(); ++i) {
+        file << (i ? ", " : "") << data.heatmap[i];
+    }
+    file << "]}\n}\n";
+}
@@ -20,14 +20,16 @@ void BattleVisitor::subscribe(Observer* observer) {
     event_manager.subscribe(observer);
 }
 
+void BattleVisitor::set_population(PopulationCounters* counters) {
+    population = counters;
+}
+
 void BattleVisitor::perform_battle(NPC& target) {
     if (!current_attacker || !current_attacker->is_alive() || !target.is_alive()) {
         return;
     }
 
-    double distance = current_attacker->get_position().distance_to(target.get_position());
-    
-    if (distance > battle_radius) {
+    if (!current_attacker->get_position().within(target.get_position(), battle_radius)) {
         return;
     }
 
@@ -42,19 +44,28 @@ void BattleVisitor::execute_battle_logic(NPC& attacker, NPC& target) {
     // Tell Don't Ask: говорим цели умереть, если атакующий может убить
     if (action1.has_value()) {
         target.kill();
-        notify_kill(action1.value(), attacker.get_name(), target.get_name());
+        notify_kill(action1.value(), attacker, target);
     }
 
     // Tell Don't Ask: говорим атакующему умереть, если цель может убить
     if (action2.has_value()) {
         attacker.kill();
-        notify_kill(action2.value(), target.get_name(), attacker.get_name());
+        notify_kill(action2.value(), target, attacker);
     }
 }
 
-void BattleVisitor::notify_kill(const std::string& action, const std::string& killer_name, const std::string& victim_name) {
+void BattleVisitor::notify_kill(const std::string& action, const NPC& killer, const NPC& victim) {
     BattleEvent event;
-    event.action = action + " (" + killer_name + " убивает " + victim_name + ")";
+    event.action = action + " (" + killer.get_name() + " убивает " + victim.get_name() + ")";
+    event.attacker_type = killer.get_type();
+    event.target_type = victim.get_type();
+    event.location = victim.get_position();
+    event.killed = true;
+    if (population) {
+        int type = population->type_index(event.target_type);
+        if (type >= 0) population->on_death(static_cast<size_t>(type));
+        event.population = population;
+    }
     event_manager.publish(event);
 }
 
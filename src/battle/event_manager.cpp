@@ -3,34 +3,101 @@
 #include "../../include/battle/battle_event.h"
 #include <vector>
 #include <algorithm>
+#include <condition_variable>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 
 class EventManager::Impl {
 public:
-    std::vector<Observer*> observers;
+    // Неизменяемый список и число публикаций, которые его обходят
+    struct ObserverList {
+        std::vector<Observer*> observers;
+        mutable size_t publishing = 0; // под mutex
+    };
+    
+    mutable std::mutex mutex; // короткие секции: подмена списка и счетчики
+    mutable std::condition_variable quiescent;
+    std::shared_ptr<const ObserverList> observers{std::make_shared<const ObserverList>()};
+    
+    // Менеджеры, чью публикацию сейчас выполняет поток (вложенные publish)
+    static thread_local std::vector<const Impl*> publishing_here;
     
     void subscribe(Observer* observer) {
-        if (observer != nullptr) {
-            observers.push_back(observer);
+        if (observer == nullptr) {
+            return;
         }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto next = std::make_shared<ObserverList>();
+        next->observers = observers->observers;
+        next->observers.push_back(observer);
+        observers = std::move(next);
     }
     
     void unsubscribe(Observer* observer) {
-        observers.erase(
-            std::remove(observers.begin(), observers.end(), observer),
-            observers.end()
-        );
+        // Ожидание собственной публикации никогда не закончится
+        if (std::find(publishing_here.begin(), publishing_here.end(), this) != publishing_here.end()) {
+            throw std::logic_error("EventManager::unsubscribe из notify этого же менеджера");
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto& current = observers->observers;
+        if (std::find(current.begin(), current.end(), observer) == current.end()) {
+            return;
+        }
+        auto next = std::make_shared<ObserverList>();
+        std::copy_if(current.begin(), current.end(), std::back_inserter(next->observers),
+                     [observer](Observer* o) { return o != observer; });
+        std::shared_ptr<const ObserverList> previous = std::move(observers);
+        observers = std::move(next);
+        
+        // Ждем публикации, которые еще обходят прежний список
+        quiescent.wait(lock, [&previous]() { return previous->publishing == 0; });
     }
     
-    void publish(const BattleEvent& event) const {
-        for (auto* observer : observers) {
-            if (observer != nullptr) {
-                observer->notify(event);
+    template <typename Deliver>
+    void publish_with(Deliver deliver) const {
+        publishing_here.push_back(this);
+        std::shared_ptr<const ObserverList> current;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = observers;
+            ++current->publishing;
+        }
+        
+        // Счетчик уменьшается и при исключении наблюдателя
+        struct Leave {
+            const Impl& impl;
+            const ObserverList& list;
+            ~Leave() {
+                publishing_here.pop_back();
+                std::lock_guard<std::mutex> lock(impl.mutex);
+                if (--list.publishing == 0) {
+                    impl.quiescent.notify_all();
+                }
             }
+        } leave{*this, *current};
+        
+        for (auto* observer : current->observers) {
+            deliver(observer);
+        }
+    }
+    
+    void publish(const BattleEvent& event) const {
+        publish_with([&event](Observer* observer) { observer->notify(event); });
+    }
+    
+    void publish_batch(std::span<const BattleEvent> events) const {
+        if (events.empty()) {
+            return;
         }
+        publish_with([events](Observer* observer) { observer->notify_batch(events); });
     }
 };
 
+thread_local std::vector<const EventManager::Impl*> EventManager::Impl::publishing_here;
+
 EventManager::EventManager() : pImpl(std::make_unique<Impl>()) {}
 
 EventManager::~EventManager() = default;
@@ -50,3 +117,6 @@ void EventManager::publish(const BattleEvent& event) const {
     pImpl->publish(event);
 }
 
+void EventManager::publish_batch(std::span<const BattleEvent> events) const {
+    pImpl->publish_batch(events);
+}
@@ -0,0 +1,27 @@
+#include "../../include/battle/variant_battle.h"
+#include "../../include/battle/battle_event.h"
+
+VariantBattle::VariantBattle(double radius) : battle_radius(radius) {}
+
+void VariantBattle::subscribe(Observer* observer) {
+    event_manager.subscribe(observer);
+}
+
+void VariantBattle::set_population(PopulationCounters* counters) {
+    population = counters;
+}
+
+void VariantBattle::notify_kill(const char* action, const NPC& killer, const NPC& victim) {
+    BattleEvent event;
+    event.action = std::string(action) + " (" + killer.get_name() + " убивает " + victim.get_name() + ")";
+    event.attacker_type = killer.get_type();
+    event.target_type = victim.get_type();
+    event.location = victim.get_position();
+    event.killed = true;
+    if (population) {
+        int type = population->type_index(event.target_type);
+        if (type >= 0) population->on_death(static_cast<size_t>(type));
+        event.population = population;
+    }
+    event_manager.publish(event);
+}
@@ -0,0 +1,104 @@
+#include "../../include/behavior/behavior_scheduler.h"
+
+namespace {
+
+constexpr size_t PREFETCH_DISTANCE = 8;
+
+} // namespace
+
+BehaviorScheduler::~BehaviorScheduler() {
+    clear();
+}
+
+void BehaviorScheduler::schedule(uint32_t key, uint64_t due) {
+    wheel[due % WHEEL_SLOTS].push_back({key, tasks[key].generation, due});
+}
+
+void BehaviorScheduler::spawn(uint32_t key, BehaviorTask task) {
+    if (!task) {
+        return;
+    }
+    if (key >= tasks.size()) {
+        tasks.resize(static_cast<size_t>(key) + 1);
+    }
+    cancel(key);
+
+    Task& entry = tasks[key];
+    entry.handle = task.release();
+    entry.handle.promise().leaf = entry.handle;
+    ++active_count;
+    schedule(key, tick + 1);
+}
+
+void BehaviorScheduler::cancel(uint32_t key) {
+    if (!has_task(key)) {
+        return;
+    }
+    // Таймеры ключа остаются в колесе и отбрасываются по поколению
+    Task& entry = tasks[key];
+    entry.handle.destroy();
+    entry.handle = {};
+    ++entry.generation;
+    --active_count;
+}
+
+void BehaviorScheduler::clear() {
+    for (uint32_t key = 0; key < tasks.size(); ++key) {
+        cancel(key);
+    }
+    for (auto& slot : wheel) {
+        slot.clear();
+    }
+}
+
+void BehaviorScheduler::advance() {
+    ++tick;
+    resumed.clear();
+
+    auto& slot = wheel[tick % WHEEL_SLOTS];
+    due_now.swap(slot);
+
+    // Кадры разбросаны по пулу: корень сценария подгружается за
+    // 2 * PREFETCH_DISTANCE записей, лист (его адрес лежит в корне) - за PREFETCH_DISTANCE
+    auto prefetch = [this](size_t index, bool leaf) {
+        if (index >= due_now.size()) return;
+        const Task& ahead = tasks[due_now[index].key];
+        if (!ahead.handle) return;
+        __builtin_prefetch(leaf ? ahead.handle.promise().leaf.address() : ahead.handle.address());
+    };
+
+    std::exception_ptr first_error;
+    for (size_t i = 0; i < due_now.size(); ++i) {
+        prefetch(i + 2 * PREFETCH_DISTANCE, false);
+        prefetch(i + PREFETCH_DISTANCE, true);
+        const Timer& timer = due_now[i];
+        if (tasks[timer.key].generation != timer.generation || !tasks[timer.key].handle) {
+            continue; // сценарий отменен
+        }
+        if (timer.due > tick) {
+            slot.push_back(timer); // ждет следующего оборота колеса
+            continue;
+        }
+
+        BehaviorTask::Handle handle = tasks[timer.key].handle;
+        BehaviorTask::promise_type& promise = handle.promise();
+        promise.wake_after = 1;
+        promise.leaf.resume();
+        ++resume_count;
+        resumed.push_back(timer.key);
+
+        if (handle.done()) {
+            if (promise.error && !first_error) {
+                first_error = promise.error;
+            }
+            cancel(timer.key);
+        } else {
+            schedule(timer.key, tick + promise.wake_after);
+        }
+    }
+    due_now.clear();
+
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
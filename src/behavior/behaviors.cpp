@@ -0,0 +1,68 @@
+#include "../../include/behavior/behaviors.h"
+#include <cmath>
+
+namespace {
+
+bool same_cell(const Point& a, const Point& b) {
+    return a.get_x() == b.get_x() && a.get_y() == b.get_y();
+}
+
+} // namespace
+
+bool step_towards(BehaviorWorld& world, NPC& self, const Point& goal) {
+    Point from = self.get_position();
+    int dx = goal.get_x() - from.get_x();
+    int dy = goal.get_y() - from.get_y();
+    if (dx == 0 && dy == 0) {
+        return true;
+    }
+
+    int reach = self.get_move_distance();
+    if (!from.within(goal, reach)) {
+        double scale = reach / std::sqrt(static_cast<double>(from.distance_sq(goal)));
+        dx = static_cast<int>(std::round(dx * scale));
+        dy = static_cast<int>(std::round(dy * scale));
+    }
+    world.step(self, dx, dy);
+    return same_cell(self.get_position(), goal);
+}
+
+BehaviorTask walk_to(BehaviorWorld& world, NPC& self, Point goal) {
+    while (true) {
+        Point before = self.get_position();
+        if (step_towards(world, self, goal) || same_cell(before, self.get_position())) {
+            co_return; // на месте или путь прегражден
+        }
+        co_await wait_ticks{1};
+    }
+}
+
+BehaviorTask patrol(BehaviorWorld& world, NPC& self, Point a, Point b, uint32_t pause_ticks, uint32_t laps) {
+    // Пауза не короче тика: следующий отрезок не начинается в тике, где сделан шаг
+    for (uint32_t lap = 0; laps == 0 || lap < laps; ++lap) {
+        co_await walk_to(world, self, a);
+        co_await wait_ticks{pause_ticks};
+        co_await walk_to(world, self, b);
+        co_await wait_ticks{pause_ticks};
+    }
+}
+
+BehaviorTask chase(BehaviorWorld& world, NPC& self, NPCHandle target, uint32_t give_up_ticks) {
+    for (uint32_t t = 0; t < give_up_ticks; ++t) {
+        std::optional<Point> position = world.locate(target);
+        if (!position) {
+            co_return; // цель погибла
+        }
+        if (!self.get_position().within(*position, self.get_kill_distance())) {
+            step_towards(world, self, *position);
+        }
+        co_await wait_ticks{1};
+    }
+}
+
+BehaviorTask sentry(BehaviorWorld& world, NPC& self, uint32_t wait_ticks_before, Point a, Point b,
+                    NPCHandle target, uint32_t give_up_ticks) {
+    co_await wait_ticks{wait_ticks_before};
+    co_await patrol(world, self, a, b, 1, 1);
+    co_await chase(world, self, target, give_up_ticks);
+}
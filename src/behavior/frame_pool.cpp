@@ -0,0 +1,50 @@
+#include "../../include/behavior/frame_pool.h"
+#include <new>
+
+FramePool& FramePool::instance() {
+    static FramePool pool;
+    return pool;
+}
+
+void* FramePool::allocate(size_t size) {
+    if (!pool.pooled(size)) {
+        void* frame = ::operator new(size);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++oversized;
+        return frame;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    void* result = pool.allocate(size);
+    if (!result) {
+        chunks.push_back(std::make_unique<std::byte[]>(CHUNK_BYTES));
+        pool.add_chunk(chunks.back().get(), CHUNK_BYTES);
+        result = pool.allocate(size);
+    }
+    return result;
+}
+
+void FramePool::deallocate(void* block, size_t size) noexcept {
+    if (!block) {
+        return;
+    }
+    if (!pool.pooled(size)) {
+        ::operator delete(block);
+        std::lock_guard<std::mutex> lock(mutex);
+        --oversized;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pool.deallocate(block, size);
+}
+
+size_t FramePool::reserved_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size() * CHUNK_BYTES;
+}
+
+size_t FramePool::frames_in_use() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pool.blocks_in_use() + oversized;
+}
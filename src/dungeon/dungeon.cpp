@@ -10,7 +10,8 @@
 #include <algorithm>
 
 DungeonEditor::DungeonEditor() 
-    : factory(std::make_unique<NPCFactory>()) {
+    : factory(std::make_unique<NPCFactory>()),
+      alive_counters(factory->get_types()) {
     initialize_observers();
 }
 
@@ -28,6 +29,7 @@ void DungeonEditor::add_npc(const std::string& type, const std::string& name, in
         }
         Point position(x, y);
         auto npc = factory->create(type, name, position);
+        index_npc(*npc);
         npcs.push_back(std::move(npc));
         std::cout << "Добавлен " << type << " '" << name << "' в позиции (" << x << ", " << y << ")\n";
     } catch (const std::exception& e) {
@@ -48,6 +50,7 @@ void DungeonEditor::load_from_file(const std::string& filename) {
     try {
         auto loaded_npcs = factory->load_from_file(filename);
         npcs = std::move(loaded_npcs);
+        rebuild_index();
         std::cout << "Данные загружены из файла: " << filename << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Ошибка при загрузке: " << e.what() << std::endl;
@@ -73,6 +76,7 @@ void DungeonEditor::start_battle(double radius) {
     BattleVisitor battle_visitor(radius);
     battle_visitor.subscribe(console_observer.get());
     battle_visitor.subscribe(file_observer.get());
+    battle_visitor.set_population(&alive_counters);
     
     // Tell Don't Ask: говорим visitor'у выполнить битву, не спрашиваем детали
     for (size_t i = 0; i < npcs.size(); ++i) {
@@ -81,9 +85,7 @@ void DungeonEditor::start_battle(double radius) {
         for (size_t j = i + 1; j < npcs.size(); ++j) {
             if (!npcs[j] || !npcs[j]->is_alive()) continue;
             
-            double distance = npcs[i]->get_position().distance_to(npcs[j]->get_position());
-            
-            if (distance <= radius) {
+            if (npcs[i]->get_position().within(npcs[j]->get_position(), radius)) {
                 battle_visitor.set_attacker(npcs[i].get());
                 npcs[j]->accept(battle_visitor);
             }
@@ -97,17 +99,11 @@ void DungeonEditor::start_battle(double radius) {
 }
 
 size_t DungeonEditor::get_alive_count() const {
-    return std::count_if(npcs.begin(), npcs.end(),
-        [](const auto& npc) {
-            return npc != nullptr && npc->is_alive();
-        });
+    return alive_counters.alive();
 }
 
 bool DungeonEditor::is_name_exists(const std::string& name) const {
-    return std::any_of(npcs.begin(), npcs.end(),
-        [&name](const auto& npc) {
-            return npc && npc->get_name() == name;
-        });
+    return names.count(name) > 0;
 }
 
 void DungeonEditor::remove_dead_npcs() {
@@ -115,6 +111,15 @@ void DungeonEditor::remove_dead_npcs() {
 }
 
 void DungeonEditor::cleanup_dead_npcs() {
+    for (const auto& npc : npcs) {
+        if (npc && !npc->is_alive()) {
+            const NPC* dead = npc.get();
+            index.remove(npc->get_position(), [dead](const IndexedNPC& item) { return item.npc == dead; });
+            auto name = names.find(npc->get_name());
+            if (name != names.end()) names.erase(name);
+        }
+    }
+    
     npcs.erase(
         std::remove_if(npcs.begin(), npcs.end(),
             [](const auto& npc) {
@@ -123,3 +128,54 @@ void DungeonEditor::cleanup_dead_npcs() {
         npcs.end()
     );
 }
+
+void DungeonEditor::index_npc(const NPC& npc) {
+    int type = alive_counters.type_index(npc.get_type());
+    index.insert({npc.get_position(), &npc, static_cast<uint8_t>(type)});
+    names.insert(npc.get_name());
+    if (npc.is_alive()) {
+        alive_counters.on_spawn(static_cast<size_t>(type));
+    }
+}
+
+void DungeonEditor::rebuild_index() {
+    index.clear();
+    names.clear();
+    alive_counters.reset();
+    for (const auto& npc : npcs) {
+        if (npc) {
+            index_npc(*npc);
+        }
+    }
+}
+
+std::vector<const NPC*> DungeonEditor::find_in_rect(int x_min, int y_min, int x_max, int y_max) const {
+    std::vector<const NPC*> result;
+    index.for_each_in_rect(x_min, y_min, x_max, y_max,
+        [&result](const IndexedNPC& item) { result.push_back(item.npc); });
+    return result;
+}
+
+std::vector<const NPC*> DungeonEditor::find_nearest(int x, int y, size_t k) const {
+    std::vector<const NPC*> result;
+    for (const IndexedNPC* item : index.nearest(Point(x, y), k)) {
+        result.push_back(item->npc);
+    }
+    return result;
+}
+
+std::map<std::string, size_t> DungeonEditor::count_by_type_in_radius(int x, int y, double radius) const {
+    // Подсчет по индексам типов, имена подставляются один раз в конце
+    const auto& type_names = alive_counters.types();
+    std::vector<size_t> counts(type_names.size(), 0);
+    index.for_each_in_radius(Point(x, y), radius,
+        [&counts](const IndexedNPC& item) { ++counts[item.type]; });
+    
+    std::map<std::string, size_t> result;
+    for (size_t type = 0; type < counts.size(); ++type) {
+        if (counts[type] > 0) {
+            result[type_names[type]] = counts[type];
+        }
+    }
+    return result;
+}
@@ -0,0 +1,254 @@
+#include "../../include/game/checkpoint.h"
+#include "../../include/io/byte_io.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char* CORRUPTED = "Поврежденная контрольная точка";
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Нулевой дескриптор кодируется нулем, остальные - индексом + 1
+void put_handle(ByteWriter& out, const NPCHandle& handle) {
+    out.varint(handle.is_null() ? 0 : static_cast<uint64_t>(handle.index) + 1);
+    out.varint(handle.generation);
+}
+
+NPCHandle read_handle(ByteReader& in) {
+    uint64_t index = in.varint();
+    NPCHandle handle;
+    handle.generation = static_cast<uint32_t>(in.varint());
+    if (index != 0) {
+        handle.index = static_cast<uint32_t>(index - 1);
+    }
+    return handle;
+}
+
+void put_point(ByteWriter& out, const Point& point) {
+    out.zigzag(point.get_x());
+    out.zigzag(point.get_y());
+}
+
+Point read_point(ByteReader& in) {
+    int x = static_cast<int>(in.zigzag());
+    int y = static_cast<int>(in.zigzag());
+    return Point(x, y);
+}
+
+// Число элементов не может превышать остаток данных (защита от огромных reserve)
+size_t read_count(ByteReader& in) {
+    uint64_t count = in.varint();
+    if (count > in.remaining()) {
+        in.fail("неверное число элементов");
+    }
+    return static_cast<size_t>(count);
+}
+
+} // namespace
+
+void GameCheckpoint::encode(std::vector<uint8_t>& buffer) const {
+    size_t start = buffer.size();
+    ByteWriter out(buffer);
+
+    out.u32(MAGIC);
+    out.u32(VERSION);
+    out.u64(tick);
+
+    out.varint(types.size());
+    for (const auto& type : types) {
+        out.string(type);
+    }
+
+    out.string(movement_rng);
+    out.string(battle_rng);
+    out.string(init_rng);
+
+    out.varint(kills_since_compaction);
+    out.varint(ticks_since_compaction);
+    out.varint(filter_candidates);
+    out.varint(filter_impossible);
+    out.varint(filter_duplicates);
+    out.varint(filter_pushed);
+
+    out.varint(slot_generations.size());
+    for (uint32_t generation : slot_generations) {
+        out.varint(generation);
+    }
+    out.varint(free_slots.size());
+    for (uint32_t index : free_slots) {
+        out.varint(index);
+    }
+
+    out.varint(active_count);
+    out.varint(npcs.size());
+    for (const auto& npc : npcs) {
+        put_handle(out, npc.handle);
+        out.u8(npc.type);
+        out.string(npc.name);
+        put_point(out, npc.position);
+        out.u8(npc.alive ? 1 : 0);
+    }
+
+    out.varint(pending.size());
+    for (const auto& task : pending) {
+        put_handle(out, task.attacker);
+        put_handle(out, task.target);
+        put_point(out, task.location);
+    }
+
+    out.varint(flow_sources.size());
+    for (const auto& sources : flow_sources) {
+        out.varint(sources.size());
+        for (const auto& point : sources) {
+            put_point(out, point);
+        }
+    }
+
+    out.varint(lod_due.size());
+    for (size_t slot = 0; slot < lod_due.size(); ++slot) {
+        out.varint(lod_due[slot]);
+        out.u8(lod_period[slot]);
+    }
+
+    out.u64(fnv1a(buffer.data() + start, buffer.size() - start));
+}
+
+GameCheckpoint GameCheckpoint::decode(const uint8_t* data, size_t size) {
+    if (size < sizeof(uint64_t)) {
+        throw std::runtime_error(std::string(CORRUPTED) + ": слишком короткие данные");
+    }
+    size_t body = size - sizeof(uint64_t);
+    ByteReader trailer(data + body, sizeof(uint64_t), CORRUPTED);
+    if (trailer.u64() != fnv1a(data, body)) {
+        trailer.fail("неверная контрольная сумма");
+    }
+
+    ByteReader in(data, body, CORRUPTED);
+    if (in.u32() != MAGIC) {
+        in.fail("неверная сигнатура");
+    }
+    if (in.u32() != VERSION) {
+        in.fail("неподдерживаемая версия");
+    }
+
+    GameCheckpoint result;
+    result.tick = in.u64();
+
+    result.types.resize(read_count(in));
+    for (auto& type : result.types) {
+        type = in.string();
+    }
+
+    result.movement_rng = in.string();
+    result.battle_rng = in.string();
+    result.init_rng = in.string();
+
+    result.kills_since_compaction = in.varint();
+    result.ticks_since_compaction = in.varint();
+    result.filter_candidates = in.varint();
+    result.filter_impossible = in.varint();
+    result.filter_duplicates = in.varint();
+    result.filter_pushed = in.varint();
+
+    result.slot_generations.resize(read_count(in));
+    for (auto& generation : result.slot_generations) {
+        generation = static_cast<uint32_t>(in.varint());
+    }
+    result.free_slots.resize(read_count(in));
+    for (auto& index : result.free_slots) {
+        index = static_cast<uint32_t>(in.varint());
+    }
+
+    result.active_count = in.varint();
+    result.npcs.resize(read_count(in));
+    for (auto& npc : result.npcs) {
+        npc.handle = read_handle(in);
+        npc.type = in.u8();
+        npc.name = in.string();
+        npc.position = read_point(in);
+        npc.alive = in.u8() != 0;
+        if (npc.type >= result.types.size()) {
+            in.fail("неизвестный тип NPC");
+        }
+    }
+
+    result.pending.resize(read_count(in));
+    for (auto& task : result.pending) {
+        task.attacker = read_handle(in);
+        task.target = read_handle(in);
+        task.location = read_point(in);
+    }
+
+    result.flow_sources.resize(read_count(in));
+    if (!result.flow_sources.empty() && result.flow_sources.size() != result.types.size()) {
+        in.fail("неверное число полей направлений");
+    }
+    for (auto& sources : result.flow_sources) {
+        sources.resize(read_count(in));
+        for (auto& point : sources) {
+            point = read_point(in);
+        }
+    }
+
+    size_t slots = read_count(in);
+    if (slots != 0 && slots != result.slot_generations.size()) {
+        in.fail("неверное число слотов уровня детализации");
+    }
+    result.lod_due.resize(slots);
+    result.lod_period.resize(slots);
+    for (size_t slot = 0; slot < slots; ++slot) {
+        result.lod_due[slot] = in.varint();
+        result.lod_period[slot] = in.u8();
+        if (result.lod_period[slot] == 0) {
+            in.fail("нулевой период обновления");
+        }
+    }
+
+    if (!in.done()) {
+        in.fail("лишние данные");
+    }
+    return result;
+}
+
+void GameCheckpoint::save(const std::string& filename) const {
+    std::vector<uint8_t> buffer;
+    encode(buffer);
+
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл для записи: " + temporary);
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+                   static_cast<std::streamsize>(buffer.size()));
+        if (!file) {
+            throw std::runtime_error("Ошибка записи контрольной точки: " + temporary);
+        }
+    }
+
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Не удалось заменить контрольную точку: " + filename);
+    }
+}
+
+GameCheckpoint GameCheckpoint::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для чтения: " + filename);
+    }
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+    return decode(buffer.data(), buffer.size());
+}
@@ -0,0 +1,133 @@
+#include "../../include/game/contact_tracker.h"
+#include <algorithm>
+
+ContactTracker::ContactTracker(int map_width, int map_height, int cell_size)
+    : cell_size(std::max(1, cell_size)),
+      cells_x((std::max(1, map_width) + this->cell_size - 1) / this->cell_size),
+      cells_y((std::max(1, map_height) + this->cell_size - 1) / this->cell_size),
+      cells(static_cast<size_t>(cells_x) * cells_y) {}
+
+int ContactTracker::cell_of(const Point& position) const {
+    int cx = std::clamp(position.get_x() / cell_size, 0, cells_x - 1);
+    int cy = std::clamp(position.get_y() / cell_size, 0, cells_y - 1);
+    return cy * cells_x + cx;
+}
+
+bool ContactTracker::in_contact(const Entity& a, const Entity& b) {
+    return a.position.within(b.position, std::max(a.reach, b.reach));
+}
+
+void ContactTracker::mark_dirty(uint32_t id) {
+    if (!entities[id].dirty) {
+        entities[id].dirty = true;
+        dirty.push_back(id);
+    }
+}
+
+void ContactTracker::move_to_cell(uint32_t id, int cell) {
+    Entity& entity = entities[id];
+    if (entity.cell == cell) {
+        return;
+    }
+    if (entity.cell >= 0) {
+        auto& old_cell = cells[entity.cell];
+        old_cell.erase(std::find(old_cell.begin(), old_cell.end(), id));
+    }
+    if (cell >= 0) {
+        cells[cell].push_back(id);
+    }
+    entity.cell = cell;
+}
+
+void ContactTracker::unlink_contacts(uint32_t id) {
+    for (uint32_t other : entities[id].contacts) {
+        auto& list = entities[other].contacts;
+        list.erase(std::find(list.begin(), list.end(), id));
+    }
+    entities[id].contacts.clear();
+}
+
+void ContactTracker::update(uint32_t id, const Point& position, int reach) {
+    if (id >= entities.size()) {
+        entities.resize(id + 1);
+    }
+
+    Entity& entity = entities[id];
+    if (entity.present && entity.position.get_x() == position.get_x() &&
+        entity.position.get_y() == position.get_y() && entity.reach == reach) {
+        return; // не сдвинулась - контакты прежние
+    }
+
+    entity.present = true;
+    entity.position = position;
+    entity.reach = reach;
+    move_to_cell(id, cell_of(position));
+    mark_dirty(id);
+}
+
+void ContactTracker::remove(uint32_t id) {
+    if (id >= entities.size() || !entities[id].present) {
+        return;
+    }
+    unlink_contacts(id);
+    move_to_cell(id, -1);
+    entities[id].present = false;
+}
+
+void ContactTracker::refresh() {
+    dirty_count = dirty.size();
+    pair_checks = 0;
+
+    // Сначала рвем старые контакты всех "грязных", затем строим новые:
+    // пара двух "грязных" так обрабатывается ровно один раз
+    for (uint32_t id : dirty) {
+        if (entities[id].present) {
+            unlink_contacts(id);
+        }
+    }
+
+    for (uint32_t id : dirty) {
+        Entity& entity = entities[id];
+        entity.dirty = false;
+        if (!entity.present) continue;
+
+        int cx = entity.cell % cells_x;
+        int cy = entity.cell / cells_x;
+        for (int ny = std::max(0, cy - 1); ny <= std::min(cells_y - 1, cy + 1); ++ny) {
+            for (int nx = std::max(0, cx - 1); nx <= std::min(cells_x - 1, cx + 1); ++nx) {
+                for (uint32_t other : cells[ny * cells_x + nx]) {
+                    if (other == id) continue;
+                    // Пара двух "грязных" проверяется со стороны уже обработанного
+                    if (entities[other].dirty) continue;
+                    ++pair_checks;
+                    if (in_contact(entity, entities[other])) {
+                        entity.contacts.push_back(other);
+                        entities[other].contacts.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    dirty.clear();
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> ContactTracker::contacts() const {
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    for_each_contact([&result](uint32_t a, uint32_t b) { result.emplace_back(a, b); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> ContactTracker::brute_force_contacts() const {
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    for (uint32_t a = 0; a < entities.size(); ++a) {
+        if (!entities[a].present) continue;
+        for (uint32_t b = a + 1; b < entities.size(); ++b) {
+            if (entities[b].present && in_contact(entities[a], entities[b])) {
+                result.emplace_back(a, b);
+            }
+        }
+    }
+    return result;
+}
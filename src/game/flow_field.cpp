@@ -0,0 +1,90 @@
+#include "../../include/game/flow_field.h"
+#include "../../include/game/terrain.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Порядок соседей фиксирован: выбор направления детерминирован
+constexpr int NEIGHBOUR_DX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+constexpr int NEIGHBOUR_DY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+} // namespace
+
+FlowField::FlowField(int width, int height)
+    : field_width(width), field_height(height) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Размеры поля направлений должны быть положительными");
+    }
+    distances.assign(static_cast<size_t>(width) * height, UNREACHABLE);
+}
+
+void FlowField::rebuild(const std::vector<Point>& sources, const TerrainMap* terrain) {
+    std::fill(distances.begin(), distances.end(), UNREACHABLE);
+    queue.clear();
+    queue.reserve(distances.size());
+
+    auto passable = [&](int x, int y) {
+        return !terrain || terrain->is_passable(Point(x, y));
+    };
+
+    for (const Point& source : sources) {
+        int x = source.get_x();
+        int y = source.get_y();
+        if (!in_bounds(x, y) || !passable(x, y)) continue;
+        uint32_t cell = static_cast<uint32_t>(index(x, y));
+        if (distances[cell] == 0) continue;
+        distances[cell] = 0;
+        queue.push_back(cell);
+    }
+
+    // Очередь - сам вектор: голова движется по нему, волны идут по порядку
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t cell = queue[head];
+        int x = static_cast<int>(cell % static_cast<uint32_t>(field_width));
+        int y = static_cast<int>(cell / static_cast<uint32_t>(field_width));
+        uint32_t next = distances[cell] + 1;
+        for (int n = 0; n < 8; ++n) {
+            int nx = x + NEIGHBOUR_DX[n];
+            int ny = y + NEIGHBOUR_DY[n];
+            if (!in_bounds(nx, ny)) continue;
+            uint32_t& d = distances[index(nx, ny)];
+            if (d != UNREACHABLE || !passable(nx, ny)) continue;
+            d = next;
+            queue.push_back(static_cast<uint32_t>(index(nx, ny)));
+        }
+    }
+    visited = queue.size();
+}
+
+uint32_t FlowField::distance(const Point& p) const {
+    return in_bounds(p.get_x(), p.get_y()) ? distances[index(p.get_x(), p.get_y())] : UNREACHABLE;
+}
+
+template <typename Better>
+std::pair<int, int> FlowField::best_neighbour(const Point& p, Better better) const {
+    uint32_t best = distance(p);
+    if (best == UNREACHABLE) {
+        return {0, 0};
+    }
+    std::pair<int, int> step{0, 0};
+    for (int n = 0; n < 8; ++n) {
+        int nx = p.get_x() + NEIGHBOUR_DX[n];
+        int ny = p.get_y() + NEIGHBOUR_DY[n];
+        if (!in_bounds(nx, ny)) continue;
+        uint32_t d = distances[index(nx, ny)];
+        if (d != UNREACHABLE && better(d, best)) {
+            best = d;
+            step = {NEIGHBOUR_DX[n], NEIGHBOUR_DY[n]};
+        }
+    }
+    return step;
+}
+
+std::pair<int, int> FlowField::descend(const Point& p) const {
+    return best_neighbour(p, [](uint32_t d, uint32_t best) { return d < best; });
+}
+
+std::pair<int, int> FlowField::ascend(const Point& p) const {
+    return best_neighbour(p, [](uint32_t d, uint32_t best) { return d > best; });
+}
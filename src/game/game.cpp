@@ -3,6 +3,7 @@
 #include "../../include/npc/squirrel.h"
 #include "../../include/npc/druid.h"
 #include "../../include/geometry/point.h"
+#include "../../include/geometry/morton.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
@@ -10,15 +11,79 @@
 #include <algorithm>
 #include <optional>
 #include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <sstream>
+#include <tuple>
+#include <limits>
 
-Game::Game() 
+namespace {
+
+// Длина суммарного шага за period тиков блуждания шагами move_distance: смещение
+// случайного блуждания близко к нормальному с дисперсией period * move^2 / 2
+// по каждой оси, его длина распределена по Рэлею. Обрезается по period * move -
+// дальше NPC за period тиков не уйдет
+int aggregated_distance(int move_distance, int period, double u) {
+    double length = move_distance * std::sqrt(-period * std::log1p(-u));
+    return static_cast<int>(std::min(std::round(length), static_cast<double>(period * move_distance)));
+}
+
+} // namespace
+
+// Мир сценариев поведения: ход по правилам игры, поиск по дескриптору
+class Game::ScriptWorld : public BehaviorWorld {
+public:
+    explicit ScriptWorld(Game& game) : game(game) {}
+
+    void step(NPC& npc, int dx, int dy) override {
+        if (game.terrain) {
+            std::tie(dx, dy) = game.terrain_step(npc.get_position(), dx, dy);
+        }
+        npc.move(dx, dy, MAP_WIDTH, MAP_HEIGHT);
+    }
+
+    std::optional<Point> locate(NPCHandle target) const override {
+        NPC* npc = game.npcs.get(target);
+        if (!npc || !npc->is_alive()) {
+            return std::nullopt;
+        }
+        return npc->get_position();
+    }
+
+private:
+    Game& game;
+};
+
+Game::Game() : Game(std::random_device{}()) {}
+
+Game::Game(unsigned seed, bool quiet) 
     : factory(std::make_unique<NPCFactory>()),
+      kill_matrix(*factory),
+      contacts(MAP_WIDTH, MAP_HEIGHT, kill_matrix.max_kill_distance()),
+      alive_counters(factory->get_types()),
       running(false),
       game_over(false),
-      movement_rng(std::random_device{}()),
-      battle_rng(std::random_device{}()),
-      init_rng(std::random_device{}()) {
+      quiet(quiet),
+      script_world(std::make_unique<ScriptWorld>(*this)),
+      movement_rng(seed),
+      battle_rng(seed + 1),
+      init_rng(seed + 2) {
+    for (const auto& type : factory->get_types()) {
+        int variant = -1;
+        for_each_npc_type([&](auto index) {
+            if (type == NPCTypeAt<decltype(index)::value>::TYPE_NAME) {
+                variant = static_cast<int>(decltype(index)::value);
+            }
+        });
+        variant_of_type.push_back(variant);
+    }
+    auto type_names = std::make_shared<std::vector<std::string>>();
+    for (size_t t = 0; t < kill_matrix.type_count(); ++t) {
+        type_names->push_back(kill_matrix.type_name(t));
+    }
+    snapshot_types = std::move(type_names);
     initialize_npcs();
+    publish_snapshot();
 }
 
 Game::~Game() {
@@ -26,6 +91,7 @@ Game::~Game() {
 }
 
 void Game::initialize_npcs() {
+    NPCArena::Scope heap_scope(npc_heap.get());
     std::vector<std::string> types = {"Орк", "Белка", "Друид"};
     std::uniform_int_distribution<int> type_dist(0, types.size() - 1);
     std::uniform_int_distribution<int> name_dist(1, 9999);
@@ -36,8 +102,13 @@ void Game::initialize_npcs() {
         Point pos = random_position();
         
         auto npc = factory->create(type, name, pos);
-        npcs.push_back(std::move(npc));
+        size_t type_index = static_cast<size_t>(kill_matrix.type_index(type));
+        NPCHandle handle = npcs.insert(std::move(npc), static_cast<uint8_t>(type_index));
+        remember_name(handle, name);
+        contacts.update(handle.index, pos, kill_matrix.kill_distance(type_index));
+        alive_counters.on_spawn(type_index);
     }
+    contacts.refresh();
 }
 
 Point Game::random_position() const {
@@ -64,7 +135,12 @@ void Game::start() {
 }
 
 void Game::stop() {
-    running = false;
+    {
+        // Под мьютексом очереди, чтобы поток боев не пропустил пробуждение
+        std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+        running = false;
+    }
+    battle_queue_cv.notify_all();
     
     if (movement_thread.joinable()) {
         movement_thread.join();
@@ -74,128 +150,832 @@ void Game::stop() {
     }
 }
 
+void Game::set_placement(const PlacementOptions& options) {
+    NumaTopology topology = NumaTopology::detect();
+    for (int node : {options.movement_node, options.battle_node, options.main_node}) {
+        if (node != -1 && !topology.find(node)) {
+            throw std::invalid_argument("Нет узла NUMA с процессорами: " + std::to_string(node));
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    bool arena = options.huge_pages != HugePages::None || options.movement_node >= 0;
+    if (arena && !npc_heap) {
+        if (behaviors.active() > 0) {
+            throw std::logic_error("Размещение памяти NPC задается до attach_behavior");
+        }
+        // Область настраивается до переноса: куски сразу в нужном режиме и на узле
+        NPCArena::HeapLease heap = NPCArena::instance().acquire();
+        heap->set_huge_pages(options.huge_pages);
+        heap->bind_to_node(options.movement_node);
+        {
+            NPCArena::Scope heap_scope(heap.get());
+            npcs.replace_objects([this](const NPC& npc, uint8_t type) {
+                auto copy = factory->create(kill_matrix.type_name(type), npc.get_name(), npc.get_position());
+                if (!npc.is_alive()) {
+                    copy->kill();
+                }
+                return copy;
+            });
+        }
+        npc_heap = std::move(heap);
+    } else if (npc_heap) {
+        npc_heap->set_huge_pages(options.huge_pages);
+        npc_heap->bind_to_node(options.movement_node);
+    }
+    placement = options;
+}
+
+void Game::place_current_thread(int node, const char* role) {
+    if (node < 0) {
+        return;
+    }
+    try {
+        NumaTopology topology = NumaTopology::detect();
+        const NumaNode* found = topology.find(node);
+        if (!found) {
+            throw std::runtime_error("узел больше не доступен");
+        }
+        pin_current_thread(found->cpus);
+    } catch (const std::runtime_error& e) {
+        std::lock_guard<std::mutex> cout_lock(cout_mutex);
+        std::cerr << "Поток " << role << " не привязан к узлу " << node << ": " << e.what() << "\n";
+    }
+}
+
 void Game::movement_worker() {
-    std::uniform_real_distribution<double> angle_dist(0.0, 2.0 * M_PI);
+    place_current_thread(placement.movement_node, "движения");
+    if (placement.movement_node >= 0) {
+        // Владелец NPC сам касается плотных массивов пула - они на его узле
+        std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+        npcs.reallocate();
+    }
 
     while (running) {
-        // === 1. ДВИЖЕНИЕ NPC ===
-        {
-            std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+        move_npcs();
+        detect_battles();
+        publish_world();
 
-            for (auto& npc_ptr : npcs) {
-                NPC* npc = npc_ptr.get();
-                if (!npc || !npc->is_alive()) continue; // аааа некроманты
+        std::this_thread::sleep_for(tick_interval);
+    }
+
+    if (!quiet) {
+        std::lock_guard<std::mutex> lg(cout_mutex);
+        std::cout << "[MOVE] movement_worker STOPPED\n";
+    }
+}
 
-                double angle = angle_dist(movement_rng);
-                int move_dist = npc->get_move_distance();
+void Game::move_npcs() {
+    std::uniform_real_distribution<double> angle_dist(0.0, 2.0 * M_PI);
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+
+    // Между тиками убираем погибших из активной области
+    compact_if_needed();
+    if (flow_movement) {
+        if (!flow_sources || tick_count.load() % flow_interval == 0) {
+            rebuild_flow_fields();
+        } else if (!flow_fields_built) {
+            build_flow_fields(); // после set_flow_movement или контрольной точки
+        }
+    }
 
-                int dx = static_cast<int>(std::round(std::cos(angle) * move_dist));
-                int dy = static_cast<int>(std::round(std::sin(angle) * move_dist));
+    // Пустой план - все NPC ходят каждый тик
+    if (level_of_detail && !flow_movement) {
+        plan_level_of_detail();
+    } else {
+        lod_plan.clear();
+    }
 
-                npc->move(dx, dy, MAP_WIDTH, MAP_HEIGHT);
+    if (type_buckets) {
+        move_bucketed();
+    } else {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        for (size_t i = 0; i < npcs.size(); ++i) {
+            NPC* npc = npcs.at(i);
+            if (!npc || !npc->is_alive()) continue; // аааа некроманты
+            if (behaviors.has_task(npcs.handle_at(i).index)) continue; // ходит сценарий
+            int period = lod_plan.empty() ? 1 : lod_plan[i];
+            if (period == 0) continue; // спокойный NPC ждет своего тика
+
+            double angle = angle_dist(movement_rng);
+            int move_dist = npc->get_move_distance();
+            if (period > 1) {
+                move_dist = aggregated_distance(move_dist, period, unit(movement_rng));
+            }
+            if (flow_movement) {
+                std::tie(angle, move_dist) = flow_step(i, angle, move_dist);
             }
+            apply_move(i, npc, angle, move_dist);
         }
+    }
 
-        // === 2. ПОИСК БОЁВ ===
-        {
-            std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+    run_behaviors();
+
+    // Пересчитываются только окрестности сдвинувшихся NPC
+    contacts.refresh();
+    reorder_if_scattered();
+
+    ++tick_count;
+}
+
+void Game::move_bucketed() {
+    std::uniform_real_distribution<double> angle_dist(0.0, 2.0 * M_PI);
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Углы выбираются в плотном порядке, как в обычном режиме, - траектории совпадают.
+    // Редкие суммарные шаги уровня детализации делаются здесь же, без корзин
+    move_angles.assign(npcs.size(), 0.0);
+    move_limits.assign(npcs.size(), 0);
+    for (auto& bucket : move_buckets) bucket.clear();
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPC* npc = npcs.at(i);
+        if (!npc || !npc->is_alive()) continue;
+        if (behaviors.has_task(npcs.handle_at(i).index)) continue;
+        int period = lod_plan.empty() ? 1 : lod_plan[i];
+        if (period == 0) continue;
+        move_angles[i] = angle_dist(movement_rng);
+        if (period > 1) {
+            int move_dist = aggregated_distance(npc->get_move_distance(), period, unit(movement_rng));
+            apply_move(i, npc, move_angles[i], move_dist);
+            continue;
+        }
+        move_limits[i] = std::numeric_limits<int>::max();
+        if (flow_movement) {
+            std::tie(move_angles[i], move_limits[i]) =
+                flow_step(i, move_angles[i], std::numeric_limits<int>::max());
+        }
+        move_buckets[variant_of_type[npcs.type_at(i)]].push_back(static_cast<uint32_t>(i));
+    }
+
+    for_each_npc_type([&](auto index) {
+        using T = NPCTypeAt<decltype(index)::value>;
+        for (uint32_t i : move_buckets[decltype(index)::value]) {
+            T* npc = static_cast<T*>(npcs.at(i));
+            int move_dist = std::min(T::MOVE_DISTANCE, move_limits[i]);
+            int dx = static_cast<int>(std::round(std::cos(move_angles[i]) * move_dist));
+            int dy = static_cast<int>(std::round(std::sin(move_angles[i]) * move_dist));
+            if (terrain) {
+                std::tie(dx, dy) = terrain_step(npc->get_position(), dx, dy);
+            }
+
+            npc->move(dx, dy, MAP_WIDTH, MAP_HEIGHT);
+            contacts.update(npcs.handle_at(i).index, npc->get_position(), T::KILL_DISTANCE);
+        }
+    });
+}
+
+void Game::apply_move(size_t dense, NPC* npc, double angle, int distance) {
+    int dx = static_cast<int>(std::round(std::cos(angle) * distance));
+    int dy = static_cast<int>(std::round(std::sin(angle) * distance));
+    if (terrain) {
+        std::tie(dx, dy) = terrain_step(npc->get_position(), dx, dy);
+    }
+
+    npc->move(dx, dy, MAP_WIDTH, MAP_HEIGHT);
+    contacts.update(npcs.handle_at(dense).index, npc->get_position(),
+                    kill_matrix.kill_distance(npcs.type_at(dense)));
+}
+
+void Game::plan_level_of_detail() {
+    size_t types = kill_matrix.type_count();
+    size_t columns = (MAP_WIDTH + LOD_CELL - 1) / LOD_CELL;
+    size_t rows = (MAP_HEIGHT + LOD_CELL - 1) / LOD_CELL;
+    lod_counts.assign(columns * rows * types, 0);
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        const NPC* npc = npcs.at(i);
+        if (!npc || !npc->is_alive()) continue;
+        Point p = npc->get_position();
+        size_t cell = static_cast<size_t>(p.get_y() / LOD_CELL) * columns + static_cast<size_t>(p.get_x() / LOD_CELL);
+        ++lod_counts[cell * types + npcs.type_at(i)];
+    }
+
+    // Периоды выровнены: период P начинается на тике, кратном P. Окна двух NPC
+    // тогда либо вложены, либо не пересекаются, и за окно большего периода
+    // каждый из пары сдвигается не дальше, чем учтено при его выборе
+    uint64_t now = tick_count.load();
+    int limit = LOD_MAX_PERIOD;
+    while (limit > 1 && now % static_cast<uint64_t>(limit) != 0) {
+        limit /= 2;
+    }
+
+    if (lod_due.size() < npcs.slot_capacity()) {
+        lod_due.resize(npcs.slot_capacity(), 0);
+        lod_period.resize(npcs.slot_capacity(), 1);
+    }
+    lod_plan.assign(npcs.size(), 1);
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        const NPC* npc = npcs.at(i);
+        if (!npc || !npc->is_alive()) continue;
+        uint32_t slot = npcs.handle_at(i).index;
+        if (behaviors.has_task(slot)) {
+            lod_period[slot] = 1; // сценарий ходит каждый тик
+            lod_due[slot] = 0;
+            continue;
+        }
+        if (now < lod_due[slot]) {
+            lod_plan[i] = 0;
+            ++lod_stats.skipped;
+            continue;
+        }
+
+        int period = calm_period(npcs.type_at(i), npc->get_position(), limit);
+        lod_period[slot] = static_cast<uint8_t>(period);
+        lod_due[slot] = now + static_cast<uint64_t>(period);
+        lod_plan[i] = static_cast<uint8_t>(period);
+        if (period > 1) {
+            ++lod_stats.aggregated_updates;
+        } else {
+            ++lod_stats.full_updates;
+        }
+    }
+}
+
+int Game::calm_period(size_t type, const Point& position, int limit) const {
+    for (int period = limit; period > 1; period /= 2) {
+        bool threatened = false;
+        for (size_t other = 0; other < kill_matrix.type_count() && !threatened; ++other) {
+            int reach = 0;
+            if (kill_matrix.can_kill(type, other)) reach = kill_matrix.kill_distance(type);
+            if (kill_matrix.can_kill(other, type)) reach = std::max(reach, kill_matrix.kill_distance(other));
+            if (reach == 0) continue;
+            // Клетка на шаг - запас на округление смещения до целых клеток
+            int closing = period * (kill_matrix.move_distance(type) + kill_matrix.move_distance(other) + 2);
+            threatened = type_within(other, position, reach + closing);
+        }
+        if (!threatened) {
+            return period;
+        }
+    }
+    return 1;
+}
+
+bool Game::type_within(size_t type, const Point& position, int radius) const {
+    // Квадрат со стороной 2 * radius накрывает круг - проверка с запасом
+    size_t types = kill_matrix.type_count();
+    size_t columns = (MAP_WIDTH + LOD_CELL - 1) / LOD_CELL;
+    int x0 = std::max(0, position.get_x() - radius) / LOD_CELL;
+    int x1 = std::min(MAP_WIDTH - 1, position.get_x() + radius) / LOD_CELL;
+    int y0 = std::max(0, position.get_y() - radius) / LOD_CELL;
+    int y1 = std::min(MAP_HEIGHT - 1, position.get_y() + radius) / LOD_CELL;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            if (lod_counts[(static_cast<size_t>(y) * columns + static_cast<size_t>(x)) * types + type] != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int Game::lod_radius(size_t type) const {
+    int radius = 0;
+    for (size_t other = 0; other < kill_matrix.type_count(); ++other) {
+        int reach = 0;
+        if (kill_matrix.can_kill(type, other)) reach = kill_matrix.kill_distance(type);
+        if (kill_matrix.can_kill(other, type)) reach = std::max(reach, kill_matrix.kill_distance(other));
+        if (reach == 0) continue;
+        int closing = LOD_MAX_PERIOD * (kill_matrix.move_distance(type) + kill_matrix.move_distance(other) + 2);
+        radius = std::max(radius, reach + closing);
+    }
+    return radius;
+}
 
-            for (size_t i = 0; i < npcs.size(); ++i) {
-                NPC* a = npcs[i].get();
-                if (!a || !a->is_alive()) continue;
+void Game::reset_level_of_detail() {
+    std::fill(lod_due.begin(), lod_due.end(), 0);
+    std::fill(lod_period.begin(), lod_period.end(), 1);
+}
 
-                for (size_t j = i + 1; j < npcs.size(); ++j) {
-                    NPC* b = npcs[j].get();
-                    if (!b || !b->is_alive()) continue;
+void Game::set_level_of_detail(bool enabled) {
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    level_of_detail = enabled;
+    if (!enabled) {
+        // Повторное включение начнет с чистых периодов; включение после
+        // загрузки контрольной точки сохраняет восстановленные
+        lod_due.clear();
+        lod_period.clear();
+        publish_snapshot(); // контрольная точка не должна вернуть периоды
+    }
+}
 
-                    Point pa = a->get_position();
-                    Point pb = b->get_position();
+int Game::update_period(NPCHandle handle) const {
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex);
+    NPC* npc = npcs.get(handle);
+    if (!npc || !npc->is_alive()) {
+        return 0;
+    }
+    if (!level_of_detail || flow_movement || handle.index >= lod_period.size()) {
+        return 1;
+    }
+    return lod_period[handle.index];
+}
+
+LevelOfDetailStats Game::level_of_detail_stats() const {
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex);
+    return lod_stats;
+}
 
-                    double dx = pa.get_x() - pb.get_x();
-                    double dy = pa.get_y() - pb.get_y();
-                    double dist = std::sqrt(dx * dx + dy * dy);
+void Game::run_behaviors() {
+    if (behaviors.active() == 0) {
+        return;
+    }
+    try {
+        behaviors.advance();
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> cout_lock(cout_mutex);
+        std::cerr << "Ошибка сценария поведения: " << e.what() << "\n";
+    }
 
-                    // a -> b
-                    if (dist <= a->get_kill_distance()) {
-                        std::lock_guard<std::mutex> ql(battle_queue_mutex);
-                        battle_queue.push({a, b});
+    // Сетка контактов узнает только о NPC, чьи сценарии отработали
+    for (uint32_t slot : behaviors.last_resumed()) {
+        NPCHandle handle = npcs.handle_of_slot(slot);
+        NPC* npc = npcs.get(handle);
+        if (npc && npc->is_alive()) {
+            contacts.update(slot, npc->get_position(), kill_matrix.kill_distance(npcs.type_of(handle)));
+        }
+    }
+}
+
+void Game::attach_behavior(NPCHandle handle, const std::function<BehaviorTask(BehaviorWorld&, NPC&)>& script) {
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    NPC* npc = npcs.get(handle);
+    if (!npc || !npc->is_alive()) {
+        throw std::invalid_argument("Сценарий для отсутствующего NPC");
+    }
+    behaviors.spawn(handle.index, script(*script_world, *npc));
+}
+
+size_t Game::behavior_count() const {
+    std::shared_lock<std::shared_mutex> lock(npcs_mutex);
+    return behaviors.active();
+}
+
+void Game::rebuild_flow_fields() {
+    auto sources = std::make_shared<std::vector<std::vector<Point>>>(flow_fields.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPC* npc = npcs.at(i);
+        if (npc && npc->is_alive()) {
+            (*sources)[npcs.type_at(i)].push_back(npc->get_position());
+        }
+    }
+    flow_sources = std::move(sources);
+    build_flow_fields();
+}
+
+void Game::build_flow_fields() {
+    for (size_t type = 0; type < flow_fields.size(); ++type) {
+        flow_fields[type].rebuild((*flow_sources)[type], terrain.get());
+    }
+    flow_fields_built = true;
+}
+
+std::pair<double, int> Game::flow_step(size_t dense, double random_angle, int move_distance) const {
+    size_t type = npcs.type_at(dense);
+    Point position = npcs.at(dense)->get_position();
+    
+    // Ближайший хищник в пределах FLOW_FLEE_DISTANCE - бегство
+    const FlowField* threat = nullptr;
+    uint32_t threat_distance = FLOW_FLEE_DISTANCE + 1;
+    for (size_t predator : predators_of[type]) {
+        uint32_t d = flow_fields[predator].distance(position);
+        if (d < threat_distance) {
+            threat_distance = d;
+            threat = &flow_fields[predator];
+        }
+    }
+    
+    std::pair<int, int> step{0, 0};
+    if (threat) {
+        step = threat->ascend(position);
+    } else {
+        // Иначе погоня за ближайшей достижимой добычей - без проскакивания мимо нее
+        const FlowField* target = nullptr;
+        uint32_t target_distance = FlowField::UNREACHABLE;
+        for (size_t prey : prey_of[type]) {
+            uint32_t d = flow_fields[prey].distance(position);
+            if (d < target_distance) {
+                target_distance = d;
+                target = &flow_fields[prey];
+            }
+        }
+        if (target) {
+            step = target->descend(position);
+            move_distance = static_cast<int>(std::min<uint32_t>(target_distance, static_cast<uint32_t>(move_distance)));
+        }
+    }
+    
+    if (step.first == 0 && step.second == 0) {
+        return {random_angle, move_distance};
+    }
+    return {std::atan2(static_cast<double>(step.second), static_cast<double>(step.first)), move_distance};
+}
+
+std::pair<int, int> Game::terrain_step(const Point& from, int dx, int dy) const {
+    Point target(std::clamp(from.get_x() + dx, 0, MAP_WIDTH - 1),
+                 std::clamp(from.get_y() + dy, 0, MAP_HEIGHT - 1));
+    Point reached = terrain->walk(from, target);
+    return {reached.get_x() - from.get_x(), reached.get_y() - from.get_y()};
+}
+
+void Game::compact_if_needed() {
+    ++ticks_since_compaction;
+    if (kills_since_compaction == 0) {
+        return;
+    }
+    
+    bool many_dead = kills_since_compaction * COMPACTION_DEAD_RATIO >= npcs.size();
+    if (many_dead || ticks_since_compaction >= COMPACTION_INTERVAL_TICKS) {
+        npcs.compact();
+        kills_since_compaction = 0;
+        ticks_since_compaction = 0;
+    }
+}
+
+void Game::reorder_if_scattered() {
+    // Спуск - пара соседей по хранилищу, идущая против Z-порядка. Решение
+    // зависит только от текущих положений и порядка, поэтому прогон,
+    // продолженный с контрольной точки, переставляет хранилище так же
+    locality_keys.resize(npcs.size());
+    size_t descents = 0;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPC* npc = npcs.at(i);
+        locality_keys[i] = npc ? morton_key(npc->get_position()) : 0;
+        if (i > 0 && locality_keys[i] < locality_keys[i - 1]) {
+            ++descents;
+        }
+    }
+
+    if (descents * REORDER_DESCENT_RATIO > npcs.size()) {
+        npcs.sort_active(locality_keys);
+        ++reorders;
+    }
+}
+
+NPCHandle Game::spawn(const std::string& type, const std::string& name, const Point& position) {
+    int type_index = kill_matrix.type_index(type);
+    if (type_index < 0) {
+        throw std::invalid_argument("Неизвестный тип NPC: " + type);
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    if (terrain && !terrain->is_passable(position)) {
+        throw std::invalid_argument("Клетка непроходима для NPC: " + name);
+    }
+    
+    NPCHandle handle = npcs.recycle(static_cast<uint8_t>(type_index), name, position);
+    if (handle.is_null()) {
+        NPCArena::Scope heap_scope(npc_heap.get());
+        handle = npcs.insert(factory->create(type, name, position), static_cast<uint8_t>(type_index));
+    }
+    remember_name(handle, name);
+    contacts.update(handle.index, position, kill_matrix.kill_distance(type_index));
+    contacts.refresh();
+    if (level_of_detail) {
+        // Новичок может оказаться рядом со спокойными NPC: периоды соседей
+        // в радиусе угрозы выбираются заново на следующем тике
+        contacts.for_each_near(position, lod_radius(static_cast<size_t>(type_index)), [&](uint32_t slot) {
+            if (slot < lod_due.size()) lod_due[slot] = 0;
+        });
+    }
+    alive_counters.on_spawn(static_cast<size_t>(type_index));
+    publish_snapshot();
+    return handle;
+}
+
+void Game::detect_battles() {
+    std::vector<BattleTask> found;
+    uint64_t candidates = 0;
+    uint64_t impossible = 0;
+
+    {
+        std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+
+        // Кандидаты - только пары из списка контактов, поддерживаемого между тиками
+        if (type_buckets) {
+            collect_battles_bucketed(found, candidates, impossible);
+        } else {
+            contacts.for_each_contact([&](uint32_t a_slot, uint32_t b_slot) {
+                NPCHandle ha = npcs.handle_of_slot(a_slot);
+                NPCHandle hb = npcs.handle_of_slot(b_slot);
+                NPC* a = npcs.get(ha);
+                NPC* b = npcs.get(hb);
+                if (!a || !a->is_alive() || !b || !b->is_alive()) return;
+
+                size_t ta = npcs.type_of(ha);
+                size_t tb = npcs.type_of(hb);
+                Point pa = a->get_position();
+                Point pb = b->get_position();
+
+                // a -> b
+                if (pa.within(pb, a->get_kill_distance())) {
+                    ++candidates;
+                    if (kill_matrix.can_kill(ta, tb) && in_sight(pa, pb)) {
+                        found.emplace_back(ha, hb, pb);
+                    } else {
+                        ++impossible;
                     }
+                }
 
-                    // b -> a
-                    if (dist <= b->get_kill_distance()) {
-                        std::lock_guard<std::mutex> ql(battle_queue_mutex);
-                        battle_queue.push({b, a});
+                // b -> a
+                if (pb.within(pa, b->get_kill_distance())) {
+                    ++candidates;
+                    if (kill_matrix.can_kill(tb, ta) && in_sight(pb, pa)) {
+                        found.emplace_back(hb, ha, pa);
+                    } else {
+                        ++impossible;
                     }
                 }
-            }
+            });
         }
+    }
+
+    // Порядок задач не зависит от истории сетки контактов:
+    // прогон, продолженный с контрольной точки, разрешает бои в том же порядке
+    std::sort(found.begin(), found.end(), [](const BattleTask& a, const BattleTask& b) {
+        return a.pair_key() < b.pair_key();
+    });
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    uint64_t duplicates = 0;
+    uint64_t pushed = 0;
+
+    // Одна блокировка и одно пробуждение на весь тик
+    if (!found.empty()) {
+        std::lock_guard<std::mutex> ql(battle_queue_mutex);
+        for (auto& task : found) {
+            // Пара, ожидающая разрешения с прошлого тика, не ставится повторно
+            if (!pending_pairs.insert(task.pair_key()).second) {
+                ++duplicates;
+                continue;
+            }
+            battle_queue.push(std::move(task));
+            ++pushed;
+        }
     }
 
-    {
-        std::lock_guard<std::mutex> lg(cout_mutex);
-        std::cout << "[MOVE] movement_worker STOPPED\n";
+    filter_candidates.fetch_add(candidates, std::memory_order_relaxed);
+    filter_impossible.fetch_add(impossible, std::memory_order_relaxed);
+    filter_duplicates.fetch_add(duplicates, std::memory_order_relaxed);
+    filter_pushed.fetch_add(pushed, std::memory_order_relaxed);
+
+    if (pushed > 0) {
+        battle_queue_cv.notify_one();
     }
 }
 
+void Game::collect_battles_bucketed(std::vector<BattleTask>& found, uint64_t& candidates, uint64_t& impossible) {
+    constexpr size_t K = NPC_TYPE_COUNT;
+    for (auto& bucket : contact_buckets) bucket.clear();
+
+    // Контакты раскладываются по корзинам неупорядоченных пар типов (I <= J)
+    contacts.for_each_contact([&](uint32_t a_slot, uint32_t b_slot) {
+        NPCHandle ha = npcs.handle_of_slot(a_slot);
+        NPCHandle hb = npcs.handle_of_slot(b_slot);
+        if (ha.is_null() || hb.is_null()) return;
+        size_t va = static_cast<size_t>(variant_of_type[npcs.type_of(ha)]);
+        size_t vb = static_cast<size_t>(variant_of_type[npcs.type_of(hb)]);
+        if (va > vb) {
+            std::swap(va, vb);
+            std::swap(ha, hb);
+        }
+        contact_buckets[va * K + vb].emplace_back(ha, hb);
+    });
+
+    // Ядро на каждую пару типов, где возможно убийство; остальные корзины не читаются
+    for_each_hostile_type_pair([&](auto i, auto j) {
+        using A = NPCTypeAt<decltype(i)::value>;
+        using B = NPCTypeAt<decltype(j)::value>;
+        for (const auto& [ha, hb] : contact_buckets[decltype(i)::value * K + decltype(j)::value]) {
+            A* a = static_cast<A*>(npcs.get(ha));
+            B* b = static_cast<B*>(npcs.get(hb));
+            if (!a || !a->is_alive() || !b || !b->is_alive()) continue;
+
+            Point pa = a->get_position();
+            Point pb = b->get_position();
+            if constexpr (kills_v<A, B>) {
+                if (pa.within(pb, A::KILL_DISTANCE)) {
+                    ++candidates;
+                    if (in_sight(pa, pb)) {
+                        found.emplace_back(ha, hb, pb);
+                    } else {
+                        ++impossible;
+                    }
+                }
+            }
+            if constexpr (kills_v<B, A>) {
+                if (pb.within(pa, B::KILL_DISTANCE)) {
+                    ++candidates;
+                    if (in_sight(pb, pa)) {
+                        found.emplace_back(hb, ha, pa);
+                    } else {
+                        ++impossible;
+                    }
+                }
+            }
+        }
+    });
+}
+
+size_t Game::storage_size() const {
+    std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+    return npcs.size();
+}
+
+size_t Game::retained_size() const {
+    std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+    return npcs.retained();
+}
+
+size_t Game::locality_reorders() const {
+    std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+    return reorders;
+}
+
+PairFilterStats Game::pair_filter_stats() const {
+    PairFilterStats stats;
+    stats.candidates = filter_candidates.load(std::memory_order_relaxed);
+    stats.impossible = filter_impossible.load(std::memory_order_relaxed);
+    stats.duplicates = filter_duplicates.load(std::memory_order_relaxed);
+    stats.pushed = filter_pushed.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void Game::battle_worker() {
-    while (running || !battle_queue.empty()) {
-        std::optional<BattleTask> task;
-        
-        // Получаем задачу из очереди
+    place_current_thread(placement.battle_node, "боев");
+    std::vector<BattleEvent> events;
+
+    while (true) {
         {
-            std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
-            if (!battle_queue.empty()) {
-                task = battle_queue.front();
-                battle_queue.pop();
+            std::unique_lock<std::mutex> queue_lock(battle_queue_mutex);
+            battle_queue_cv.wait(queue_lock, [this]() {
+                return !running || !battle_queue.empty();
+            });
+            if (battle_queue.empty()) {
+                break; // остановка и очередь разобрана
             }
+            // Забираем всю очередь разом; задачи остаются видны публикации
+            take_battle_queue();
         }
-        
-        if (task.has_value()) {
-            // Проверяем, что оба NPC еще живы
+
+        while (true) {
+            std::optional<BattleTask> task;
             {
-                if (task->attacker->is_alive() && task->target->is_alive()) {
-                    process_battle(task->attacker, task->target);
+                std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+                if (battle_batch.empty()) {
+                    break;
                 }
+                task = battle_batch.front();
+            }
+            if (auto event = process_battle(*task)) {
+                events.push_back(std::move(*event));
             }
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+
+        // Весь разобранный пакет - одной публикацией снимка и событий
+        publish_world();
+        event_manager.publish_batch(events);
+        events.clear();
     }
 }
 
-void Game::process_battle(NPC* attacker, NPC* target) {
-    // Проверяем, может ли attacker убить target
-    auto kill_result = attacker->vs(*target);
-    if (!kill_result.has_value()) {
-        return; // Не может убить
+void Game::take_battle_queue() {
+    for (; !battle_queue.empty(); battle_queue.pop()) {
+        battle_batch.push_back(std::move(battle_queue.front()));
     }
+    pending_pairs.clear();
+}
+
+void Game::finish_battle() {
+    std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+    battle_batch.pop_front();
+}
+
+bool Game::resolve_next_battle() {
+    std::optional<BattleTask> task;
     
-    // Каждый NPC "кидает 6-гранный кубик" для атаки и защиты
-    int attack_power = roll_dice();
-    int defense_power = roll_dice();
+    // Получаем задачу из очереди
+    {
+        std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+        if (battle_batch.empty()) {
+            if (battle_queue.empty()) {
+                return false;
+            }
+            take_battle_queue();
+        }
+        task = battle_batch.front();
+    }
     
-    // Если сила атаки больше силы защиты - происходит убийство
-    if (attack_power > defense_power) {
+    if (auto event = process_battle(*task)) {
+        event_manager.publish(*event);
+    }
+    return true;
+}
+
+void Game::step() {
+    move_npcs();
+    detect_battles();
+    while (resolve_next_battle()) {
+    }
+    publish_world();
+}
+
+void Game::run_headless(int ticks) {
+    for (int i = 0; i < ticks; ++i) {
+        step();
+    }
+}
+
+std::optional<BattleEvent> Game::process_battle(const BattleTask& task) {
+    std::optional<std::string> kill_result;
+    std::string attacker_name;
+    std::string target_name;
+    
+    BattleEvent event;
+    event.location = task.location;
+    event.enqueued_at = task.enqueued_at;
+    event.population = &alive_counters;
+    
+    {
+        std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
+        NPC* attacker = npcs.get(task.attacker);
+        NPC* target = npcs.get(task.target);
+        
+        // Устаревший дескриптор или уже погибший участник - задача отбрасывается
+        if (!attacker || !target || !attacker->is_alive() || !target->is_alive()) {
+            read_lock.unlock();
+            finish_battle();
+            return std::nullopt;
+        }
+        
+        // Проверяем, может ли attacker убить target
+        kill_result = attacker->vs(*target);
+        if (!kill_result.has_value()) {
+            read_lock.unlock();
+            finish_battle();
+            return std::nullopt; // Не может убить
+        }
+        
+        event.attacker_type = attacker->get_type();
+        event.target_type = target->get_type();
+        if (!quiet) {
+            attacker_name = attacker->get_name();
+            target_name = target->get_name();
+        }
+    }
+    
+    event.action = kill_result.value();
+    event.tick = tick_count.load(std::memory_order_relaxed);
+    
+    // Броски, убийство и снятие задачи с пакета - под одной эксклюзивной
+    // блокировкой: публикация не застанет бой с брошенными кубиками без итога
+    int attack_power = 0;
+    int defense_power = 0;
+    {
         std::unique_lock<std::shared_mutex> write_lock(npcs_mutex);
-        if (target->is_alive()) { // Проверяем еще раз
+        NPC* attacker = npcs.get(task.attacker);
+        NPC* target = npcs.get(task.target);
+        if (!attacker || !target || !attacker->is_alive() || !target->is_alive()) {
+            finish_battle(); // участник погиб между проверкой и боем
+            return std::nullopt;
+        }
+        
+        // Каждый NPC "кидает 6-гранный кубик" для атаки и защиты
+        attack_power = roll_dice();
+        defense_power = roll_dice();
+        
+        // Если сила атаки больше силы защиты - происходит убийство
+        if (attack_power > defense_power) {
             target->kill();
-            
-            // Выводим информацию о бое
-            {
-                std::lock_guard<std::mutex> cout_lock(cout_mutex);
-                std::cout << kill_result.value() 
-                          << " [Атака: " << attack_power 
-                          << " > Защита: " << defense_power << "]\n";
-            }
+            contacts.remove(task.target.index);
+            behaviors.cancel(task.target.index);
+            alive_counters.on_death(npcs.type_of(task.target));
+            ++kills_since_compaction;
+            event.killed = true;
         }
-    } else {
+        finish_battle();
+    }
+    event.attack_roll = attack_power;
+    event.defense_roll = defense_power;
+    
+    // Выводим информацию о бое
+    if (!quiet) {
         std::lock_guard<std::mutex> cout_lock(cout_mutex);
-        std::cout << attacker->get_name() << " атаковал " << target->get_name()
-                  << " но защита была сильнее! [Атака: " << attack_power 
-                  << " <= Защита: " << defense_power << "]\n";
+        if (event.killed) {
+            std::cout << kill_result.value() 
+                      << " [Атака: " << attack_power 
+                      << " > Защита: " << defense_power << "]\n";
+        } else {
+            std::cout << attacker_name << " атаковал " << target_name
+                      << " но защита была сильнее! [Атака: " << attack_power 
+                      << " <= Защита: " << defense_power << "]\n";
+        }
     }
+    
+    // Наблюдатели получают событие у вызывающего, вне npcs_mutex и cout_mutex
+    return event;
+}
+
+void Game::subscribe(Observer* observer) {
+    event_manager.subscribe(observer);
 }
 
 int Game::roll_dice() const {
@@ -203,17 +983,304 @@ int Game::roll_dice() const {
     return dice(battle_rng);
 }
 
+void Game::set_timing(std::chrono::milliseconds tick, std::chrono::milliseconds duration) {
+    tick_interval = tick;
+    game_duration = duration;
+}
+
+void Game::set_type_buckets(bool enabled) {
+    if (enabled) {
+        auto types = factory->get_types();
+        for (size_t t = 0; t < types.size(); ++t) {
+            if (variant_of_type[t] < 0) {
+                throw std::runtime_error("Тип NPC вне закрытого набора NPCVariant: " + types[t]);
+            }
+        }
+    }
+    type_buckets = enabled;
+}
+
+void Game::set_terrain(TerrainMap map) {
+    if (map.width() != MAP_WIDTH || map.height() != MAP_HEIGHT) {
+        throw std::invalid_argument("Размеры рельефа не совпадают с картой игры");
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    // Сначала все переносы (nearest_passable бросает на карте без проходимых
+    // клеток), затем изменения - при исключении игра остается прежней
+    std::vector<std::pair<size_t, Point>> moves;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPC* npc = npcs.at(i);
+        if (!npc || !npc->is_alive() || map.is_passable(npc->get_position())) continue;
+        moves.emplace_back(i, map.nearest_passable(npc->get_position()));
+    }
+    
+    terrain = std::make_unique<TerrainMap>(std::move(map));
+    for (const auto& [i, to] : moves) {
+        NPC* npc = npcs.at(i);
+        Point from = npc->get_position();
+        npc->move(to.get_x() - from.get_x(), to.get_y() - from.get_y(), MAP_WIDTH, MAP_HEIGHT);
+        contacts.update(npcs.handle_at(i).index, to, kill_matrix.kill_distance(npcs.type_at(i)));
+    }
+    contacts.refresh();
+    reset_level_of_detail();
+    publish_snapshot();
+}
+
+void Game::set_flow_movement(bool enabled, int every_ticks) {
+    if (every_ticks < 1) {
+        throw std::invalid_argument("Интервал пересчета полей направлений должен быть положительным");
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    size_t types = kill_matrix.type_count();
+    flow_fields.assign(types, FlowField(MAP_WIDTH, MAP_HEIGHT));
+    prey_of.assign(types, {});
+    predators_of.assign(types, {});
+    for (size_t attacker = 0; attacker < types; ++attacker) {
+        for (size_t target = 0; target < types; ++target) {
+            if (kill_matrix.can_kill(attacker, target)) {
+                prey_of[attacker].push_back(target);
+                predators_of[target].push_back(attacker);
+            }
+        }
+    }
+    flow_movement = enabled;
+    flow_interval = every_ticks;
+    flow_fields_built = false;
+}
+
+void Game::set_checkpointing(const std::string& filename, uint64_t every_ticks) {
+    checkpoint_path = filename;
+    checkpoint_interval = every_ticks;
+}
+
+GameCheckpoint Game::capture_checkpoint() const {
+    GameCheckpoint checkpoint;
+    for (size_t type = 0; type < kill_matrix.type_count(); ++type) {
+        checkpoint.types.push_back(kill_matrix.type_name(type));
+    }
+    
+    // Снимок и состояние одной публикации; симуляция не останавливается
+    std::shared_ptr<const PublishedState> published;
+    {
+        std::lock_guard<std::mutex> publish_lock(publish_mutex);
+        published = front_state;
+    }
+    const WorldSnapshot& world = *published->world;
+    
+    checkpoint.tick = world.tick;
+    std::ostringstream movement, battle, init;
+    movement << published->movement_rng;
+    battle << published->battle_rng;
+    init << published->init_rng;
+    checkpoint.movement_rng = movement.str();
+    checkpoint.battle_rng = battle.str();
+    checkpoint.init_rng = init.str();
+    
+    checkpoint.kills_since_compaction = published->kills_since_compaction;
+    checkpoint.ticks_since_compaction = published->ticks_since_compaction;
+    checkpoint.filter_candidates = published->filter.candidates;
+    checkpoint.filter_impossible = published->filter.impossible;
+    checkpoint.filter_duplicates = published->filter.duplicates;
+    checkpoint.filter_pushed = published->filter.pushed;
+    
+    // Занятые слоты - дескрипторы снимка, остальные - свободные
+    checkpoint.slot_generations.assign(published->slot_capacity, 0);
+    for (const auto& npc : world.npcs) {
+        checkpoint.slot_generations[npc.handle.index] = npc.handle.generation;
+    }
+    for (size_t i = 0; i < published->free_slots.size(); ++i) {
+        checkpoint.slot_generations[published->free_slots[i]] = published->free_generations[i];
+    }
+    checkpoint.free_slots = published->free_slots;
+    checkpoint.active_count = world.npcs.size();
+    
+    // Активная область, за ней - сохраненные объекты погибших по типам
+    // (имя и позиция заменяются при оживлении и не сохраняются)
+    checkpoint.npcs.resize(world.npcs.size());
+    for (size_t dense = 0; dense < world.npcs.size(); ++dense) {
+        const NPCState& npc = world.npcs[dense];
+        auto& record = checkpoint.npcs[dense];
+        record.handle = npc.handle;
+        record.type = npc.type;
+        record.name = WorldSnapshot::name_of(npc);
+        record.position = npc.position;
+        record.alive = npc.alive;
+    }
+    for (size_t type = 0; type < published->retained.size(); ++type) {
+        for (size_t i = 0; i < published->retained[type]; ++i) {
+            auto& record = checkpoint.npcs.emplace_back();
+            record.type = static_cast<uint8_t>(type);
+        }
+    }
+    
+    // Позиции последнего пересчета полей направлений (пусто - полей еще нет)
+    if (published->flow_sources) {
+        checkpoint.flow_sources = *published->flow_sources;
+    }
+    
+    // Периоды уровня детализации по всем слотам (пусто - еще не выбирались)
+    if (!published->lod_due.empty()) {
+        checkpoint.lod_due = published->lod_due;
+        checkpoint.lod_period = published->lod_period;
+        checkpoint.lod_due.resize(checkpoint.slot_generations.size(), 0);
+        checkpoint.lod_period.resize(checkpoint.slot_generations.size(), 1);
+    }
+    
+    for (const auto& task : published->pending) {
+        checkpoint.pending.push_back({task.attacker, task.target, task.location});
+    }
+    
+    return checkpoint;
+}
+
+void Game::save_checkpoint(const std::string& filename) const {
+    capture_checkpoint().save(filename);
+}
+
+void Game::load_checkpoint(const std::string& filename) {
+    restore_checkpoint(GameCheckpoint::load(filename));
+}
+
+void Game::restore_checkpoint(const GameCheckpoint& checkpoint) {
+    // Типы точки сопоставляются с типами фабрики по имени
+    std::vector<uint8_t> type_map;
+    for (const auto& name : checkpoint.types) {
+        int index = kill_matrix.type_index(name);
+        if (index < 0) {
+            throw std::runtime_error("Контрольная точка: неизвестный тип NPC " + name);
+        }
+        type_map.push_back(static_cast<uint8_t>(index));
+    }
+    for (uint8_t period : checkpoint.lod_period) {
+        if (period > LOD_MAX_PERIOD) {
+            throw std::runtime_error("Контрольная точка: период обновления больше LOD_MAX_PERIOD");
+        }
+    }
+    
+    std::vector<std::unique_ptr<NPC>> dense_npcs;
+    std::vector<NPCHandle> dense_handles;
+    std::vector<uint8_t> dense_types;
+    NPCArena::Scope heap_scope(npc_heap.get());
+    for (const auto& record : checkpoint.npcs) {
+        uint8_t type = type_map[record.type];
+        auto npc = factory->create(kill_matrix.type_name(type), record.name, record.position);
+        if (!record.alive) {
+            npc->kill();
+        }
+        dense_npcs.push_back(std::move(npc));
+        dense_handles.push_back(record.handle);
+        dense_types.push_back(type);
+    }
+    
+    std::default_random_engine movement, battle, init;
+    std::istringstream movement_state(checkpoint.movement_rng);
+    std::istringstream battle_state(checkpoint.battle_rng);
+    std::istringstream init_state(checkpoint.init_rng);
+    if (!(movement_state >> movement) || !(battle_state >> battle) || !(init_state >> init)) {
+        throw std::runtime_error("Контрольная точка: неверное состояние генератора");
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    
+    // Кадры сценариев ссылаются на заменяемые объекты NPC
+    behaviors.clear();
+    
+    try {
+        npcs.restore(std::move(dense_npcs), std::move(dense_handles), std::move(dense_types),
+                     checkpoint.active_count, checkpoint.slot_generations, checkpoint.free_slots);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Контрольная точка: ") + e.what());
+    }
+    
+    // Контакты и счетчики численности - производное состояние, строятся заново по живым
+    contacts = ContactTracker(MAP_WIDTH, MAP_HEIGHT, kill_matrix.max_kill_distance());
+    alive_counters.reset();
+    slot_names.assign(npcs.slot_capacity(), nullptr);
+    for (size_t dense = 0; dense < npcs.size(); ++dense) {
+        const NPC* npc = npcs.at(dense);
+        remember_name(npcs.handle_at(dense), npc->get_name());
+        if (npc->is_alive()) {
+            contacts.update(npcs.handle_at(dense).index, npc->get_position(),
+                            kill_matrix.kill_distance(npcs.type_at(dense)));
+            alive_counters.on_spawn(npcs.type_at(dense));
+        }
+    }
+    contacts.refresh();
+    
+    movement_rng = movement;
+    battle_rng = battle;
+    init_rng = init;
+    
+    kills_since_compaction = static_cast<size_t>(checkpoint.kills_since_compaction);
+    ticks_since_compaction = static_cast<int>(checkpoint.ticks_since_compaction);
+    filter_candidates = checkpoint.filter_candidates;
+    filter_impossible = checkpoint.filter_impossible;
+    filter_duplicates = checkpoint.filter_duplicates;
+    filter_pushed = checkpoint.filter_pushed;
+    
+    {
+        std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+        battle_queue = std::queue<BattleTask>();
+        battle_batch.clear();
+        pending_pairs.clear();
+        for (const auto& task : checkpoint.pending) {
+            BattleTask restored(task.attacker, task.target, task.location);
+            if (pending_pairs.insert(restored.pair_key()).second) {
+                battle_queue.push(restored);
+            }
+        }
+    }
+    
+    tick_count = checkpoint.tick;
+    // Поля строятся заново по позициям последнего пересчета из точки - как у непрерывного прогона
+    flow_sources.reset();
+    if (!checkpoint.flow_sources.empty()) {
+        auto sources = std::make_shared<std::vector<std::vector<Point>>>(kill_matrix.type_count());
+        for (size_t type = 0; type < checkpoint.flow_sources.size(); ++type) {
+            (*sources)[type_map[type]] = checkpoint.flow_sources[type];
+        }
+        flow_sources = std::move(sources);
+    }
+    flow_fields_built = false;
+    lod_due = checkpoint.lod_due; // окна спокойных NPC продолжаются, как без остановки
+    lod_period = checkpoint.lod_period;
+    publish_snapshot();
+}
+
 void Game::main_worker() {
+    place_current_thread(placement.main_node, "игры");
     auto start_time = std::chrono::steady_clock::now();
-    auto end_time = start_time + std::chrono::seconds(GAME_DURATION_SECONDS);
+    auto end_time = start_time + game_duration;
+    
+    uint64_t last_checkpoint_tick = tick_count;
     
     while (running && std::chrono::steady_clock::now() < end_time) {
-        print_map();
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        if (!quiet) {
+            print_map();
+        }
+        
+        // Кодирование и запись идут в этом потоке, симуляция не ждет
+        uint64_t tick = tick_count;
+        if (checkpoint_interval > 0 && tick - last_checkpoint_tick >= checkpoint_interval) {
+            last_checkpoint_tick = tick;
+            try {
+                save_checkpoint(checkpoint_path);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> cout_lock(cout_mutex);
+                std::cerr << "Ошибка контрольной точки: " << e.what() << "\n";
+            }
+        }
+        std::this_thread::sleep_for(std::min(tick_interval, game_duration));
     }
     
     game_over = true;
     
+    if (quiet) {
+        return;
+    }
+    
     // Финальный вывод карты и списка выживших
     print_map();
     
@@ -227,47 +1294,129 @@ void Game::main_worker() {
             std::cout << "  - " << name << "\n";
         }
         std::cout << "Всего выжило: " << survivors.size() << "\n";
+        
+        PairFilterStats filter = pair_filter_stats();
+        std::cout << "Предфильтр боев: сэкономлено " << filter.saved()
+                  << " из " << filter.candidates << " добавлений в очередь"
+                  << " (невозможных: " << filter.impossible
+                  << ", повторов: " << filter.duplicates << ")\n";
     }
 }
 
-void Game::print_map() const {
-    std::lock_guard<std::mutex> cout_lock(cout_mutex);
-    
-    // std::cout << "\033[2J\033[H";
-    std::cout << "=== КАРТА ПОДЗЕМЕЛЬЯ ===\n";
+void Game::publish_snapshot() {
+    // Всегда новый снимок: прежний могут читать без блокировок, и узнать,
+    // что последний читатель его отпустил, без эпох нельзя
+    auto next = std::make_shared<WorldSnapshot>();
+    next->tick = tick_count;
+    next->types = snapshot_types;
+    next->npcs.resize(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPCState& state = next->npcs[i];
+        const NPC* npc = npcs.at(i);
+        state.handle = npcs.handle_at(i);
+        if (!npc) {
+            continue;
+        }
+        state.name = slot_names[state.handle.index]; // строка не копируется
+        state.type = npcs.type_at(i);
+        state.position = npc->get_position();
+        state.alive = npc->is_alive();
+    }
     
-    // Подсчитываем живых NPC
-    size_t alive_count = 0;
+    // Все, чего нет в снимке, для контрольной точки того же момента
+    auto published = std::make_shared<PublishedState>();
+    published->world = std::move(next);
+    published->movement_rng = movement_rng;
+    published->battle_rng = battle_rng;
+    published->init_rng = init_rng;
+    published->kills_since_compaction = kills_since_compaction;
+    published->ticks_since_compaction = static_cast<uint64_t>(ticks_since_compaction);
+    published->filter = pair_filter_stats();
+    published->slot_capacity = npcs.slot_capacity();
+    published->free_slots = npcs.free_list();
+    for (uint32_t slot : published->free_slots) {
+        published->free_generations.push_back(npcs.slot_generation(slot));
+    }
+    for (size_t type = 0; type < kill_matrix.type_count(); ++type) {
+        published->retained.push_back(npcs.retained_of(static_cast<uint8_t>(type)));
+    }
+    published->flow_sources = flow_sources;
+    published->lod_due = lod_due;
+    published->lod_period = lod_period;
     {
-        std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
-        alive_count = std::count_if(npcs.begin(), npcs.end(),
-            [](const auto& npc) { return npc && npc->is_alive(); });
+        std::lock_guard<std::mutex> queue_lock(battle_queue_mutex);
+        published->pending.assign(battle_batch.begin(), battle_batch.end());
+        std::queue<BattleTask> queue = battle_queue;
+        for (; !queue.empty(); queue.pop()) {
+            published->pending.push_back(queue.front());
+        }
     }
     
-    std::cout << "Живых NPC: " << alive_count << "\n\n";
+    // Прежнее состояние освобождается при выходе, уже вне publish_mutex
+    std::shared_ptr<const PublishedState> previous = std::move(published);
+    std::lock_guard<std::mutex> publish_lock(publish_mutex);
+    front_state.swap(previous);
+}
+
+void Game::publish_world() {
+    std::unique_lock<std::shared_mutex> lock(npcs_mutex);
+    publish_snapshot();
+}
+
+void Game::remember_name(NPCHandle handle, const std::string& name) {
+    if (handle.index >= slot_names.size()) {
+        slot_names.resize(handle.index + 1);
+    }
+    slot_names[handle.index] = std::make_shared<const std::string>(name);
+}
+
+std::shared_ptr<const WorldSnapshot> Game::snapshot() const {
+    std::lock_guard<std::mutex> publish_lock(publish_mutex);
+    return front_state->world;
+}
+
+void Game::print_map() const {
+    auto world = snapshot();
     
-    // Создаем карту
+    // Создаем карту без каких-либо блокировок симуляции
     std::vector<std::vector<char>> map(MAP_HEIGHT, std::vector<char>(MAP_WIDTH, '.'));
-    
-    {
-        std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
-        for (const auto& npc : npcs) {
-            if (npc && npc->is_alive()) {
-                Point pos = npc->get_position();
-                if (pos.get_x() >= 0 && pos.get_x() < MAP_WIDTH &&
-                    pos.get_y() >= 0 && pos.get_y() < MAP_HEIGHT) {
-                    char symbol = '?';
-                    std::string type = npc->get_type();
-                    if (type == "Орк") symbol = 'O';
-                    else if (type == "Белка") symbol = 'S';
-                    else if (type == "Друид") symbol = 'D';
-                    
-                    map[pos.get_y()][pos.get_x()] = symbol;
-                }
+    if (terrain) {
+        for (int y = 0; y < MAP_HEIGHT; ++y) {
+            for (int x = 0; x < MAP_WIDTH; ++x) {
+                TerrainMap::Cell cell = terrain->cell(x, y);
+                if (cell == TerrainMap::Cell::WALL) map[y][x] = '#';
+                else if (cell == TerrainMap::Cell::WATER) map[y][x] = '~';
             }
         }
     }
     
+    for (const auto& npc : world->npcs) {
+        if (!npc.alive) continue;
+        
+        const Point& pos = npc.position;
+        if (pos.get_x() >= 0 && pos.get_x() < MAP_WIDTH &&
+            pos.get_y() >= 0 && pos.get_y() < MAP_HEIGHT) {
+            char symbol = '?';
+            const std::string& type = world->type_name(npc);
+            if (type == "Орк") symbol = 'O';
+            else if (type == "Белка") symbol = 'S';
+            else if (type == "Друид") symbol = 'D';
+            
+            map[pos.get_y()][pos.get_x()] = symbol;
+        }
+    }
+    
+    std::lock_guard<std::mutex> cout_lock(cout_mutex);
+    
+    // std::cout << "\033[2J\033[H";
+    std::cout << "=== КАРТА ПОДЗЕМЕЛЬЯ ===\n";
+    std::cout << "Живых NPC: " << alive_counters.alive();
+    for (size_t type = 0; type < alive_counters.types().size(); ++type) {
+        std::cout << (type ? ", " : " (") << alive_counters.types()[type] << ": "
+                  << alive_counters.alive_of(type);
+    }
+    std::cout << ")\n\n";
+    
     // Выводим карту (полная версия для лучшей видимости движения)
     // Показываем каждую клетку карты напрямую
     const int DISPLAY_WIDTH = 50;
@@ -289,13 +1438,30 @@ void Game::print_map() const {
 std::vector<std::string> Game::get_survivors() const {
     std::vector<std::string> survivors;
     
-    std::shared_lock<std::shared_mutex> read_lock(npcs_mutex);
-    for (const auto& npc : npcs) {
-        if (npc && npc->is_alive()) {
-            survivors.push_back(npc->get_name() + " (" + npc->get_type() + ")");
+    auto world = snapshot();
+    for (const auto& npc : world->npcs) {
+        if (npc.alive) {
+            survivors.push_back(*npc.name + " (" + world->type_name(npc) + ")");
         }
     }
     
     return survivors;
 }
 
+void Game::save_to_file(const std::string& filename) const {
+    std::ofstream file(filename);
+    
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+    
+    auto world = snapshot();
+    for (const auto& npc : world->npcs) {
+        if (npc.alive) {
+            file << *npc.name << " "
+                 << world->type_name(npc) << " "
+                 << npc.position.get_x() << " "
+                 << npc.position.get_y() << "\n";
+        }
+    }
+}
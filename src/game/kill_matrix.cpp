@@ -0,0 +1,70 @@
+#include "../../include/game/kill_matrix.h"
+#include "../../include/game/type_kernels.h"
+#include "../../include/npc/npc_factory.h"
+#include <algorithm>
+
+KillMatrix::KillMatrix(const NPCFactory& factory) : types(factory.get_types()) {
+    // Пробные NPC каждого типа: правила берутся из самих классов, а не дублируются
+    std::vector<std::unique_ptr<NPC>> probes;
+    probes.reserve(types.size());
+    for (const auto& type : types) {
+        probes.push_back(factory.create(type, type, Point()));
+        kill_distances.push_back(probes.back()->get_kill_distance());
+        move_distances.push_back(probes.back()->get_move_distance());
+    }
+
+    matrix.assign(types.size() * types.size(), 0);
+    for (size_t a = 0; a < types.size(); ++a) {
+        for (size_t t = 0; t < types.size(); ++t) {
+            matrix[a * types.size() + t] = probes[a]->vs(*probes[t]).has_value() ? 1 : 0;
+        }
+    }
+}
+
+const KillMatrix& KillMatrix::closed_set() {
+    static const KillMatrix matrix = [] {
+        KillMatrix result;
+        result.matrix.assign(NPC_TYPE_COUNT * NPC_TYPE_COUNT, 0);
+        for_each_npc_type([&](auto a) {
+            using A = NPCTypeAt<decltype(a)::value>;
+            result.types.emplace_back(A::TYPE_NAME);
+            result.kill_distances.push_back(A::KILL_DISTANCE);
+            result.move_distances.push_back(A::MOVE_DISTANCE);
+            for_each_npc_type([&](auto t) {
+                result.matrix[a * NPC_TYPE_COUNT + t] = kills_v<A, NPCTypeAt<decltype(t)::value>> ? 1 : 0;
+            });
+        });
+        return result;
+    }();
+    return matrix;
+}
+
+size_t KillMatrix::type_count() const {
+    return types.size();
+}
+
+int KillMatrix::type_index(const std::string& type) const {
+    auto it = std::find(types.begin(), types.end(), type);
+    return it == types.end() ? -1 : static_cast<int>(it - types.begin());
+}
+
+const std::string& KillMatrix::type_name(size_t index) const {
+    return types[index];
+}
+
+bool KillMatrix::is_predator(size_t attacker) const {
+    for (size_t t = 0; t < types.size(); ++t) {
+        if (can_kill(attacker, t)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int KillMatrix::max_kill_distance() const {
+    int result = 0;
+    for (int distance : kill_distances) {
+        result = std::max(result, distance);
+    }
+    return result;
+}
@@ -0,0 +1,285 @@
+#include "../../include/game/npc_pool.h"
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Копия вектора той же емкости, записанная вызывающим потоком
+template <typename T>
+void reallocate_here(std::vector<T>& values) {
+    std::vector<T> fresh;
+    fresh.reserve(values.capacity());
+    for (auto& value : values) {
+        fresh.push_back(std::move(value));
+    }
+    values.swap(fresh);
+}
+
+} // namespace
+
+NPCHandle NPCPool::acquire_slot(uint32_t dense) {
+    uint32_t index;
+    if (!free_slots.empty()) {
+        index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    Slot& slot = slots[index];
+    slot.dense = dense;
+    slot.occupied = true;
+    return NPCHandle{index, slot.generation};
+}
+
+void NPCPool::release_slot(NPCHandle handle) {
+    Slot& slot = slots[handle.index];
+    slot.occupied = false;
+    ++slot.generation; // старые дескрипторы больше не разрешаются
+    free_slots.push_back(handle.index);
+}
+
+NPCHandle NPCPool::push_active(std::unique_ptr<NPC> npc, uint8_t type) {
+    npcs.push_back(std::move(npc));
+    handles.push_back(NPCHandle{});
+    types.push_back(type);
+
+    size_t position = npcs.size() - 1;
+    NPCHandle handle = acquire_slot(static_cast<uint32_t>(position));
+    handles[position] = handle;
+    return handle;
+}
+
+void NPCPool::retain(std::unique_ptr<NPC> npc, uint8_t type) {
+    if (type >= retained_objects.size()) {
+        retained_objects.resize(static_cast<size_t>(type) + 1);
+    }
+    auto& objects = retained_objects[type];
+    if (objects.size() >= retained_limit) {
+        return; // объект разрушается: волна смертей не держит память навсегда
+    }
+    objects.push_back(std::move(npc));
+    ++retained_total;
+}
+
+NPCHandle NPCPool::insert(std::unique_ptr<NPC> npc, uint8_t type) {
+    return push_active(std::move(npc), type);
+}
+
+NPCHandle NPCPool::recycle(uint8_t type, const std::string& name, const Point& position) {
+    if (type >= retained_objects.size() || retained_objects[type].empty()) {
+        return NPCHandle{};
+    }
+
+    auto& objects = retained_objects[type];
+    std::unique_ptr<NPC> npc = std::move(objects.back());
+    objects.pop_back();
+    --retained_total;
+    npc->respawn(name, position);
+    return push_active(std::move(npc), type);
+}
+
+bool NPCPool::contains(NPCHandle handle) const {
+    return handle.index < slots.size() &&
+           slots[handle.index].occupied &&
+           slots[handle.index].generation == handle.generation;
+}
+
+NPCHandle NPCPool::handle_of_slot(uint32_t index) const {
+    if (index >= slots.size() || !slots[index].occupied) {
+        return NPCHandle{};
+    }
+    return NPCHandle{index, slots[index].generation};
+}
+
+NPC* NPCPool::get(NPCHandle handle) const {
+    return contains(handle) ? npcs[slots[handle.index].dense].get() : nullptr;
+}
+
+size_t NPCPool::compact() {
+    scratch_npcs.clear();
+    scratch_handles.clear();
+    scratch_types.clear();
+
+    // Живые - в исходном порядке; погибшие теряют дескрипторы и уходят в списки типов
+    size_t removed = 0;
+    for (size_t dense = 0; dense < npcs.size(); ++dense) {
+        if (npcs[dense] && npcs[dense]->is_alive()) {
+            slots[handles[dense].index].dense = static_cast<uint32_t>(scratch_npcs.size());
+            scratch_npcs.push_back(std::move(npcs[dense]));
+            scratch_handles.push_back(handles[dense]);
+            scratch_types.push_back(types[dense]);
+        } else {
+            release_slot(handles[dense]);
+            retain(std::move(npcs[dense]), types[dense]);
+            ++removed;
+        }
+    }
+
+    npcs.swap(scratch_npcs);
+    handles.swap(scratch_handles);
+    types.swap(scratch_types);
+    return removed;
+}
+
+void NPCPool::sort_active(const std::vector<uint64_t>& keys) {
+    if (keys.size() != npcs.size()) {
+        throw std::invalid_argument("Число ключей не совпадает с активной областью");
+    }
+
+    // LSD-сортировка перестановки по байтам ключа; разряд, одинаковый
+    // у всех ключей (старшие биты на маленькой карте), пропускается
+    constexpr int DIGIT_BITS = 8;
+    constexpr size_t BUCKETS = size_t{1} << DIGIT_BITS;
+    std::vector<uint32_t>& order = scratch_order;
+    std::vector<uint32_t>& next = scratch_order_swap;
+    order.resize(npcs.size());
+    next.resize(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    std::array<uint32_t, BUCKETS> counts;
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        counts.fill(0);
+        for (uint64_t key : keys) {
+            ++counts[(key >> shift) & (BUCKETS - 1)];
+        }
+        if (npcs.empty() || counts[(keys[0] >> shift) & (BUCKETS - 1)] == npcs.size()) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (auto& count : counts) {
+            uint32_t bucket = count;
+            count = offset;
+            offset += bucket;
+        }
+        for (uint32_t index : order) {
+            next[counts[(keys[index] >> shift) & (BUCKETS - 1)]++] = index;
+        }
+        order.swap(next);
+    }
+
+    // Перестановка плотных массивов
+    scratch_npcs.clear();
+    scratch_handles.clear();
+    scratch_types.clear();
+    for (uint32_t dense : order) {
+        if (!handles[dense].is_null()) {
+            slots[handles[dense].index].dense = static_cast<uint32_t>(scratch_npcs.size());
+        }
+        scratch_npcs.push_back(std::move(npcs[dense]));
+        scratch_handles.push_back(handles[dense]);
+        scratch_types.push_back(types[dense]);
+    }
+    npcs.swap(scratch_npcs);
+    handles.swap(scratch_handles);
+    types.swap(scratch_types);
+}
+
+void NPCPool::replace_objects(const std::function<std::unique_ptr<NPC>(const NPC&, uint8_t)>& copy) {
+    std::vector<std::unique_ptr<NPC>> active;
+    active.reserve(npcs.size());
+    for (size_t dense = 0; dense < npcs.size(); ++dense) {
+        active.push_back(npcs[dense] ? copy(*npcs[dense], types[dense]) : nullptr);
+    }
+    std::vector<std::vector<std::unique_ptr<NPC>>> retained(retained_objects.size());
+    for (size_t type = 0; type < retained_objects.size(); ++type) {
+        retained[type].reserve(retained_objects[type].size());
+        for (const auto& object : retained_objects[type]) {
+            retained[type].push_back(copy(*object, static_cast<uint8_t>(type)));
+        }
+    }
+    npcs.swap(active);
+    retained_objects.swap(retained);
+}
+
+void NPCPool::reallocate() {
+    reallocate_here(slots);
+    reallocate_here(free_slots);
+    reallocate_here(npcs);
+    reallocate_here(handles);
+    reallocate_here(types);
+    for (auto& objects : retained_objects) {
+        reallocate_here(objects);
+    }
+    std::vector<std::unique_ptr<NPC>>().swap(scratch_npcs);
+    std::vector<NPCHandle>().swap(scratch_handles);
+    std::vector<uint8_t>().swap(scratch_types);
+    std::vector<uint32_t>().swap(scratch_order);
+    std::vector<uint32_t>().swap(scratch_order_swap);
+}
+
+std::vector<uint32_t> NPCPool::slot_generations() const {
+    std::vector<uint32_t> result;
+    result.reserve(slots.size());
+    for (const auto& slot : slots) {
+        result.push_back(slot.generation);
+    }
+    return result;
+}
+
+void NPCPool::restore(std::vector<std::unique_ptr<NPC>> dense_npcs,
+                      std::vector<NPCHandle> dense_handles,
+                      std::vector<uint8_t> dense_types,
+                      size_t active,
+                      const std::vector<uint32_t>& generations,
+                      std::vector<uint32_t> free_list) {
+    if (dense_handles.size() != dense_npcs.size() || dense_types.size() != dense_npcs.size() ||
+        active > dense_npcs.size()) {
+        throw std::invalid_argument("Несогласованные плотные массивы хранилища");
+    }
+
+    std::vector<Slot> restored(generations.size());
+    for (size_t i = 0; i < generations.size(); ++i) {
+        restored[i].generation = generations[i];
+    }
+
+    for (size_t dense = 0; dense < dense_handles.size(); ++dense) {
+        const NPCHandle& handle = dense_handles[dense];
+        if (handle.is_null() != (dense >= active)) {
+            throw std::invalid_argument(dense < active ? "Активный NPC без дескриптора"
+                                                       : "Сохраненный погибший с дескриптором");
+        }
+        if (handle.is_null()) {
+            continue;
+        }
+        if (handle.index >= restored.size() || restored[handle.index].occupied ||
+            restored[handle.index].generation != handle.generation) {
+            throw std::invalid_argument("Несогласованный дескриптор NPC");
+        }
+        restored[handle.index].dense = static_cast<uint32_t>(dense);
+        restored[handle.index].occupied = true;
+    }
+
+    for (uint32_t index : free_list) {
+        if (index >= restored.size() || restored[index].occupied) {
+            throw std::invalid_argument("Несогласованный список свободных слотов");
+        }
+    }
+
+    // Погибшие за активной областью - в списки своих типов в том же порядке
+    std::vector<std::vector<std::unique_ptr<NPC>>> retained_restored;
+    size_t retained_count = dense_npcs.size() - active;
+    for (size_t dense = active; dense < dense_npcs.size(); ++dense) {
+        uint8_t type = dense_types[dense];
+        if (type >= retained_restored.size()) {
+            retained_restored.resize(static_cast<size_t>(type) + 1);
+        }
+        retained_restored[type].push_back(std::move(dense_npcs[dense]));
+    }
+    dense_npcs.resize(active);
+    dense_handles.resize(active);
+    dense_types.resize(active);
+
+    slots = std::move(restored);
+    free_slots = std::move(free_list);
+    npcs = std::move(dense_npcs);
+    handles = std::move(dense_handles);
+    types = std::move(dense_types);
+    retained_objects = std::move(retained_restored);
+    retained_total = retained_count;
+}
@@ -0,0 +1,115 @@
+#include "../../include/game/placement.h"
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+NumaTopology::NumaTopology(std::vector<NumaNode> nodes) : node_list(std::move(nodes)) {}
+
+NumaTopology NumaTopology::detect() {
+    std::vector<NumaNode> nodes;
+    const std::string root = "/sys/devices/system/node";
+    if (DIR* dir = opendir(root.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+                !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                continue;
+            }
+            std::ifstream list(root + "/" + name + "/cpulist");
+            std::string text;
+            std::getline(list, text);
+            NumaNode node;
+            node.id = std::stoi(name.substr(4));
+            try {
+                node.cpus = parse_cpu_list(text);
+            } catch (const std::invalid_argument&) {
+                continue;
+            }
+            if (!node.cpus.empty()) { // узлы только с памятью потокам не подходят
+                nodes.push_back(std::move(node));
+            }
+        }
+        closedir(dir);
+    }
+
+    if (nodes.empty()) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        NumaNode node;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) node.cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(std::move(node));
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return NumaTopology(std::move(nodes));
+}
+
+const NumaNode* NumaTopology::find(int id) const {
+    for (const auto& node : node_list) {
+        if (node.id == id) return &node;
+    }
+    return nullptr;
+}
+
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        size_t used = 0;
+        try {
+            int first = std::stoi(range, &used);
+            int last = first;
+            if (dash != std::string::npos) {
+                size_t used_last = 0;
+                last = std::stoi(range.substr(dash + 1), &used_last);
+                used = dash + 1 + used_last;
+            }
+            if (used != range.size() || first < 0 || last < first) {
+                throw std::invalid_argument(range);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Неверный список процессоров: " + text);
+        }
+    }
+    return cpus;
+}
+
+void pin_current_thread(const std::vector<int>& cpus) {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        throw std::runtime_error(std::string("Не удалось прочитать привязку потока: ") + std::strerror(errno));
+    }
+
+    cpu_set_t wanted;
+    CPU_ZERO(&wanted);
+    int count = 0;
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+            CPU_SET(cpu, &wanted);
+            ++count;
+        }
+    }
+    if (count == 0) {
+        throw std::runtime_error("Ни один процессор узла не доступен процессу");
+    }
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(wanted), &wanted);
+    if (error != 0) {
+        throw std::runtime_error(std::string("Не удалось привязать поток: ") + std::strerror(error));
+    }
+}
@@ -0,0 +1,265 @@
+#include "../../include/game/terrain.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+void assign_bit(std::vector<uint64_t>& layer, size_t row_offset, int x, bool value) {
+    uint64_t& word = layer[row_offset + (static_cast<size_t>(x) >> 6)];
+    uint64_t mask = uint64_t{1} << (x & 63);
+    word = value ? (word | mask) : (word & ~mask);
+}
+
+int64_t ceil_div(int64_t a, int64_t b) {
+    return a >= 0 ? (a + b - 1) / b : -((-a) / b);
+}
+
+// Отрезок a-b из заголовка TerrainMap: разбиение считается от меньшего
+// конца, cell(i) - i-я клетка в порядке a -> b (i = 0..major)
+struct Segment {
+    Point origin;
+    int sx;
+    int sy;
+    int64_t major;
+    int64_t minor;
+    bool shallow;
+    bool reversed;
+
+    Segment(const Point& a, const Point& b) {
+        int64_t dx = b.get_x() - a.get_x();
+        int64_t dy = b.get_y() - a.get_y();
+        major = std::max(std::abs(dx), std::abs(dy));
+        minor = std::min(std::abs(dx), std::abs(dy));
+        shallow = std::abs(dx) >= std::abs(dy);
+        reversed = std::make_pair(b.get_x(), b.get_y()) < std::make_pair(a.get_x(), a.get_y());
+        origin = reversed ? b : a;
+        sx = (reversed ? -dx : dx) < 0 ? -1 : 1;
+        sy = (reversed ? -dy : dy) < 0 ? -1 : 1;
+    }
+
+    Point cell(int64_t i) const {
+        int64_t t = reversed ? major - i : i;
+        int64_t k = major == 0 ? 0 : (2 * t * minor + major) / (2 * major);
+        int64_t along_x = shallow ? t : k;
+        int64_t along_y = shallow ? k : t;
+        return Point(origin.get_x() + sx * static_cast<int>(along_x),
+                     origin.get_y() + sy * static_cast<int>(along_y));
+    }
+};
+
+} // namespace
+
+TerrainMap::TerrainMap(int width, int height)
+    : map_width(width), map_height(height) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Размеры карты рельефа должны быть положительными");
+    }
+    words_per_row = (static_cast<size_t>(width) + 63) / 64;
+    walls.assign(words_per_row * static_cast<size_t>(height), 0);
+}
+
+void TerrainMap::set(int x, int y, Cell cell) {
+    if (!in_bounds(x, y)) {
+        throw std::out_of_range("Клетка вне карты рельефа");
+    }
+    if (cell == Cell::WATER && water.empty()) {
+        water.assign(walls.size(), 0);
+    }
+    size_t row = static_cast<size_t>(y) * words_per_row;
+    assign_bit(walls, row, x, cell == Cell::WALL);
+    if (!water.empty()) {
+        assign_bit(water, row, x, cell == Cell::WATER);
+    }
+}
+
+void TerrainMap::fill_rect(int x0, int y0, int x1, int y1, Cell cell) {
+    for (int y = std::max(0, y0); y <= std::min(y1, map_height - 1); ++y) {
+        for (int x = std::max(0, x0); x <= std::min(x1, map_width - 1); ++x) {
+            set(x, y, cell);
+        }
+    }
+}
+
+TerrainMap::Cell TerrainMap::cell(int x, int y) const {
+    if (!in_bounds(x, y) || is_wall(x, y)) {
+        return Cell::WALL;
+    }
+    if (!water.empty() && test(water, static_cast<size_t>(y) * words_per_row, x)) {
+        return Cell::WATER;
+    }
+    return Cell::FLOOR;
+}
+
+bool TerrainMap::is_blocked(int x, int y) const {
+    size_t row = static_cast<size_t>(y) * words_per_row;
+    return test(walls, row, x) || (!water.empty() && test(water, row, x));
+}
+
+bool TerrainMap::is_passable(const Point& p) const {
+    return in_bounds(p.get_x(), p.get_y()) && !is_blocked(p.get_x(), p.get_y());
+}
+
+bool TerrainMap::any_wall_in_row(int y, int x0, int x1) const {
+    const uint64_t* row = walls.data() + static_cast<size_t>(y) * words_per_row;
+    size_t w0 = static_cast<size_t>(x0) >> 6;
+    size_t w1 = static_cast<size_t>(x1) >> 6;
+    uint64_t first = ~uint64_t{0} << (x0 & 63);
+    uint64_t last = ~uint64_t{0} >> (63 - (x1 & 63));
+    if (w0 == w1) {
+        return (row[w0] & first & last) != 0;
+    }
+    // Середина - свертка слов через OR без ветвлений (векторизуется компилятором)
+    uint64_t found = (row[w0] & first) | (row[w1] & last);
+    for (size_t w = w0 + 1; w < w1; ++w) {
+        found |= row[w];
+    }
+    return found != 0;
+}
+
+bool TerrainMap::line_of_sight(const Point& a, const Point& b) const {
+    if (!in_bounds(a.get_x(), a.get_y()) || !in_bounds(b.get_x(), b.get_y())) {
+        return false;
+    }
+    // Упорядоченные концы: один и тот же отрезок в обе стороны
+    Point from = a;
+    Point to = b;
+    if (std::make_pair(to.get_x(), to.get_y()) < std::make_pair(from.get_x(), from.get_y())) {
+        std::swap(from, to);
+    }
+
+    int64_t dx = to.get_x() - from.get_x();
+    int64_t dy = to.get_y() - from.get_y();
+    int64_t adx = std::abs(dx);
+    int64_t ady = std::abs(dy);
+    int sx = dx < 0 ? -1 : 1;
+    int sy = dy < 0 ? -1 : 1;
+
+    if (adx >= ady) {
+        // Пологий отрезок: в каждой строке k - непрерывный отрезок t0..t1
+        for (int64_t k = 0; k <= ady; ++k) {
+            int64_t t0 = k == 0 ? 0 : ceil_div((2 * k - 1) * adx, 2 * ady);
+            int64_t t1 = k == ady ? adx : std::min(adx, ceil_div((2 * k + 1) * adx, 2 * ady) - 1);
+            int xa = from.get_x() + sx * static_cast<int>(t0);
+            int xb = from.get_x() + sx * static_cast<int>(t1);
+            if (any_wall_in_row(from.get_y() + sy * static_cast<int>(k), std::min(xa, xb), std::max(xa, xb))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Крутой отрезок: по одной клетке на строку
+    for (int64_t t = 0; t <= ady; ++t) {
+        int64_t k = (2 * t * adx + ady) / (2 * ady);
+        if (is_wall(from.get_x() + sx * static_cast<int>(k), from.get_y() + sy * static_cast<int>(t))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Point> TerrainMap::line_cells(const Point& a, const Point& b) const {
+    Segment segment(a, b);
+    std::vector<Point> cells;
+    cells.reserve(static_cast<size_t>(segment.major) + 1);
+    for (int64_t i = 0; i <= segment.major; ++i) {
+        cells.push_back(segment.cell(i));
+    }
+    return cells;
+}
+
+Point TerrainMap::walk(const Point& from, const Point& to) const {
+    Point reached = from;
+    if (!is_passable(from)) {
+        return reached;
+    }
+    // Клетки считаются на ходу: шаг NPC не выделяет память
+    Segment segment(from, to);
+    for (int64_t i = 1; i <= segment.major; ++i) {
+        Point next = segment.cell(i);
+        if (!is_passable(next)) {
+            break;
+        }
+        reached = next;
+    }
+    return reached;
+}
+
+Point TerrainMap::nearest_passable(const Point& p) const {
+    int cx = std::clamp(p.get_x(), 0, map_width - 1);
+    int cy = std::clamp(p.get_y(), 0, map_height - 1);
+    int max_radius = std::max(map_width, map_height);
+    for (int r = 0; r <= max_radius; ++r) {
+        for (int y = cy - r; y <= cy + r; ++y) {
+            bool edge_row = y == cy - r || y == cy + r;
+            for (int x = cx - r; x <= cx + r; x += (edge_row || r == 0) ? 1 : 2 * r) {
+                if (in_bounds(x, y) && !is_blocked(x, y)) {
+                    return Point(x, y);
+                }
+            }
+        }
+    }
+    throw std::runtime_error("На карте рельефа нет проходимых клеток");
+}
+
+size_t TerrainMap::memory_bytes() const {
+    return (walls.capacity() + water.capacity()) * sizeof(uint64_t);
+}
+
+void TerrainMap::save(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+    file << map_width << " " << map_height << "\n";
+    std::string line(static_cast<size_t>(map_width), '.');
+    for (int y = 0; y < map_height; ++y) {
+        for (int x = 0; x < map_width; ++x) {
+            Cell c = cell(x, y);
+            line[static_cast<size_t>(x)] = c == Cell::WALL ? '#' : c == Cell::WATER ? '~' : '.';
+        }
+        file << line << "\n";
+    }
+}
+
+TerrainMap TerrainMap::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл рельефа: " + filename);
+    }
+    int width = 0;
+    int height = 0;
+    if (!(file >> width >> height) || width <= 0 || height <= 0) {
+        throw std::runtime_error("Неверный заголовок файла рельефа: " + filename);
+    }
+    // Остаток строки заголовка (в том числе "\r\n") - только пробелы
+    std::string line;
+    std::getline(file, line);
+    if (line.find_first_not_of(" \t\r") != std::string::npos) {
+        throw std::runtime_error("Неверный заголовок файла рельефа: " + filename);
+    }
+
+    TerrainMap map(width, height);
+    for (int y = 0; y < height; ++y) {
+        if (!std::getline(file, line)) {
+            throw std::runtime_error("Файл рельефа обрывается на строке " + std::to_string(y + 1));
+        }
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.size() != static_cast<size_t>(width)) {
+            throw std::runtime_error("Неверная длина строки рельефа " + std::to_string(y + 1));
+        }
+        for (int x = 0; x < width; ++x) {
+            switch (line[static_cast<size_t>(x)]) {
+                case '.': break;
+                case '#': map.set(x, y, Cell::WALL); break;
+                case '~': map.set(x, y, Cell::WATER); break;
+                default:
+                    throw std::runtime_error("Неизвестная клетка рельефа в строке " + std::to_string(y + 1));
+            }
+        }
+    }
+    return map;
+}
@@ -0,0 +1,21 @@
+#include "../../include/game/world_snapshot.h"
+#include <algorithm>
+
+namespace {
+
+const std::string EMPTY;
+
+} // namespace
+
+size_t WorldSnapshot::alive_count() const {
+    return std::count_if(npcs.begin(), npcs.end(),
+        [](const NPCState& state) { return state.alive; });
+}
+
+const std::string& WorldSnapshot::type_name(const NPCState& state) const {
+    return types && state.type < types->size() ? (*types)[state.type] : EMPTY;
+}
+
+const std::string& WorldSnapshot::name_of(const NPCState& state) {
+    return state.name ? *state.name : EMPTY;
+}
@@ -0,0 +1,208 @@
+#include "../../include/io/block_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#ifdef LAB6_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 14;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash4(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void put_length(std::vector<uint8_t>& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void emit_sequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_count,
+                   size_t offset, size_t match_length) {
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>((std::min<size_t>(literal_count, 15) << 4) |
+                                         std::min<size_t>(match_code, 15));
+    out.push_back(token);
+    if (literal_count >= 15) put_length(out, literal_count - 15);
+    out.insert(out.end(), literals, literals + literal_count);
+
+    if (match_length == 0) {
+        return; // завершающие литералы
+    }
+    out.push_back(static_cast<uint8_t>(offset));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+    if (match_code >= 15) put_length(out, match_code - 15);
+}
+
+void lz_compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, UINT32_MAX);
+    size_t anchor = 0;
+    size_t i = 0;
+
+    while (i + MIN_MATCH <= size) {
+        uint32_t sequence = read32(src + i);
+        uint32_t& slot = table[hash4(sequence)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(i);
+
+        if (candidate == UINT32_MAX || i - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+            ++i;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < size && src[candidate + length] == src[i + length]) {
+            ++length;
+        }
+        emit_sequence(out, src + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+    emit_sequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+[[noreturn]] void corrupted(const char* what) {
+    throw std::runtime_error(std::string("Поврежденный блок: ") + what);
+}
+
+void lz_decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+    size_t in = 0;
+    size_t out = 0;
+
+    auto read_length = [&](size_t length) {
+        if (length != 15) return length;
+        uint8_t byte;
+        do {
+            if (in >= size) corrupted("обрыв длины");
+            byte = src[in++];
+            length += byte;
+        } while (byte == 255);
+        return length;
+    };
+
+    while (true) {
+        if (in >= size) corrupted("нет токена");
+        uint8_t token = src[in++];
+
+        size_t literals = read_length(token >> 4);
+        if (literals > size - in || literals > raw_size - out) corrupted("литералы за границей");
+        std::memcpy(dst + out, src + in, literals);
+        in += literals;
+        out += literals;
+
+        if (in == size) break; // завершающие литералы
+
+        if (size - in < 2) corrupted("обрыв смещения");
+        size_t offset = src[in] | (static_cast<size_t>(src[in + 1]) << 8);
+        in += 2;
+        size_t length = read_length(token & 0x0F) + MIN_MATCH;
+        if (offset == 0 || offset > out || length > raw_size - out) corrupted("совпадение за границей");
+
+        // Побайтно: совпадение может перекрывать само себя
+        const uint8_t* match = dst + out - offset;
+        for (size_t k = 0; k < length; ++k) {
+            dst[out + k] = match[k];
+        }
+        out += length;
+    }
+
+    if (out != raw_size) corrupted("неверный размер");
+}
+
+} // namespace
+
+bool BlockCodec::is_available(Kind kind) {
+    switch (kind) {
+    case Kind::NONE:
+    case Kind::LZ:
+        return true;
+    case Kind::ZSTD:
+#ifdef LAB6_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+BlockCodec::Kind BlockCodec::resolve(Kind requested) {
+    return is_available(requested) ? requested : Kind::LZ;
+}
+
+size_t BlockCodec::max_compressed_size(Kind kind, size_t raw_size) {
+#ifdef LAB6_HAVE_ZSTD
+    if (kind == Kind::ZSTD) {
+        return ZSTD_compressBound(raw_size);
+    }
+#endif
+    if (kind == Kind::NONE) {
+        return raw_size;
+    }
+    // Худший случай LZ: одни литералы и байты продолжения длины
+    return raw_size + raw_size / 255 + 16;
+}
+
+void BlockCodec::compress(Kind kind, const uint8_t* src, size_t size, std::vector<uint8_t>& out) {
+    switch (kind) {
+    case Kind::NONE:
+        out.insert(out.end(), src, src + size);
+        return;
+    case Kind::LZ:
+        lz_compress(src, size, out);
+        return;
+    case Kind::ZSTD:
+#ifdef LAB6_HAVE_ZSTD
+    {
+        size_t start = out.size();
+        out.resize(start + ZSTD_compressBound(size));
+        size_t written = ZSTD_compress(out.data() + start, out.size() - start, src, size, 3);
+        if (ZSTD_isError(written)) {
+            throw std::runtime_error(std::string("Ошибка zstd: ") + ZSTD_getErrorName(written));
+        }
+        out.resize(start + written);
+        return;
+    }
+#else
+        break;
+#endif
+    }
+    throw std::runtime_error("Кодек сжатия не собран");
+}
+
+void BlockCodec::decompress(Kind kind, const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+    switch (kind) {
+    case Kind::NONE:
+        if (size != raw_size) corrupted("неверный размер");
+        std::memcpy(dst, src, size);
+        return;
+    case Kind::LZ:
+        lz_decompress(src, size, dst, raw_size);
+        return;
+    case Kind::ZSTD:
+#ifdef LAB6_HAVE_ZSTD
+    {
+        size_t written = ZSTD_decompress(dst, raw_size, src, size);
+        if (ZSTD_isError(written) || written != raw_size) corrupted("ошибка zstd");
+        return;
+    }
+#else
+        break;
+#endif
+    }
+    throw std::runtime_error("Кодек сжатия не собран");
+}
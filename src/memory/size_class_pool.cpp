@@ -0,0 +1,37 @@
+#include "../../include/memory/size_class_pool.h"
+#include <new>
+
+SizeClassPool::SizeClassPool(size_t size_class, size_t max_pooled_size)
+    : size_class(size_class),
+      max_pooled(max_pooled_size),
+      free_lists((max_pooled_size + size_class - 1) / size_class, nullptr) {}
+
+void* SizeClassPool::allocate(size_t size) {
+    const size_t index = class_of(size);
+    if (FreeBlock* head = free_lists[index]) {
+        free_lists[index] = head->next;
+        ++in_use;
+        return head;
+    }
+
+    const size_t block = (index + 1) * size_class;
+    if (chunk_left < block) {
+        return nullptr;
+    }
+    void* result = chunk_cursor;
+    chunk_cursor += block;
+    chunk_left -= block;
+    ++in_use;
+    return result;
+}
+
+void SizeClassPool::deallocate(void* block, size_t size) noexcept {
+    const size_t index = class_of(size);
+    free_lists[index] = new (block) FreeBlock{free_lists[index]};
+    --in_use;
+}
+
+void SizeClassPool::add_chunk(std::byte* base, size_t bytes) {
+    chunk_cursor = base;
+    chunk_left = bytes;
+}
@@ -4,7 +4,7 @@
 Druid::Druid(const std::string& name, const Point& position) : NPC(name, position) {}
 
 std::string Druid::get_type() const { 
-    return "Друид"; 
+    return TYPE_NAME;
 }
 
 void Druid::accept(Visitor& visitor) { 
@@ -19,17 +19,17 @@ std::optional<std::string> Druid::vs(const NPC& target) const {
 
     // Друиды убивают Белок
     if (type == "Белка") {
-        return "Друид уничтожил Белку!";
+        return KILL_MESSAGE;
     }
 
     return std::nullopt;
 }
 
 int Druid::get_move_distance() const {
-    return 10; // Друид: расстояние хода 10
+    return MOVE_DISTANCE;
 }
 
 int Druid::get_kill_distance() const {
-    return 10; // Друид: расстояние убийства 10
+    return KILL_DISTANCE;
 }
 
@@ -20,6 +20,12 @@ void NPC::kill() {
     alive = false; 
 }
 
+void NPC::respawn(const std::string& new_name, const Point& new_position) {
+    name = new_name;
+    position = new_position;
+    alive = true;
+}
+
 void NPC::move(int dx, int dy, int map_width, int map_height) {
     if (!alive) return; // Мертвые не передвигаются
     
@@ -0,0 +1,434 @@
+#include "../../include/npc/npc_archive.h"
+#include "../../include/npc/npc_factory.h"
+#include "../../include/io/byte_io.h"
+#include "../../include/geometry/morton.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr const char* CORRUPTED = "Поврежденное сохранение";
+
+// Заголовок блока: три u32 и u64
+constexpr size_t BLOCK_HEADER_SIZE = 4 + 4 + 4 + 8;
+
+// Запись не короче четырех байт: тип, dx, dy и длина имени - по varint
+constexpr uint32_t MIN_RECORD_SIZE = 4;
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+struct BlockInfo {
+    size_t offset = 0; // начало сжатых данных
+    uint32_t raw_size = 0;
+    uint32_t stored_size = 0;
+    uint32_t records = 0;
+    uint64_t checksum = 0;
+};
+
+// Сборка блоков в буферах фиксированного размера и запись в поток
+class BlockWriter {
+public:
+    BlockWriter(std::ofstream& file, BlockCodec::Kind codec) : file(file), codec(codec), records(raw) {
+        raw.reserve(NPCArchive::MAX_BLOCK_SIZE);
+        stored.reserve(BlockCodec::max_compressed_size(codec, NPCArchive::MAX_BLOCK_SIZE));
+    }
+
+    void add(uint32_t type, const Point& position, const std::string& name) {
+        records.varint(type);
+        records.zigzag(static_cast<int64_t>(position.get_x()) - previous_x);
+        records.zigzag(static_cast<int64_t>(position.get_y()) - previous_y);
+        records.string(name);
+        previous_x = position.get_x();
+        previous_y = position.get_y();
+        ++count;
+        if (raw.size() > NPCArchive::MAX_BLOCK_SIZE) {
+            throw std::runtime_error("Слишком длинное имя NPC для сохранения");
+        }
+
+        if (raw.size() >= NPCArchive::BLOCK_SIZE) {
+            flush();
+        }
+    }
+
+    void finish() {
+        flush();
+        std::vector<uint8_t> end;
+        ByteWriter(end).u32(0);
+        write(end);
+    }
+
+private:
+    std::ofstream& file;
+    BlockCodec::Kind codec;
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> stored;
+    ByteWriter records;
+    uint32_t count = 0;
+    int previous_x = 0;
+    int previous_y = 0;
+
+    void flush() {
+        if (count == 0) {
+            return;
+        }
+        stored.clear();
+        ByteWriter header(stored);
+        header.u32(static_cast<uint32_t>(raw.size()));
+        header.u32(0); // сжатый размер - после сжатия
+        header.u32(count);
+        header.u64(fnv1a(raw.data(), raw.size()));
+        BlockCodec::compress(codec, raw.data(), raw.size(), stored);
+        header.patch_u32(4, static_cast<uint32_t>(stored.size() - BLOCK_HEADER_SIZE));
+        write(stored);
+
+        raw.clear();
+        count = 0;
+        previous_x = 0;
+        previous_y = 0;
+    }
+
+    void write(const std::vector<uint8_t>& bytes) {
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+};
+
+std::vector<std::unique_ptr<NPC>> decode_block(const NPCFactory& factory,
+                                               const std::vector<std::string>& types,
+                                               const uint8_t* raw, const BlockInfo& block) {
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.reserve(block.records);
+
+    ByteReader in(raw, block.raw_size, CORRUPTED);
+    int64_t x = 0;
+    int64_t y = 0;
+    for (uint32_t i = 0; i < block.records; ++i) {
+        uint64_t type = in.varint();
+        x += in.zigzag();
+        y += in.zigzag();
+        std::string name = in.string();
+        if (type >= types.size()) {
+            in.fail("неверный индекс типа");
+        }
+        npcs.push_back(factory.create(types[type], name, Point(static_cast<int>(x), static_cast<int>(y))));
+    }
+    if (!in.done()) {
+        in.fail("лишние данные в блоке");
+    }
+    return npcs;
+}
+
+// Последовательное чтение полей ByteReader прямо из файла. Размер файла
+// известен заранее, поэтому длины из файла проверяются до выделения памяти
+class FileReader {
+public:
+    explicit FileReader(std::ifstream& file) : file(file) {
+        file.seekg(0, std::ios::end);
+        length = static_cast<uint64_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+    }
+
+    void read(uint8_t* out, size_t size) {
+        if (size > remaining()) {
+            fail("неожиданный конец данных");
+        }
+        file.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(size));
+        if (!file) {
+            throw std::runtime_error("Ошибка чтения файла сохранения");
+        }
+        pos += size;
+    }
+
+    std::vector<uint8_t> bytes(size_t size) {
+        std::vector<uint8_t> out(std::min<uint64_t>(size, remaining()));
+        read(out.data(), size);
+        return out;
+    }
+
+    uint32_t u32() {
+        uint8_t bytes[4];
+        read(bytes, sizeof(bytes));
+        return ByteReader(bytes, sizeof(bytes), CORRUPTED).u32();
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            read(&byte, 1);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        fail("слишком длинный varint");
+    }
+
+    std::string string() {
+        uint64_t size = varint();
+        if (size > remaining()) {
+            fail("неожиданный конец данных");
+        }
+        std::string value(size, '\0');
+        read(reinterpret_cast<uint8_t*>(value.data()), size);
+        return value;
+    }
+
+    // Query: сколько байт файла осталось
+    uint64_t remaining() const { return length - pos; }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(std::string(CORRUPTED) + ": " + what);
+    }
+
+private:
+    std::ifstream& file;
+    uint64_t length = 0;
+    uint64_t pos = 0;
+};
+
+} // namespace
+
+void NPCArchive::save(const std::string& filename, const std::vector<std::unique_ptr<NPC>>& npcs,
+                      BlockCodec::Kind codec) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+    codec = BlockCodec::resolve(codec);
+
+    // Словарь типов и пространственный порядок живых
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+        uint32_t type;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::string> types;
+    std::unordered_map<std::string, uint32_t> type_ids;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        const NPC* npc = npcs[i].get();
+        if (!npc || !npc->is_alive()) continue;
+
+        auto [it, inserted] = type_ids.emplace(npc->get_type(), static_cast<uint32_t>(types.size()));
+        if (inserted) {
+            types.push_back(it->first);
+        }
+        entries.push_back({morton_key(npc->get_position()), static_cast<uint32_t>(i), it->second});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.index < b.index);
+    });
+
+    std::vector<uint8_t> header;
+    ByteWriter out(header);
+    out.u32(MAGIC);
+    out.u32(VERSION);
+    out.u8(static_cast<uint8_t>(codec));
+    out.varint(types.size());
+    for (const auto& type : types) {
+        out.string(type);
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+
+    BlockWriter blocks(file, codec);
+    for (const auto& entry : entries) {
+        const NPC& npc = *npcs[entry.index];
+        blocks.add(entry.type, npc.get_position(), npc.get_name());
+    }
+    blocks.finish();
+
+    if (!file) {
+        throw std::runtime_error("Ошибка записи файла: " + filename);
+    }
+}
+
+std::vector<std::unique_ptr<NPC>> NPCArchive::load(const NPCFactory& factory, const std::string& filename,
+                                                   unsigned threads) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл: " + filename);
+    }
+    FileReader in(file);
+
+    std::vector<uint8_t> fixed = in.bytes(4 + 4 + 1);
+    ByteReader header(fixed.data(), fixed.size(), CORRUPTED);
+    if (header.u32() != MAGIC) {
+        in.fail("неверная сигнатура");
+    }
+    if (header.u32() != VERSION) {
+        in.fail("неподдерживаемая версия");
+    }
+    auto codec = static_cast<BlockCodec::Kind>(header.u8());
+    if (!BlockCodec::is_available(codec)) {
+        throw std::runtime_error("Сохранение сжато несобранным кодеком");
+    }
+
+    uint64_t type_count = in.varint();
+    if (type_count > in.remaining()) {
+        in.fail("неверный словарь типов");
+    }
+    auto known = factory.get_types();
+    std::vector<std::string> types(type_count);
+    for (auto& type : types) {
+        type = in.string();
+        if (std::find(known.begin(), known.end(), type) == known.end()) {
+            throw std::runtime_error("Неизвестный тип NPC в сохранении: " + type);
+        }
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Поток вызова читает блоки по одному и кладет в очередь ограниченной
+    // длины, распаковщики забирают их оттуда: в памяти не больше
+    // queue_limit сжатых блоков, а не весь файл
+    struct StoredBlock {
+        size_t index;
+        BlockInfo info;
+        std::vector<uint8_t> bytes;
+    };
+    const size_t queue_limit = 2 * static_cast<size_t>(threads);
+    std::deque<StoredBlock> queue;
+    std::vector<std::vector<uint8_t>> spare; // буферы прочитанных блоков
+    std::vector<std::vector<std::unique_ptr<NPC>>> decoded;
+    bool finished = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable has_block;
+    std::condition_variable has_room;
+
+    auto worker = [&]() {
+        std::vector<uint8_t> raw; // буфер потока, переиспользуется между блоками
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            has_block.wait(lock, [&]() { return finished || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            StoredBlock block = std::move(queue.front());
+            queue.pop_front();
+            has_room.notify_one();
+            if (error) {
+                spare.push_back(std::move(block.bytes));
+                continue;
+            }
+            lock.unlock();
+
+            std::vector<std::unique_ptr<NPC>> npcs;
+            std::exception_ptr failure;
+            try {
+                raw.resize(block.info.raw_size);
+                BlockCodec::decompress(codec, block.bytes.data(), block.bytes.size(), raw.data(), raw.size());
+                if (fnv1a(raw.data(), raw.size()) != block.info.checksum) {
+                    throw std::runtime_error(std::string(CORRUPTED) + ": неверная контрольная сумма блока");
+                }
+                npcs = decode_block(factory, types, raw.data(), block.info);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            lock.lock();
+            if (failure && !error) {
+                error = failure;
+            }
+            decoded[block.index] = std::move(npcs);
+            spare.push_back(std::move(block.bytes));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+
+    size_t total = 0;
+    bool stopped = false; // распаковщик уже нашел ошибку
+    try {
+        std::vector<uint8_t> block_header(BLOCK_HEADER_SIZE);
+        while (true) {
+            BlockInfo block;
+            block.raw_size = in.u32();
+            if (block.raw_size == 0) break;
+            in.read(block_header.data(), BLOCK_HEADER_SIZE - 4);
+            ByteReader fields(block_header.data(), BLOCK_HEADER_SIZE - 4, CORRUPTED);
+            block.stored_size = fields.u32();
+            block.records = fields.u32();
+            block.checksum = fields.u64();
+            // Размеры и число записей не входят в контрольную сумму -
+            // проверяются до выделения буферов
+            if (block.raw_size > MAX_BLOCK_SIZE) {
+                in.fail("неверный размер блока");
+            }
+            if (block.stored_size > BlockCodec::max_compressed_size(codec, block.raw_size) ||
+                (codec == BlockCodec::Kind::NONE && block.stored_size != block.raw_size)) {
+                in.fail("неверный сжатый размер блока");
+            }
+            if (block.records > block.raw_size / MIN_RECORD_SIZE) {
+                in.fail("неверное число записей блока");
+            }
+
+            std::vector<uint8_t> bytes;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                has_room.wait(lock, [&]() { return error || queue.size() < queue_limit; });
+                if (error) {
+                    stopped = true;
+                    break;
+                }
+                if (!spare.empty()) {
+                    bytes = std::move(spare.back());
+                    spare.pop_back();
+                }
+            }
+            bytes.resize(block.stored_size);
+            in.read(bytes.data(), bytes.size());
+            total += block.records;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.emplace_back();
+            queue.push_back({decoded.size() - 1, block, std::move(bytes)});
+            has_block.notify_one();
+        }
+        if (!stopped && in.remaining() != 0) {
+            in.fail("лишние данные");
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    has_block.notify_all();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.reserve(total);
+    for (auto& block : decoded) {
+        std::move(block.begin(), block.end(), std::back_inserter(npcs));
+    }
+    return npcs;
+}
@@ -0,0 +1,302 @@
+#include "../../include/npc/npc_arena.h"
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr size_t REGION_BYTES = NPCArena::REGION_CHUNKS * NPCArena::CHUNK_BYTES;
+constexpr size_t MAX_REGIONS = NPCArena::MAX_CHUNKS / NPCArena::REGION_CHUNKS;
+
+// Диапазоны адресов под куски всех областей: резервируются по одному, когда
+// кончается предыдущий, и не освобождаются. Чтение без блокировки (owns):
+// region_count публикуется после адреса диапазона
+std::atomic<std::byte*> regions[MAX_REGIONS];
+std::atomic<size_t> region_count{0};
+std::mutex regions_mutex;
+size_t region_chunks_used = NPCArena::REGION_CHUNKS; // в последнем диапазоне, под regions_mutex
+
+thread_local NPCHeap* current_heap = nullptr;
+
+// mbind без libnuma; маска на один unsigned long - узлы [0, 64)
+long bind_range(void* base, size_t length, int node, unsigned flags) {
+    if (node < 0) {
+        return syscall(SYS_mbind, base, length, MPOL_DEFAULT, nullptr, 0, flags);
+    }
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_mbind, base, length, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, flags);
+}
+
+void advise(void* base, size_t length, HugePages mode) {
+    // Совет, а не требование: ошибка madvise (например, без THP в ядре) не мешает работе
+    madvise(base, length, mode == HugePages::None ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+}
+
+std::byte* reserve_region() {
+    // Без доступа и без учета памяти: куски открываются по одному.
+    // Отображение с запасом, начало выровнено до границы большой страницы
+    void* mapped = mmap(nullptr, REGION_BYTES + NPCArena::CHUNK_BYTES, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    auto start = reinterpret_cast<uintptr_t>(mapped);
+    uintptr_t aligned = (start + NPCArena::CHUNK_BYTES - 1) & ~static_cast<uintptr_t>(NPCArena::CHUNK_BYTES - 1);
+    return reinterpret_cast<std::byte*>(aligned);
+}
+
+// Адрес следующего куска; nullptr, если зарезервировать диапазон не удалось
+// (следующий вызов попробует снова) или резерв исчерпан
+std::byte* next_chunk_address() {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    size_t count = region_count.load(std::memory_order_relaxed);
+    if (region_chunks_used == NPCArena::REGION_CHUNKS) {
+        std::byte* base = count < MAX_REGIONS ? reserve_region() : nullptr;
+        if (!base) {
+            return nullptr;
+        }
+        regions[count].store(base, std::memory_order_relaxed);
+        region_count.store(++count, std::memory_order_release);
+        region_chunks_used = 0;
+    }
+    return regions[count - 1].load(std::memory_order_relaxed) + region_chunks_used++ * NPCArena::CHUNK_BYTES;
+}
+
+} // namespace
+
+NPCHeap::NPCHeap() : pool(NPCArena::SIZE_CLASS, NPCArena::MAX_POOLED_SIZE) {}
+
+bool NPCHeap::map_chunk() {
+    std::byte* base = next_chunk_address();
+    if (!base) {
+        return false;
+    }
+
+    bool hugetlb = false;
+    if (mode == HugePages::Explicit) {
+        void* mapped = mmap(base, NPCArena::CHUNK_BYTES, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_FIXED, -1, 0);
+        if (mapped == base) {
+            hugetlb = true;
+        } else {
+            ++fallbacks;
+        }
+    }
+    if (!hugetlb) {
+        // Неудачный MAP_HUGETLB мог снять резерв с куска - тогда отображаем
+        // заново, не затирая чужое отображение, если адрес уже занят
+        if (mprotect(base, NPCArena::CHUNK_BYTES, PROT_READ | PROT_WRITE) != 0 &&
+            mmap(base, NPCArena::CHUNK_BYTES, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != base) {
+            return false;
+        }
+        advise(base, NPCArena::CHUNK_BYTES, mode);
+    }
+    // Политика задается до первого касания - страницы сразу на нужном узле
+    if (node >= 0) {
+        bind_range(base, NPCArena::CHUNK_BYTES, node, 0);
+    }
+
+    // Заголовок куска - область-владелец: по нему delete находит область блока
+    new (base) NPCHeap*(this);
+    chunks.push_back({base, hugetlb});
+    pool.add_chunk(base + NPCArena::SIZE_CLASS, NPCArena::CHUNK_BYTES - NPCArena::SIZE_CLASS);
+    return true;
+}
+
+void* NPCHeap::allocate(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        void* result = pool.allocate(size);
+        if (!result && map_chunk()) {
+            result = pool.allocate(size);
+        }
+        if (result) {
+            return result;
+        }
+        ++plain;
+    }
+    // Ядро не дало кусок: блок из обычной кучи, delete узнает его по адресу
+    return ::operator new(size);
+}
+
+void NPCHeap::deallocate(void* block, size_t size) noexcept {
+    std::lock_guard<std::mutex> lock(mutex);
+    pool.deallocate(block, size);
+}
+
+void NPCHeap::set_huge_pages(HugePages huge_pages) {
+    std::lock_guard<std::mutex> lock(mutex);
+    mode = huge_pages;
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.hugetlb) {
+            advise(chunk.base, NPCArena::CHUNK_BYTES, mode);
+        }
+    }
+}
+
+void NPCHeap::bind_to_node(int target) {
+    if (target < -1 || target >= NPCArena::MAX_NODES) {
+        throw std::invalid_argument("Узел NUMA вне допустимого диапазона: " + std::to_string(target));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Chunk& chunk : chunks) {
+        if (bind_range(chunk.base, NPCArena::CHUNK_BYTES, target, target >= 0 ? MPOL_MF_MOVE : 0) != 0) {
+            throw std::runtime_error(std::string("Не удалось закрепить память NPC за узлом: ") + std::strerror(errno));
+        }
+    }
+    node = target;
+}
+
+void NPCHeap::reset() noexcept {
+    std::lock_guard<std::mutex> lock(mutex);
+    mode = HugePages::None;
+    node = -1;
+    for (const Chunk& chunk : chunks) {
+        if (!chunk.hugetlb) {
+            advise(chunk.base, NPCArena::CHUNK_BYTES, mode);
+        }
+        bind_range(chunk.base, NPCArena::CHUNK_BYTES, -1, 0); // страницы остаются, где лежат
+    }
+}
+
+HugePages NPCHeap::huge_pages() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return mode;
+}
+
+int NPCHeap::bound_node() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return node;
+}
+
+size_t NPCHeap::reserved_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size() * NPCArena::CHUNK_BYTES;
+}
+
+size_t NPCHeap::objects_in_use() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pool.blocks_in_use();
+}
+
+size_t NPCHeap::huge_page_fallbacks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fallbacks;
+}
+
+size_t NPCHeap::plain_allocations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return plain;
+}
+
+std::vector<size_t> NPCHeap::pages_per_node() const {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<void*> pages;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Chunk& chunk : chunks) {
+            for (size_t offset = 0; offset < NPCArena::CHUNK_BYTES; offset += page) {
+                pages.push_back(chunk.base + offset);
+            }
+        }
+    }
+
+    // move_pages без целевых узлов только сообщает узел каждой страницы
+    std::vector<int> status(pages.size(), 0);
+    std::vector<size_t> per_node;
+    if (!pages.empty() &&
+        syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+        return per_node;
+    }
+    for (int where : status) {
+        if (where < 0) continue; // страница еще не затронута
+        if (static_cast<size_t>(where) >= per_node.size()) {
+            per_node.resize(static_cast<size_t>(where) + 1, 0);
+        }
+        ++per_node[static_cast<size_t>(where)];
+    }
+    return per_node;
+}
+
+void NPCArena::Release::operator()(NPCHeap* heap) const noexcept {
+    heap->reset();
+    NPCArena& arena = instance();
+    std::lock_guard<std::mutex> lock(arena.heaps_mutex);
+    arena.idle.push_back(heap);
+}
+
+NPCArena::Scope::Scope(NPCHeap& heap) : Scope(&heap) {}
+
+NPCArena::Scope::Scope(NPCHeap* heap) : previous(current_heap) {
+    current_heap = heap;
+}
+
+NPCArena::Scope::~Scope() {
+    current_heap = previous;
+}
+
+NPCArena& NPCArena::instance() {
+    // Не разрушается: NPC статических объектов освобождаются и после main
+    static NPCArena* arena = new NPCArena();
+    return *arena;
+}
+
+NPCArena::HeapLease NPCArena::acquire() {
+    std::lock_guard<std::mutex> lock(heaps_mutex);
+    if (!idle.empty()) {
+        NPCHeap* heap = idle.back();
+        idle.pop_back();
+        return HeapLease(heap);
+    }
+    heaps.push_back(std::unique_ptr<NPCHeap>(new NPCHeap()));
+    return HeapLease(heaps.back().get());
+}
+
+void* NPCArena::allocate(size_t size) {
+    NPCHeap* heap = current_heap;
+    if (heap && size != 0 && size <= MAX_POOLED_SIZE) {
+        return heap->allocate(size);
+    }
+    return ::operator new(size);
+}
+
+void NPCArena::deallocate(void* block, size_t size) noexcept {
+    if (!owns(block)) {
+        ::operator delete(block);
+        return;
+    }
+    auto chunk = reinterpret_cast<uintptr_t>(block) & ~static_cast<uintptr_t>(CHUNK_BYTES - 1);
+    (*reinterpret_cast<NPCHeap**>(chunk))->deallocate(block, size);
+}
+
+bool NPCArena::owns(const void* block) noexcept {
+    const auto* address = static_cast<const std::byte*>(block);
+    size_t count = region_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        const std::byte* base = regions[i].load(std::memory_order_relaxed);
+        if (address >= base && address < base + REGION_BYTES) {
+            return true;
+        }
+    }
+    return false;
+}
+
+NPCHeap* NPCArena::current() {
+    return current_heap;
+}
+
+size_t NPCArena::heap_count() const {
+    std::lock_guard<std::mutex> lock(heaps_mutex);
+    return heaps.size();
+}
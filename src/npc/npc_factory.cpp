@@ -2,10 +2,20 @@
 #include "../../include/npc/orc.h"
 #include "../../include/npc/druid.h"
 #include "../../include/npc/squirrel.h"
+#include "../../include/npc/npc_archive.h"
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
 
 NPCFactory::NPCFactory() {
     register_creators();
@@ -36,6 +46,15 @@ std::unique_ptr<NPC> NPCFactory::create(const std::string& type,
     throw std::invalid_argument("Неизвестный тип NPC: " + type);
 }
 
+std::vector<std::string> NPCFactory::get_types() const {
+    std::vector<std::string> types;
+    types.reserve(creators.size());
+    for (const auto& [creator_type, creator_func] : creators) {
+        types.push_back(creator_type);
+    }
+    return types;
+}
+
 std::vector<std::unique_ptr<NPC>> NPCFactory::load_from_file(const std::string& filename) const {
     std::vector<std::unique_ptr<NPC>> npcs;
     std::ifstream file(filename);
@@ -82,3 +101,139 @@ void NPCFactory::save_to_file(const std::string& filename,
     }
 }
 
+
+namespace {
+
+// Строка формата save_to_file без промежуточных потоков
+void append_npc_line(std::string& buffer, const NPC& npc) {
+    Point position = npc.get_position();
+    buffer += npc.get_name();
+    buffer += ' ';
+    buffer += npc.get_type();
+
+    char digits[16];
+    for (int value : {position.get_x(), position.get_y()}) {
+        buffer += ' ';
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+    }
+    buffer += '\n';
+}
+
+// Дескриптор файла, закрываемый при выходе из области видимости
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    ~FileDescriptor() {
+        if (fd >= 0) ::close(fd);
+    }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const { return fd; }
+
+private:
+    int fd;
+};
+
+void write_all_at(int fd, const std::string& buffer, off_t offset, const std::string& filename) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t result = ::pwrite(fd, buffer.data() + written, buffer.size() - written,
+                                  offset + static_cast<off_t>(written));
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Ошибка записи файла " + filename + ": " + std::strerror(errno));
+        }
+        written += static_cast<size_t>(result);
+    }
+}
+
+} // namespace
+
+void NPCFactory::save_to_file_parallel(const std::string& filename,
+                                       const std::vector<std::unique_ptr<NPC>>& npcs,
+                                       unsigned threads) const {
+    FileDescriptor file(::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+    if (file.get() < 0) {
+        throw std::runtime_error("Не удалось открыть файл для записи: " + filename);
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, npcs.size()));
+    size_t chunk_size = (npcs.size() + chunks - 1) / chunks;
+
+    // Исключение задачи запоминается и пробрасывается после объединения потоков
+    std::vector<std::exception_ptr> errors(chunks);
+    auto rethrow_first = [&errors]() {
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    };
+
+    // Фаза 1: каждый поток форматирует свой кусок в собственный буфер
+    std::vector<std::string> buffers(chunks);
+    auto format = [&](size_t chunk) {
+        try {
+            size_t begin = chunk * chunk_size;
+            size_t end = std::min(npcs.size(), begin + chunk_size);
+            std::string& buffer = buffers[chunk];
+            buffer.reserve((end - begin) * 32);
+            for (size_t i = begin; i < end; ++i) {
+                if (npcs[i] && npcs[i]->is_alive()) {
+                    append_npc_line(buffer, *npcs[i]);
+                }
+            }
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    // Фаза 2: куски пишутся независимо по смещениям - префиксным суммам размеров
+    std::vector<off_t> offsets(chunks, 0);
+    auto write_chunk = [&](size_t chunk) {
+        try {
+            write_all_at(file.get(), buffers[chunk], offsets[chunk], filename);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    // Поток, который не удалось создать, заменяется выполнением куска на месте
+    auto run_phase = [chunks](auto&& task) {
+        std::vector<std::thread> pool;
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            try {
+                pool.emplace_back(task, chunk);
+            } catch (const std::system_error&) {
+                task(chunk);
+            }
+        }
+        task(0);
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    };
+
+    run_phase(format);
+    rethrow_first();
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        offsets[chunk] = offsets[chunk - 1] + static_cast<off_t>(buffers[chunk - 1].size());
+    }
+    run_phase(write_chunk);
+    rethrow_first();
+}
+
+void NPCFactory::save_compressed(const std::string& filename,
+                                 const std::vector<std::unique_ptr<NPC>>& npcs,
+                                 BlockCodec::Kind codec) const {
+    NPCArchive::save(filename, npcs, codec);
+}
+
+std::vector<std::unique_ptr<NPC>> NPCFactory::load_compressed(const std::string& filename,
+                                                              unsigned threads) const {
+    return NPCArchive::load(*this, filename, threads);
+}
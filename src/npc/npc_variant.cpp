@@ -0,0 +1,23 @@
+#include "../../include/npc/npc_variant.h"
+#include "../../include/battle/visitor.h"
+#include <optional>
+
+namespace {
+
+// Конкретный тип узнается штатным accept, без dynamic_cast
+class VariantCopier : public Visitor {
+public:
+    std::optional<NPCVariant> result;
+
+    void visit(Druid& druid) override { result.emplace(druid); }
+    void visit(Orc& orc) override { result.emplace(orc); }
+    void visit(Squirrel& squirrel) override { result.emplace(squirrel); }
+};
+
+} // namespace
+
+NPCVariant to_variant(NPC& npc) {
+    VariantCopier copier;
+    npc.accept(copier);
+    return std::move(*copier.result);
+}
@@ -4,7 +4,7 @@
 Orc::Orc(const std::string& name, const Point& position) : NPC(name, position) {}
 
 std::string Orc::get_type() const { 
-    return "Орк"; 
+    return TYPE_NAME;
 }
 
 void Orc::accept(Visitor& visitor) { 
@@ -19,17 +19,17 @@ std::optional<std::string> Orc::vs(const NPC& target) const {
 
     // Орки убивают друидов
     if (type == "Друид") {
-        return "Орк разорвал бедолагу Друида!";
+        return KILL_MESSAGE;
     }
 
     return std::nullopt;
 }
 
 int Orc::get_move_distance() const {
-    return 20; // Орк: расстояние хода 20
+    return MOVE_DISTANCE;
 }
 
 int Orc::get_kill_distance() const {
-    return 10; // Орк: расстояние убийства 10
+    return KILL_DISTANCE;
 }
 
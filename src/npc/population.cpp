@@ -0,0 +1,44 @@
+#include "../../include/npc/population.h"
+#include <stdexcept>
+
+PopulationCounters::PopulationCounters(std::vector<std::string> type_names)
+    : names(std::move(type_names)) {
+    if (names.size() > MAX_TYPES) {
+        throw std::invalid_argument("Слишком много типов NPC для счетчиков численности");
+    }
+}
+
+void PopulationCounters::on_spawn(size_t type) {
+    per_type[type].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PopulationCounters::on_death(size_t type) {
+    per_type[type].fetch_sub(1, std::memory_order_relaxed);
+    total.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void PopulationCounters::reset() {
+    for (auto& counter : per_type) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+}
+
+size_t PopulationCounters::alive_of(size_t type) const {
+    return type < names.size() ? static_cast<size_t>(per_type[type].load(std::memory_order_relaxed)) : 0;
+}
+
+size_t PopulationCounters::alive_of(const std::string& type) const {
+    int index = type_index(type);
+    return index < 0 ? 0 : alive_of(static_cast<size_t>(index));
+}
+
+int PopulationCounters::type_index(const std::string& type) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == type) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
@@ -4,7 +4,7 @@
 Squirrel::Squirrel(const std::string& name, const Point& position) : NPC(name, position) {}
 
 std::string Squirrel::get_type() const { 
-    return "Белка"; 
+    return TYPE_NAME;
 }
 
 void Squirrel::accept(Visitor& visitor) { 
@@ -17,10 +17,10 @@ std::optional<std::string> Squirrel::vs(const NPC& target) const {
 }
 
 int Squirrel::get_move_distance() const {
-    return 5; // Белка: расстояние хода 5
+    return MOVE_DISTANCE;
 }
 
 int Squirrel::get_kill_distance() const {
-    return 5; // Белка: расстояние убийства 5
+    return KILL_DISTANCE;
 }
 
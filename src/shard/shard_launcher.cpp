@@ -0,0 +1,246 @@
+#include "../../include/shard/shard_launcher.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+void encode_result(const ShardedRunResult& result, std::vector<uint8_t>& out) {
+    ByteWriter writer(out);
+    writer.u64(result.migrations);
+    writer.u64(result.halo_records);
+    writer.varint(result.summary.kills.size());
+    for (const auto& [pair, count] : result.summary.kills) {
+        writer.string(pair.first);
+        writer.string(pair.second);
+        writer.varint(count);
+    }
+    ShardLink::encode(result.survivors, writer);
+}
+
+void merge_result(const std::vector<uint8_t>& data, ShardedRunResult& result) {
+    ByteReader reader(data.data(), data.size(), "Итоги полосы");
+    result.migrations += reader.u64();
+    result.halo_records += reader.u64();
+    uint64_t kinds = reader.varint();
+    for (uint64_t i = 0; i < kinds; ++i) {
+        std::string killer = reader.string();
+        std::string victim = reader.string();
+        result.summary.kills[{killer, victim}] += reader.varint();
+    }
+    ShardLink::decode(reader, result.survivors);
+    if (!reader.done()) {
+        reader.fail("лишние данные");
+    }
+}
+
+void finish(ShardedRunResult& result) {
+    std::sort(result.survivors.begin(), result.survivors.end(),
+              [](const ShardNPC& a, const ShardNPC& b) { return a.id < b.id; });
+    result.summary.survivors.clear();
+    for (const ShardNPC& npc : result.survivors) {
+        ++result.summary.survivors[StripShard::type_name(npc.type)];
+    }
+}
+
+// Обмен списками NPC с соседями: сообщение уходит каждому соседу, даже пустое
+void swap_with_neighbours(ShardLink* up, ShardLink* down,
+                          const std::vector<ShardNPC>& to_up, const std::vector<ShardNPC>& to_down,
+                          std::vector<uint8_t>& buffer, std::vector<ShardNPC>& incoming) {
+    incoming.clear();
+    for (auto [link, outgoing] : {std::pair{up, &to_up}, std::pair{down, &to_down}}) {
+        if (!link) continue;
+        buffer.clear();
+        ByteWriter writer(buffer);
+        ShardLink::encode(*outgoing, writer);
+        link->post(buffer);
+    }
+    ShardLink::exchange({up, down});
+    for (ShardLink* link : {up, down}) {
+        if (!link) continue;
+        ByteReader reader(link->received().data(), link->received().size(), "Сообщение полосы");
+        ShardLink::decode(reader, incoming);
+        if (!reader.done()) {
+            reader.fail("лишние данные");
+        }
+    }
+}
+
+} // namespace
+
+ShardedRunResult ShardLauncher::run_strip(StripShard& shard, ShardLink* up, ShardLink* down, int ticks) {
+    ShardedRunResult result;
+    std::vector<ShardNPC> to_up;
+    std::vector<ShardNPC> to_down;
+    std::vector<ShardNPC> incoming;
+    std::vector<uint8_t> buffer;
+
+    for (int t = 0; t < ticks; ++t) {
+        shard.move();
+
+        // Переходы до ореола: ореол собирается уже по новым владельцам
+        to_up.clear();
+        to_down.clear();
+        shard.take_migrants(to_up, to_down);
+        result.migrations += to_up.size() + to_down.size();
+        swap_with_neighbours(up, down, to_up, to_down, buffer, incoming);
+        shard.add_owned(incoming);
+
+        to_up.clear();
+        to_down.clear();
+        shard.collect_halo(to_up, to_down);
+        result.halo_records += to_up.size() + to_down.size();
+        swap_with_neighbours(up, down, to_up, to_down, buffer, incoming);
+        shard.resolve_battles(incoming);
+    }
+
+    result.summary.kills = shard.kills();
+    result.survivors = shard.owned();
+    finish(result);
+    return result;
+}
+
+ShardedRunResult ShardLauncher::run_single_process(const ShardConfig& config, int ticks) {
+    auto start = std::chrono::steady_clock::now();
+    ShardConfig single = config;
+    single.shards = 1;
+    StripShard shard(single, 0);
+    ShardedRunResult result = run_strip(shard, nullptr, nullptr, ticks);
+    result.summary.seed = config.seed;
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+ShardedRunResult ShardLauncher::run(const ShardConfig& config, int ticks) {
+    StripShard::check_config(config);
+    auto start = std::chrono::steady_clock::now();
+    const int shards = config.shards;
+
+    // neighbour[i] связывает полосы i и i + 1, report[i] - полосу i и родителя
+    std::vector<std::array<int, 2>> neighbour(shards - 1);
+    std::vector<std::array<int, 2>> report(shards);
+    auto close_all = [&]() {
+        for (auto* pairs : {&neighbour, &report}) {
+            for (auto& fds : *pairs) {
+                for (int& fd : fds) {
+                    if (fd >= 0) ::close(fd);
+                    fd = -1;
+                }
+            }
+        }
+    };
+    for (auto* pairs : {&neighbour, &report}) {
+        for (auto& fds : *pairs) {
+            fds = {-1, -1};
+        }
+    }
+    for (auto* pairs : {&neighbour, &report}) {
+        for (auto& fds : *pairs) {
+            if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds.data()) < 0) {
+                std::string error = std::strerror(errno);
+                close_all();
+                throw std::runtime_error("Не удалось связать полосы: " + error);
+            }
+        }
+    }
+
+    std::vector<pid_t> children;
+    for (int i = 0; i < shards; ++i) {
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::string error = std::strerror(errno);
+            close_all();
+            for (pid_t child : children) ::waitpid(child, nullptr, 0);
+            throw std::runtime_error("Не удалось запустить процесс полосы: " + error);
+        }
+        if (pid == 0) {
+            // Процесс полосы: оставляет свои концы соединений, остальные закрывает
+            int up_fd = i > 0 ? neighbour[i - 1][1] : -1;
+            int down_fd = i + 1 < shards ? neighbour[i][0] : -1;
+            int report_fd = report[i][1];
+            for (auto* pairs : {&neighbour, &report}) {
+                for (auto& fds : *pairs) {
+                    for (int fd : fds) {
+                        if (fd != up_fd && fd != down_fd && fd != report_fd) ::close(fd);
+                    }
+                }
+            }
+
+            int code = 0;
+            try {
+                std::unique_ptr<ShardLink> up = up_fd >= 0 ? std::make_unique<ShardLink>(up_fd) : nullptr;
+                std::unique_ptr<ShardLink> down = down_fd >= 0 ? std::make_unique<ShardLink>(down_fd) : nullptr;
+                ShardLink parent(report_fd);
+                StripShard shard(config, i);
+                ShardedRunResult result = run_strip(shard, up.get(), down.get(), ticks);
+
+                std::vector<uint8_t> message;
+                encode_result(result, message);
+                parent.post(message);
+                ShardLink::exchange({&parent}); // ответ родителя - итоги приняты
+            } catch (...) {
+                code = 1;
+            }
+            ::_exit(code); // без деструкторов и обработчиков atexit родителя
+        }
+        children.push_back(pid);
+    }
+
+    // Родителю нужны только свои концы соединений с полосами
+    std::vector<std::unique_ptr<ShardLink>> links;
+    std::string failure;
+    try {
+        for (auto& fds : neighbour) {
+            for (int& fd : fds) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        for (auto& fds : report) {
+            ::close(fds[1]);
+            fds[1] = -1;
+            int fd = fds[0];
+            fds[0] = -1;
+            links.push_back(std::make_unique<ShardLink>(fd));
+        }
+    } catch (const std::exception& e) {
+        failure = e.what();
+    }
+
+    ShardedRunResult result;
+    result.summary.seed = config.seed;
+    for (size_t i = 0; i < links.size() && failure.empty(); ++i) {
+        try {
+            links[i]->post({});
+            ShardLink::exchange({links[i].get()});
+            merge_result(links[i]->received(), result);
+        } catch (const std::exception& e) {
+            failure = "полоса " + std::to_string(i) + ": " + e.what();
+        }
+    }
+    links.clear(); // закрытие соединений будит полосы, ждущие родителя
+    close_all();
+
+    for (size_t i = 0; i < children.size(); ++i) {
+        int status = 0;
+        ::waitpid(children[i], &status, 0);
+        if (failure.empty() && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+            failure = "полоса " + std::to_string(i) + " завершилась с ошибкой";
+        }
+    }
+    if (!failure.empty()) {
+        throw std::runtime_error("Распределенный прогон не удался: " + failure);
+    }
+
+    finish(result);
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
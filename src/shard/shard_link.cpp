@@ -0,0 +1,153 @@
+#include "../../include/shard/shard_link.h"
+#include "../../include/game/type_kernels.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t READ_CHUNK = 64 * 1024;
+
+[[noreturn]] void fail_errno(const char* what) {
+    throw std::runtime_error(std::string(what) + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+ShardLink::ShardLink(int fd) : fd(fd) {
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Не удалось настроить соединение полосы: " + error);
+    }
+}
+
+ShardLink::~ShardLink() {
+    ::close(fd);
+}
+
+void ShardLink::post(const std::vector<uint8_t>& payload) {
+    ByteWriter writer(outbox);
+    writer.u32(static_cast<uint32_t>(payload.size()));
+    outbox.insert(outbox.end(), payload.begin(), payload.end());
+}
+
+bool ShardLink::send_some() {
+    while (sent < outbox.size()) {
+        ssize_t n = ::send(fd, outbox.data() + sent, outbox.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+            if (errno == EINTR) continue;
+            fail_errno("Ошибка отправки соседней полосе");
+        }
+        sent += static_cast<size_t>(n);
+    }
+    outbox.clear();
+    sent = 0;
+    return true;
+}
+
+bool ShardLink::receive_some() {
+    while (true) {
+        size_t old_size = inbox.size();
+        inbox.resize(old_size + READ_CHUNK);
+        ssize_t n = ::recv(fd, inbox.data() + old_size, READ_CHUNK, 0);
+        inbox.resize(old_size + (n > 0 ? static_cast<size_t>(n) : 0));
+        if (n == 0) {
+            // Сосед, отправивший последнее сообщение, вправе завершиться
+            if (take_message()) return true;
+            throw std::runtime_error("Соседняя полоса закрыла соединение");
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            fail_errno("Ошибка приема от соседней полосы");
+        }
+    }
+    return take_message();
+}
+
+bool ShardLink::take_message() {
+    if (inbox.size() < 4) {
+        return false;
+    }
+    ByteReader header(inbox.data(), 4, "Сообщение полосы");
+    size_t length = header.u32();
+    if (inbox.size() - 4 < length) {
+        return false;
+    }
+    message.assign(inbox.begin() + 4, inbox.begin() + 4 + static_cast<std::ptrdiff_t>(length));
+    inbox.erase(inbox.begin(), inbox.begin() + 4 + static_cast<std::ptrdiff_t>(length));
+    return true;
+}
+
+void ShardLink::exchange(const std::vector<ShardLink*>& links) {
+    std::vector<ShardLink*> active;
+    std::vector<bool> received;
+    for (ShardLink* link : links) {
+        if (!link) continue;
+        active.push_back(link);
+        // Сосед мог уйти вперед: его следующее сообщение уже в inbox
+        received.push_back(link->take_message());
+    }
+
+    std::vector<pollfd> fds(active.size());
+    while (true) {
+        bool pending = false;
+        for (size_t i = 0; i < active.size(); ++i) {
+            bool sending = !active[i]->outbox.empty() && !active[i]->send_some();
+            fds[i].fd = active[i]->fd;
+            fds[i].events = static_cast<short>((sending ? POLLOUT : 0) | (received[i] ? 0 : POLLIN));
+            fds[i].revents = 0;
+            pending = pending || fds[i].events != 0;
+        }
+        if (!pending) {
+            return;
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            fail_errno("Ошибка ожидания соседних полос");
+        }
+        for (size_t i = 0; i < active.size(); ++i) {
+            if (!received[i] && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                received[i] = active[i]->receive_some();
+            }
+        }
+    }
+}
+
+void ShardLink::encode(const std::vector<ShardNPC>& npcs, ByteWriter& writer) {
+    writer.varint(npcs.size());
+    for (const ShardNPC& npc : npcs) {
+        writer.varint(npc.id);
+        writer.u8(npc.type);
+        writer.zigzag(npc.position.get_x());
+        writer.zigzag(npc.position.get_y());
+    }
+}
+
+void ShardLink::decode(ByteReader& reader, std::vector<ShardNPC>& out) {
+    uint64_t count = reader.varint();
+    if (count > reader.remaining()) {
+        reader.fail("некорректное число NPC");
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        ShardNPC npc;
+        npc.id = static_cast<uint32_t>(reader.varint());
+        npc.type = reader.u8();
+        if (npc.type >= NPC_TYPE_COUNT) {
+            reader.fail("неизвестный тип NPC");
+        }
+        int x = static_cast<int>(reader.zigzag());
+        int y = static_cast<int>(reader.zigzag());
+        npc.position = Point(x, y);
+        out.push_back(npc);
+    }
+}
@@ -0,0 +1,208 @@
+#include "../../include/shard/strip_shard.h"
+#include "../../include/game/kill_matrix.h"
+#include "../../include/game/type_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Поток случайности начальной расстановки (тики его не используют)
+constexpr uint64_t SPAWN_STREAM = std::numeric_limits<uint64_t>::max();
+constexpr uint64_t MOVE_SALT = 0;
+constexpr uint64_t DICE_SALT = 1;
+constexpr int DICE_SIDES = 6;
+
+// Правила типов - общая с Game матрица закрытого набора
+const KillMatrix& rules() {
+    return KillMatrix::closed_set();
+}
+
+int max_move_distance() {
+    int result = 0;
+    for (size_t type = 0; type < rules().type_count(); ++type) {
+        result = std::max(result, rules().move_distance(type));
+    }
+    return result;
+}
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+uint64_t StripShard::mix(uint64_t seed, uint64_t a, uint64_t b, uint64_t c) {
+    return splitmix64(splitmix64(splitmix64(splitmix64(seed) ^ a) ^ b) ^ c);
+}
+
+int StripShard::halo_distance() {
+    return rules().max_kill_distance();
+}
+
+const std::string& StripShard::type_name(uint8_t type) {
+    if (type >= rules().type_count()) {
+        throw std::out_of_range("Неизвестный тип NPC полосы: " + std::to_string(type));
+    }
+    return rules().type_name(type);
+}
+
+bool StripShard::attack_wins(uint64_t seed, uint64_t tick, uint32_t attacker, uint32_t target) {
+    uint64_t pair = (static_cast<uint64_t>(attacker) << 32) | target;
+    uint64_t dice = mix(seed, tick, pair, DICE_SALT);
+    int attack = 1 + static_cast<int>(dice % DICE_SIDES);
+    int defense = 1 + static_cast<int>((dice >> 32) % DICE_SIDES);
+    return attack > defense;
+}
+
+void StripShard::check_config(const ShardConfig& config) {
+    if (config.width <= 0 || config.height <= 0 || config.shards < 1) {
+        throw std::invalid_argument("Некорректные размеры распределенного мира");
+    }
+    if (config.npc_count > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Слишком много NPC для распределенного мира");
+    }
+    int required = std::max(max_move_distance(), rules().max_kill_distance());
+    if (config.shards > 1 && config.height / config.shards < required) {
+        throw std::invalid_argument("Полоса ниже " + std::to_string(required) +
+                                    " строк: уменьшите число полос");
+    }
+}
+
+StripShard::StripShard(const ShardConfig& config, int index) : config(config), shard_index(index) {
+    check_config(config);
+    if (index < 0 || index >= config.shards) {
+        throw std::invalid_argument("Номер полосы вне диапазона: " + std::to_string(index));
+    }
+
+    rows_begin = static_cast<int>(static_cast<int64_t>(config.height) * index / config.shards);
+    rows_end = static_cast<int>(static_cast<int64_t>(config.height) * (index + 1) / config.shards);
+
+    // Все полосы перебирают одну и ту же расстановку и оставляют свои строки
+    for (uint32_t id = 0; id < config.npc_count; ++id) {
+        int y = static_cast<int>(mix(config.seed, SPAWN_STREAM, id, 2) % static_cast<uint64_t>(config.height));
+        if (y < rows_begin || y >= rows_end) continue;
+        ShardNPC npc;
+        npc.id = id;
+        npc.type = static_cast<uint8_t>(mix(config.seed, SPAWN_STREAM, id, 0) % NPC_TYPE_COUNT);
+        npc.position = Point(static_cast<int>(mix(config.seed, SPAWN_STREAM, id, 1) %
+                                              static_cast<uint64_t>(config.width)), y);
+        npcs.push_back(npc);
+    }
+}
+
+void StripShard::move() {
+    const KillMatrix& rules = ::rules();
+    for (ShardNPC& npc : npcs) {
+        double unit = static_cast<double>(mix(config.seed, ticks, npc.id, MOVE_SALT) >> 11) * 0x1.0p-53;
+        double angle = unit * 2.0 * M_PI;
+        int distance = rules.move_distance(npc.type);
+        int x = npc.position.get_x() + static_cast<int>(std::round(std::cos(angle) * distance));
+        int y = npc.position.get_y() + static_cast<int>(std::round(std::sin(angle) * distance));
+        npc.position = Point(std::clamp(x, 0, config.width - 1), std::clamp(y, 0, config.height - 1));
+    }
+}
+
+void StripShard::take_migrants(std::vector<ShardNPC>& up, std::vector<ShardNPC>& down) {
+    size_t kept = 0;
+    for (const ShardNPC& npc : npcs) {
+        if (npc.position.get_y() < rows_begin) {
+            up.push_back(npc);
+        } else if (npc.position.get_y() >= rows_end) {
+            down.push_back(npc);
+        } else {
+            npcs[kept++] = npc;
+        }
+    }
+    npcs.resize(kept);
+}
+
+void StripShard::add_owned(const std::vector<ShardNPC>& migrants) {
+    npcs.insert(npcs.end(), migrants.begin(), migrants.end());
+}
+
+void StripShard::collect_halo(std::vector<ShardNPC>& up, std::vector<ShardNPC>& down) const {
+    const int reach = halo_distance();
+    for (const ShardNPC& npc : npcs) {
+        if (shard_index > 0 && npc.position.get_y() < rows_begin + reach) {
+            up.push_back(npc);
+        }
+        if (shard_index + 1 < config.shards && npc.position.get_y() >= rows_end - reach) {
+            down.push_back(npc);
+        }
+    }
+}
+
+void StripShard::resolve_battles(const std::vector<ShardNPC>& halo) {
+    const KillMatrix& rules = ::rules();
+    const int cell = std::max(1, halo_distance());
+
+    // Сетка по полосе с запасом на ореол: атакующие цели - в соседних ячейках
+    const int top = rows_begin - cell;
+    const int columns = (config.width + cell - 1) / cell;
+    const int rows = (rows_end - top + cell + cell - 1) / cell;
+    auto cell_of = [&](const Point& p) {
+        int cx = std::clamp(p.get_x() / cell, 0, columns - 1);
+        int cy = std::clamp((p.get_y() - top) / cell, 0, rows - 1);
+        return static_cast<size_t>(cy) * columns + cx;
+    };
+
+    fighters.assign(npcs.begin(), npcs.end());
+    fighters.insert(fighters.end(), halo.begin(), halo.end());
+    cell_start.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    for (const ShardNPC& npc : fighters) {
+        ++cell_start[cell_of(npc.position) + 1];
+    }
+    for (size_t i = 1; i < cell_start.size(); ++i) {
+        cell_start[i] += cell_start[i - 1];
+    }
+    cell_items.resize(fighters.size());
+    {
+        std::vector<uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+        for (uint32_t i = 0; i < fighters.size(); ++i) {
+            cell_items[fill[cell_of(fighters[i].position)]++] = i;
+        }
+    }
+
+    // Все цели проверяются по позициям после хода, смерти применяются в конце
+    killed.assign(npcs.size(), 0);
+    for (size_t t = 0; t < npcs.size(); ++t) {
+        const ShardNPC& target = npcs[t];
+        int cx = static_cast<int>(cell_of(target.position) % columns);
+        int cy = static_cast<int>(cell_of(target.position) / columns);
+        const ShardNPC* killer = nullptr;
+
+        for (int y = std::max(0, cy - 1); y <= std::min(rows - 1, cy + 1); ++y) {
+            for (int x = std::max(0, cx - 1); x <= std::min(columns - 1, cx + 1); ++x) {
+                size_t c = static_cast<size_t>(y) * columns + x;
+                for (uint32_t k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+                    const ShardNPC& attacker = fighters[cell_items[k]];
+                    if (!rules.can_kill(attacker.type, target.type) ||
+                        !attacker.position.within(target.position, rules.kill_distance(attacker.type))) {
+                        continue;
+                    }
+                    if ((!killer || attacker.id < killer->id) &&
+                        attack_wins(config.seed, ticks, attacker.id, target.id)) {
+                        killer = &attacker;
+                    }
+                }
+            }
+        }
+
+        if (killer) {
+            killed[t] = 1;
+            ++kill_counts[{rules.type_name(killer->type), rules.type_name(target.type)}];
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        if (!killed[i]) npcs[kept++] = npcs[i];
+    }
+    npcs.resize(kept);
+    ++ticks;
+}
@@ -0,0 +1,177 @@
+#include "../../include/stream/frame_codec.h"
+#include "../../include/io/byte_io.h"
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr const char* CORRUPTED = "Поврежденный кадр";
+
+void put_spawn(ByteWriter& out, const WorldSnapshot& world, const NPCState& npc) {
+    out.u8(static_cast<uint8_t>(FrameEncoder::RecordKind::SPAWN));
+    out.varint(npc.handle.index);
+    out.varint(npc.handle.generation);
+    out.string(world.type_name(npc));
+    out.string(WorldSnapshot::name_of(npc));
+    out.zigzag(npc.position.get_x());
+    out.zigzag(npc.position.get_y());
+}
+
+// Заголовок кадра; длина и число записей (фиксированной ширины) заполняются в finish_frame
+size_t begin_frame(ByteWriter& out, uint64_t tick, uint8_t flags) {
+    size_t start = out.size();
+    out.u32(0);
+    out.u32(FrameEncoder::MAGIC);
+    out.u8(FrameEncoder::VERSION);
+    out.u8(flags);
+    out.varint(tick);
+    out.u32(0);
+    return start;
+}
+
+void finish_frame(ByteWriter& out, size_t start, size_t records_begin, uint32_t records) {
+    out.patch_u32(records_begin - 4, records);
+    out.patch_u32(start, static_cast<uint32_t>(out.size() - start - 4));
+}
+
+uint64_t handle_key(const NPCHandle& handle) {
+    return (static_cast<uint64_t>(handle.index) << 32) | handle.generation;
+}
+
+} // namespace
+
+void FrameEncoder::encode_keyframe(const WorldSnapshot& current, std::vector<uint8_t>& buffer) {
+    ByteWriter out(buffer);
+    size_t start = begin_frame(out, current.tick, FLAG_KEYFRAME);
+    size_t records_begin = out.size();
+    uint32_t records = 0;
+
+    for (const auto& npc : current.npcs) {
+        if (npc.alive) {
+            put_spawn(out, current, npc);
+            ++records;
+        }
+    }
+    finish_frame(out, start, records_begin, records);
+}
+
+void FrameEncoder::encode_delta(const WorldSnapshot& previous, const WorldSnapshot& current,
+                                std::vector<uint8_t>& buffer) {
+    ByteWriter out(buffer);
+    size_t start = begin_frame(out, current.tick, 0);
+    size_t records_begin = out.size();
+    uint32_t records = 0;
+
+    // Снимки читаются напрямую, без копирования состояния
+    std::unordered_map<uint64_t, const NPCState*> before;
+    before.reserve(previous.npcs.size());
+    for (const auto& npc : previous.npcs) {
+        if (npc.alive) {
+            before.emplace(handle_key(npc.handle), &npc);
+        }
+    }
+    std::unordered_set<uint64_t> after;
+    after.reserve(current.npcs.size());
+    for (const auto& npc : current.npcs) {
+        if (npc.alive) {
+            after.insert(handle_key(npc.handle));
+        }
+    }
+
+    // Гибели - первыми: слот, освобожденный и занятый заново между кадрами,
+    // читатель освобождает раньше, чем получает SPAWN нового владельца
+    for (const auto& npc : previous.npcs) {
+        if (npc.alive && !after.count(handle_key(npc.handle))) {
+            out.u8(static_cast<uint8_t>(RecordKind::DEATH));
+            out.varint(npc.handle.index);
+            ++records;
+        }
+    }
+
+    for (const auto& npc : current.npcs) {
+        if (!npc.alive) continue;
+
+        auto it = before.find(handle_key(npc.handle));
+        if (it == before.end()) {
+            put_spawn(out, current, npc);
+            ++records;
+            continue;
+        }
+
+        const NPCState& old = *it->second;
+        int dx = npc.position.get_x() - old.position.get_x();
+        int dy = npc.position.get_y() - old.position.get_y();
+        if (dx != 0 || dy != 0) {
+            out.u8(static_cast<uint8_t>(RecordKind::MOVE));
+            out.varint(npc.handle.index);
+            out.zigzag(dx);
+            out.zigzag(dy);
+            ++records;
+        }
+    }
+
+    finish_frame(out, start, records_begin, records);
+}
+
+FrameDecoder::FrameInfo FrameDecoder::apply(const uint8_t* data, size_t size) {
+    ByteReader reader(data, size, CORRUPTED);
+    if (reader.u32() != FrameEncoder::MAGIC) {
+        reader.fail("неверная сигнатура");
+    }
+    if (reader.u8() != FrameEncoder::VERSION) {
+        throw std::runtime_error("Неподдерживаемая версия кадра");
+    }
+
+    FrameInfo info;
+    uint8_t flags = reader.u8();
+    info.keyframe = (flags & FrameEncoder::FLAG_KEYFRAME) != 0;
+    info.tick = reader.varint();
+    uint32_t records = reader.u32();
+
+    if (info.keyframe) {
+        npcs.clear();
+    }
+
+    for (uint32_t i = 0; i < records; ++i) {
+        auto kind = static_cast<FrameEncoder::RecordKind>(reader.u8());
+        uint32_t id = static_cast<uint32_t>(reader.varint());
+
+        switch (kind) {
+        case FrameEncoder::RecordKind::SPAWN: {
+            DecodedNPC npc;
+            npc.generation = static_cast<uint32_t>(reader.varint());
+            npc.type = reader.string();
+            npc.name = reader.string();
+            npc.x = static_cast<int>(reader.zigzag());
+            npc.y = static_cast<int>(reader.zigzag());
+            npcs[id] = std::move(npc);
+            ++info.spawned;
+            break;
+        }
+        case FrameEncoder::RecordKind::MOVE: {
+            int dx = static_cast<int>(reader.zigzag());
+            int dy = static_cast<int>(reader.zigzag());
+            auto it = npcs.find(id);
+            if (it == npcs.end()) {
+                reader.fail("перемещение неизвестного NPC");
+            }
+            it->second.x += dx;
+            it->second.y += dy;
+            ++info.moved;
+            break;
+        }
+        case FrameEncoder::RecordKind::DEATH:
+            npcs.erase(id);
+            ++info.died;
+            break;
+        default:
+            reader.fail("неизвестный вид записи");
+        }
+    }
+
+    if (!reader.done()) {
+        reader.fail("лишние данные");
+    }
+    return info;
+}
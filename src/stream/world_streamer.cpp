@@ -0,0 +1,113 @@
+#include "../../include/stream/world_streamer.h"
+#include "../../include/stream/frame_codec.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+WorldStreamer::WorldStreamer(const std::string& socket_path) : path(socket_path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Слишком длинный путь сокета: " + path);
+    }
+
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error("Не удалось создать сокет: " + std::string(std::strerror(errno)));
+    }
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(path.c_str());
+
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listen_fd, 8) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(listen_fd);
+        throw std::runtime_error("Не удалось открыть сокет " + path + ": " + error);
+    }
+}
+
+WorldStreamer::~WorldStreamer() {
+    stop();
+    for (const auto& client : clients) {
+        ::close(client.fd);
+    }
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+}
+
+void WorldStreamer::accept_clients() {
+    while (true) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN - очередь подключений пуста
+        }
+        clients.push_back({fd, true});
+    }
+}
+
+bool WorldStreamer::send_frame(int fd, const std::vector<uint8_t>& frame) {
+    // Кадр уходит целиком или клиент считается медленным:
+    // частичная отправка сломала бы разбор потока
+    ssize_t sent = ::send(fd, frame.data(), frame.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    return sent == static_cast<ssize_t>(frame.size());
+}
+
+void WorldStreamer::publish(const std::shared_ptr<const WorldSnapshot>& snapshot) {
+    accept_clients();
+    if (!snapshot || snapshot == previous) {
+        clients_connected = clients.size();
+        return;
+    }
+
+    // Каждый кадр кодируется один раз для всех клиентов
+    delta_frame.clear();
+    key_frame.clear();
+    if (previous) {
+        FrameEncoder::encode_delta(*previous, *snapshot, delta_frame);
+    }
+
+    size_t kept = 0;
+    for (auto& client : clients) {
+        bool keyframe = client.needs_keyframe || !previous;
+        if (keyframe && key_frame.empty()) {
+            FrameEncoder::encode_keyframe(*snapshot, key_frame);
+        }
+
+        if (send_frame(client.fd, keyframe ? key_frame : delta_frame)) {
+            client.needs_keyframe = false;
+            clients[kept++] = client;
+            ++frames;
+        } else {
+            ::close(client.fd);
+            ++clients_dropped;
+        }
+    }
+    clients.resize(kept);
+    clients_connected = clients.size();
+
+    // Держим прошлый снимок до следующего кадра (RCU освободит его после)
+    previous = snapshot;
+}
+
+void WorldStreamer::start(SnapshotSource source, std::chrono::milliseconds poll_interval) {
+    stop();
+    running = true;
+    worker = std::thread([this, source = std::move(source), poll_interval]() {
+        while (running) {
+            publish(source());
+            std::this_thread::sleep_for(poll_interval);
+        }
+    });
+}
+
+void WorldStreamer::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
@@ -0,0 +1,79 @@
+#include "include/stream/frame_codec.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+bool read_exact(int fd, uint8_t* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = ::read(fd, buffer + done, size - done);
+        if (got <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+} // namespace
+
+// Читатель потока кадров: lab6_stream_reader <путь_сокета> [задержка_мс]
+// Задержка между кадрами имитирует медленного клиента
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Использование: " << argv[0] << " <путь_сокета> [задержка_мс]\n";
+        return 1;
+    }
+    int delay_ms = argc > 2 ? std::stoi(argv[2]) : 0;
+    
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "Не удалось подключиться к " << argv[1] << "\n";
+        return 1;
+    }
+    
+    FrameDecoder decoder;
+    std::vector<uint8_t> payload;
+    uint8_t length_bytes[4];
+    
+    while (read_exact(fd, length_bytes, sizeof(length_bytes))) {
+        uint32_t length = 0;
+        for (int i = 0; i < 4; ++i) {
+            length |= static_cast<uint32_t>(length_bytes[i]) << (8 * i);
+        }
+        payload.resize(length);
+        if (!read_exact(fd, payload.data(), length)) {
+            break;
+        }
+        
+        try {
+            auto info = decoder.apply(payload.data(), payload.size());
+            std::cout << (info.keyframe ? "[K] " : "[D] ") << "тик " << info.tick
+                      << ": +" << info.spawned << " ~" << info.moved << " -" << info.died
+                      << ", живых " << decoder.state().size() << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка кадра: " << e.what() << "\n";
+            break;
+        }
+        
+        if (delay_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        }
+    }
+    
+    std::cout << "Поток завершен\n";
+    ::close(fd);
+    return 0;
+}
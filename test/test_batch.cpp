@@ -0,0 +1,67 @@
+#include "../include/batch/batch_runner.h"
+#include "../include/batch/work_stealing_pool.h"
+#include "../include/game/game.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+TEST(WorkStealingPoolTest, RunsEveryTaskOnce) {
+    WorkStealingPool pool(4);
+    const size_t task_count = 1000;
+    std::vector<std::atomic<int>> hits(task_count);
+    
+    pool.run(task_count, [&hits](size_t task, size_t worker) {
+        EXPECT_LT(worker, 4u);
+        hits[task].fetch_add(1);
+    });
+    
+    for (const auto& hit : hits) {
+        EXPECT_EQ(hit.load(), 1);
+    }
+}
+
+TEST(WorkStealingPoolTest, ZeroTasks) {
+    WorkStealingPool pool(2);
+    int calls = 0;
+    pool.run(0, [&calls](size_t, size_t) { ++calls; });
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(GameHeadlessTest, SameSeedSameResult) {
+    Game first(42, true);
+    Game second(42, true);
+    
+    first.run_headless(Game::GAME_DURATION_SECONDS);
+    second.run_headless(Game::GAME_DURATION_SECONDS);
+    
+    EXPECT_EQ(first.get_survivors(), second.get_survivors());
+    EXPECT_EQ(first.snapshot()->tick, static_cast<uint64_t>(Game::GAME_DURATION_SECONDS));
+}
+
+TEST(BatchRunnerTest, SummaryIsConsistent) {
+    const size_t runs = 64;
+    BatchRunner runner(4);
+    BatchSummary summary = runner.run(runs, 7, 10);
+    
+    EXPECT_EQ(summary.runs, runs);
+    
+    // Каждый NPC либо выжил, либо убит ровно один раз
+    uint64_t survivors = 0;
+    for (const auto& [type, count] : summary.survivors) survivors += count;
+    uint64_t kills = 0;
+    for (const auto& [pair, count] : summary.kills) kills += count;
+    EXPECT_EQ(survivors + kills, runs * Game::NUM_NPCS);
+    
+    // Белки никого не убивают
+    for (const auto& [pair, count] : summary.kills) {
+        EXPECT_NE(pair.first, "Белка");
+    }
+}
+
+TEST(BatchRunnerTest, ThreadCountDoesNotChangeResult) {
+    BatchSummary single = BatchRunner(1).run(32, 100, 10);
+    BatchSummary multi = BatchRunner(4).run(32, 100, 10);
+    
+    EXPECT_EQ(single.survivors, multi.survivors);
+    EXPECT_EQ(single.kills, multi.kills);
+}
@@ -0,0 +1,187 @@
+#include "../include/behavior/behavior_scheduler.h"
+#include "../include/behavior/behaviors.h"
+#include "../include/game/game.h"
+#include "../include/npc/orc.h"
+#include "../include/npc/squirrel.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Открытая карта 100x100 без рельефа; цели - указатели на NPC теста
+class TestWorld : public BehaviorWorld {
+public:
+    std::vector<NPC*> targets; // индекс дескриптора - позиция в списке
+
+    void step(NPC& npc, int dx, int dy) override { npc.move(dx, dy, 100, 100); }
+
+    std::optional<Point> locate(NPCHandle target) const override {
+        if (target.index >= targets.size() || !targets[target.index]->is_alive()) {
+            return std::nullopt;
+        }
+        return targets[target.index]->get_position();
+    }
+};
+
+BehaviorTask record_ticks(const BehaviorScheduler& scheduler, std::vector<uint64_t>& ticks) {
+    ticks.push_back(scheduler.now());
+    co_await wait_ticks{3};
+    ticks.push_back(scheduler.now());
+    co_await wait_ticks{BehaviorScheduler::WHEEL_SLOTS + 44}; // дольше оборота колеса
+    ticks.push_back(scheduler.now());
+}
+
+BehaviorTask failing_child(int& steps) {
+    ++steps;
+    co_await wait_ticks{2};
+    throw std::runtime_error("сценарий сломан");
+}
+
+BehaviorTask failing_parent(int& steps) {
+    co_await failing_child(steps);
+    ++steps; // не выполняется: ошибка вложенного сценария пробрасывается
+}
+
+BehaviorTask idle_forever() {
+    while (true) {
+        co_await wait_ticks{10};
+    }
+}
+
+} // namespace
+
+TEST(BehaviorSchedulerTest, ResumesOnlyWhenDue) {
+    BehaviorScheduler scheduler;
+    std::vector<uint64_t> ticks;
+    scheduler.spawn(0, record_ticks(scheduler, ticks));
+
+    for (int i = 0; i < 400; ++i) {
+        scheduler.advance();
+    }
+    EXPECT_EQ(ticks, (std::vector<uint64_t>{1, 4, 4 + BehaviorScheduler::WHEEL_SLOTS + 44}));
+    EXPECT_EQ(scheduler.resumptions(), 3u);
+    EXPECT_EQ(scheduler.active(), 0u);
+}
+
+TEST(BehaviorSchedulerTest, WaitingTasksCostNothing) {
+    BehaviorScheduler scheduler;
+    for (uint32_t key = 0; key < 1000; ++key) {
+        scheduler.spawn(key, idle_forever());
+    }
+    scheduler.advance(); // первый шаг каждого
+    EXPECT_EQ(scheduler.last_resumed().size(), 1000u);
+    for (int i = 0; i < 9; ++i) {
+        scheduler.advance();
+        EXPECT_TRUE(scheduler.last_resumed().empty());
+    }
+    scheduler.advance();
+    EXPECT_EQ(scheduler.last_resumed().size(), 1000u);
+    EXPECT_EQ(scheduler.resumptions(), 2000u);
+}
+
+TEST(BehaviorSchedulerTest, NestedErrorRemovesTask) {
+    BehaviorScheduler scheduler;
+    int steps = 0;
+    scheduler.spawn(5, failing_parent(steps));
+    scheduler.advance();
+    scheduler.advance();
+    EXPECT_THROW(scheduler.advance(), std::runtime_error);
+    EXPECT_EQ(steps, 1);
+    EXPECT_FALSE(scheduler.has_task(5));
+}
+
+TEST(BehaviorSchedulerTest, CancelReturnsFramesToPool) {
+    size_t before = FramePool::instance().frames_in_use();
+    {
+        BehaviorScheduler scheduler;
+        Squirrel squirrel("Белка_1", Point(0, 0));
+        TestWorld world;
+        for (uint32_t key = 0; key < 100; ++key) {
+            scheduler.spawn(key, patrol(world, squirrel, Point(0, 0), Point(50, 0), 1));
+        }
+        scheduler.advance();
+        scheduler.advance();
+        EXPECT_GT(FramePool::instance().frames_in_use(), before + 100); // корни и вложенные walk_to
+        scheduler.cancel(7);
+        EXPECT_FALSE(scheduler.has_task(7));
+        EXPECT_EQ(scheduler.active(), 99u);
+    }
+    EXPECT_EQ(FramePool::instance().frames_in_use(), before);
+}
+
+TEST(BehaviorsTest, PatrolWalksBetweenPoints) {
+    BehaviorScheduler scheduler;
+    TestWorld world;
+    Squirrel squirrel("Белка_1", Point(0, 0));
+    scheduler.spawn(0, patrol(world, squirrel, Point(20, 0), Point(20, 10), 2, 1));
+
+    std::vector<Point> path;
+    while (scheduler.has_task(0)) {
+        scheduler.advance();
+        path.push_back(squirrel.get_position());
+    }
+    // 4 шага по 5 клеток до a, пауза, 2 шага до b, пауза
+    ASSERT_GE(path.size(), 8u);
+    EXPECT_EQ(path[3].get_x(), 20);
+    EXPECT_EQ(path[3].get_y(), 0);
+    EXPECT_EQ(path.back().get_x(), 20);
+    EXPECT_EQ(path.back().get_y(), 10);
+}
+
+TEST(BehaviorsTest, SentryWaitsPatrolsThenChases) {
+    BehaviorScheduler scheduler;
+    TestWorld world;
+    Orc orc("Орк_1", Point(0, 0));
+    Squirrel prey("Белка_1", Point(90, 90));
+    world.targets.push_back(&prey);
+    scheduler.spawn(0, sentry(world, orc, 3, Point(10, 0), Point(0, 0), NPCHandle{0, 0}, 100));
+
+    for (int i = 0; i < 3; ++i) scheduler.advance();
+    EXPECT_EQ(orc.get_position().get_x(), 0); // ждет
+
+    for (int i = 0; i < 30; ++i) scheduler.advance();
+    EXPECT_TRUE(orc.get_position().within(prey.get_position(), orc.get_kill_distance()));
+
+    prey.kill();
+    scheduler.advance();
+    scheduler.advance();
+    EXPECT_FALSE(scheduler.has_task(0)); // цель погибла - сценарий закончился
+}
+
+TEST(GameBehaviorTest, ScriptsReplaceRandomWalkAndEndWithNPC) {
+    Game game(5, true);
+    NPCHandle walker = game.spawn("Белка", "Белка_патруль", Point(0, 0));
+    game.attach_behavior(walker, [](BehaviorWorld& world, NPC& self) {
+        return patrol(world, self, Point(10, 0), Point(10, 10), 1);
+    });
+    EXPECT_THROW(game.attach_behavior(NPCHandle{}, [](BehaviorWorld& world, NPC& self) {
+        return walk_to(world, self, Point(0, 0));
+    }), std::invalid_argument);
+
+    game.step();
+    game.step();
+    auto find = [&game](NPCHandle handle) {
+        for (const auto& npc : game.snapshot()->npcs) {
+            if (npc.handle.index == handle.index && npc.handle.generation == handle.generation) return npc;
+        }
+        return NPCState{};
+    };
+    NPCState state = find(walker);
+    if (state.alive) {
+        EXPECT_EQ(state.position.get_x(), 10);
+        EXPECT_EQ(state.position.get_y(), 0);
+    }
+
+    // Сценарий у каждого живого; погибшие теряют сценарий
+    for (const auto& npc : game.snapshot()->npcs) {
+        if (npc.alive && npc.handle.index != walker.index) {
+            game.attach_behavior(npc.handle, [](BehaviorWorld& world, NPC& self) {
+                return patrol(world, self, Point(0, 0), Point(49, 49), 0);
+            });
+        }
+    }
+    game.run_headless(40);
+    EXPECT_LT(game.population().alive(), static_cast<size_t>(Game::NUM_NPCS) + 1);
+    EXPECT_EQ(game.behavior_count(), game.population().alive());
+}
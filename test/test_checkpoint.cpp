@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+#include "../include/game/game.h"
+#include "../include/game/checkpoint.h"
+#include "../include/game/terrain.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void expect_same_world(const WorldSnapshot& expected, const WorldSnapshot& actual) {
+    EXPECT_EQ(expected.tick, actual.tick);
+    ASSERT_EQ(expected.npcs.size(), actual.npcs.size());
+    for (size_t i = 0; i < expected.npcs.size(); ++i) {
+        const NPCState& a = expected.npcs[i];
+        const NPCState& b = actual.npcs[i];
+        EXPECT_EQ(a.handle, b.handle) << "NPC " << i;
+        EXPECT_EQ(WorldSnapshot::name_of(a), WorldSnapshot::name_of(b)) << "NPC " << i;
+        EXPECT_EQ(a.type, b.type) << "NPC " << i;
+        EXPECT_EQ(a.position.get_x(), b.position.get_x()) << "NPC " << i;
+        EXPECT_EQ(a.position.get_y(), b.position.get_y()) << "NPC " << i;
+        EXPECT_EQ(a.alive, b.alive) << "NPC " << i;
+    }
+}
+
+// Тик с возвращением погибших: хвост хранилища и свободные слоты непусты
+void step_with_respawns(Game& game) {
+    game.step();
+    uint64_t tick = game.snapshot()->tick;
+    size_t alive = game.snapshot()->alive_count();
+    for (size_t i = alive; i < Game::NUM_NPCS; ++i) {
+        game.spawn(i % 2 ? "Орк" : "Белка", "Новичок_" + std::to_string(tick) + "_" + std::to_string(i),
+                   Point(static_cast<int>(i % 50), static_cast<int>(tick % 50)));
+    }
+}
+
+// Режим игры, задаваемый одинаково эталону, прерванному и продолженному прогонам
+struct ResumeMode {
+    const char* name;
+    std::function<void(Game&)> configure;
+};
+
+// Стена поперек карты с проходом: рельеф меняет шаги, но не запирает NPC
+TerrainMap wall_with_gap() {
+    TerrainMap map(Game::MAP_WIDTH, Game::MAP_HEIGHT);
+    map.fill_rect(25, 0, 25, Game::MAP_HEIGHT - 11, TerrainMap::Cell::WALL);
+    return map;
+}
+
+class CheckpointResumeTest : public ::testing::TestWithParam<ResumeMode> {};
+
+} // namespace
+
+TEST_P(CheckpointResumeTest, ResumeMatchesUninterruptedRun) {
+    const int TOTAL = 60;
+    const std::string path = std::string("test_resume_") + GetParam().name + ".ckpt";
+    
+    Game reference(11, true);
+    GetParam().configure(reference);
+    reference.run_headless(TOTAL);
+    
+    for (int split : {0, 7, 33}) {
+        Game first(11, true);
+        GetParam().configure(first);
+        first.run_headless(split);
+        first.save_checkpoint(path);
+        
+        Game resumed(999, true); // другое зерно - все состояние из точки
+        GetParam().configure(resumed);
+        resumed.load_checkpoint(path);
+        resumed.run_headless(TOTAL - split);
+        
+        expect_same_world(*reference.snapshot(), *resumed.snapshot());
+        EXPECT_EQ(reference.get_survivors(), resumed.get_survivors());
+        EXPECT_EQ(reference.pair_filter_stats().pushed, resumed.pair_filter_stats().pushed);
+        EXPECT_EQ(reference.pair_filter_stats().candidates, resumed.pair_filter_stats().candidates);
+    }
+    std::remove(path.c_str());
+}
+
+// Новый режим движения добавляет сюда свою настройку
+INSTANTIATE_TEST_SUITE_P(
+    Modes, CheckpointResumeTest,
+    ::testing::Values(
+        ResumeMode{"Default", [](Game&) {}},
+        ResumeMode{"TypeBuckets", [](Game& game) { game.set_type_buckets(true); }},
+        ResumeMode{"Terrain", [](Game& game) { game.set_terrain(wall_with_gap()); }},
+        ResumeMode{"FlowMovement", [](Game& game) { game.set_flow_movement(true, 4); }},
+        ResumeMode{"BucketsTerrainFlow",
+                   [](Game& game) {
+                       game.set_type_buckets(true);
+                       game.set_terrain(wall_with_gap());
+                       game.set_flow_movement(true, 4);
+                   }},
+        ResumeMode{"LevelOfDetail", [](Game& game) { game.set_level_of_detail(true); }},
+        ResumeMode{"BucketsTerrainLevelOfDetail",
+                   [](Game& game) {
+                       game.set_type_buckets(true);
+                       game.set_terrain(wall_with_gap());
+                       game.set_level_of_detail(true);
+                   }}),
+    [](const ::testing::TestParamInfo<ResumeMode>& info) { return std::string(info.param.name); });
+
+// Поля направлений между пересчетами строятся по позициям последнего пересчета из точки
+TEST(CheckpointTest, ResumeWithFlowMovementBetweenRebuilds) {
+    const int TOTAL = 60;
+    const std::string path = "test_resume_flow.ckpt";
+    
+    Game reference(11, true);
+    reference.set_flow_movement(true, 4);
+    reference.run_headless(TOTAL);
+    
+    for (int split : {7, 33}) { // не на границе пересчета
+        Game first(11, true);
+        first.set_flow_movement(true, 4);
+        first.run_headless(split);
+        first.save_checkpoint(path);
+        
+        Game resumed(999, true);
+        if (split == 7) {
+            resumed.set_flow_movement(true, 4);
+            resumed.load_checkpoint(path);
+        } else {
+            resumed.load_checkpoint(path); // настройка после загрузки - тоже точно
+            resumed.set_flow_movement(true, 4);
+        }
+        resumed.run_headless(TOTAL - split);
+        
+        expect_same_world(*reference.snapshot(), *resumed.snapshot());
+    }
+    std::remove(path.c_str());
+}
+
+// Окна спокойных NPC, начатые до точки, продолжаются после загрузки
+TEST(CheckpointTest, ResumeWithLevelOfDetailMidWindow) {
+    const int TOTAL = 60;
+    const std::string path = "test_resume_lod.ckpt";
+    
+    Game reference(11, true);
+    reference.set_level_of_detail(true);
+    for (int tick = 0; tick < TOTAL; ++tick) {
+        step_with_respawns(reference);
+    }
+    ASSERT_GT(reference.level_of_detail_stats().skipped, 0u);
+    
+    for (int split : {7, 33}) { // не кратны LOD_MAX_PERIOD
+        Game first(11, true);
+        first.set_level_of_detail(true);
+        for (int tick = 0; tick < split; ++tick) {
+            step_with_respawns(first);
+        }
+        first.save_checkpoint(path);
+        
+        Game resumed(999, true);
+        if (split == 7) {
+            resumed.set_level_of_detail(true);
+            resumed.load_checkpoint(path);
+        } else {
+            resumed.load_checkpoint(path);
+            resumed.set_level_of_detail(true);
+        }
+        for (int tick = split; tick < TOTAL; ++tick) {
+            step_with_respawns(resumed);
+        }
+        
+        expect_same_world(*reference.snapshot(), *resumed.snapshot());
+        for (const auto& npc : reference.snapshot()->npcs) {
+            EXPECT_EQ(reference.update_period(npc.handle), resumed.update_period(npc.handle)) << *npc.name;
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, ResumeKeepsHandlesAndRetainedDead) {
+    const std::string path = "test_resume_spawn.ckpt";
+    
+    Game reference(5, true);
+    for (int tick = 0; tick < 80; ++tick) {
+        step_with_respawns(reference);
+    }
+    
+    Game first(5, true);
+    for (int tick = 0; tick < 35; ++tick) {
+        step_with_respawns(first);
+    }
+    first.save_checkpoint(path);
+    
+    Game resumed(1, true);
+    resumed.load_checkpoint(path);
+    EXPECT_EQ(first.storage_size(), resumed.storage_size());
+    EXPECT_EQ(first.retained_size(), resumed.retained_size());
+    for (int tick = 35; tick < 80; ++tick) {
+        step_with_respawns(resumed);
+    }
+    
+    expect_same_world(*reference.snapshot(), *resumed.snapshot());
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, EncodeDecodeRoundTrip) {
+    Game game(3, true);
+    game.run_headless(10);
+    GameCheckpoint checkpoint = game.capture_checkpoint();
+    checkpoint.pending.push_back({NPCHandle{1, 0}, NPCHandle{2, 3}, Point(4, 5)});
+    
+    std::vector<uint8_t> buffer;
+    checkpoint.encode(buffer);
+    GameCheckpoint decoded = GameCheckpoint::decode(buffer.data(), buffer.size());
+    
+    EXPECT_EQ(decoded.tick, checkpoint.tick);
+    EXPECT_EQ(decoded.types, checkpoint.types);
+    EXPECT_EQ(decoded.movement_rng, checkpoint.movement_rng);
+    EXPECT_EQ(decoded.battle_rng, checkpoint.battle_rng);
+    EXPECT_EQ(decoded.slot_generations, checkpoint.slot_generations);
+    EXPECT_EQ(decoded.free_slots, checkpoint.free_slots);
+    EXPECT_EQ(decoded.active_count, checkpoint.active_count);
+    ASSERT_EQ(decoded.npcs.size(), checkpoint.npcs.size());
+    for (size_t i = 0; i < decoded.npcs.size(); ++i) {
+        EXPECT_EQ(decoded.npcs[i].handle, checkpoint.npcs[i].handle);
+        EXPECT_EQ(decoded.npcs[i].name, checkpoint.npcs[i].name);
+        EXPECT_EQ(decoded.npcs[i].alive, checkpoint.npcs[i].alive);
+    }
+    ASSERT_EQ(decoded.pending.size(), 1u);
+    EXPECT_EQ(decoded.pending[0].target, (NPCHandle{2, 3}));
+    EXPECT_EQ(decoded.pending[0].location.get_y(), 5);
+    
+    // Бинарный формат компактнее текстового сохранения имен и координат
+    EXPECT_LT(buffer.size(), checkpoint.npcs.size() * 40 + 1024);
+}
+
+TEST(CheckpointTest, CorruptedCheckpointThrows) {
+    const std::string path = "test_corrupted.ckpt";
+    Game game(3, true);
+    game.run_headless(5);
+    game.save_checkpoint(path);
+    
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes[bytes.size() / 2] ^= 0x5A;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    
+    Game other(4, true);
+    EXPECT_THROW(other.load_checkpoint(path), std::runtime_error);
+    EXPECT_THROW(other.load_checkpoint("no_such_checkpoint.ckpt"), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, PeriodicCheckpointsDuringThreadedRun) {
+    const std::string path = "test_periodic.ckpt";
+    std::remove(path.c_str());
+    
+    Game game(8, true);
+    game.set_timing(std::chrono::milliseconds(5), std::chrono::milliseconds(300));
+    game.set_checkpointing(path, 3);
+    game.start();
+    
+    GameCheckpoint checkpoint = GameCheckpoint::load(path);
+    EXPECT_GT(checkpoint.tick, 0u);
+    
+    Game resumed(9, true);
+    resumed.restore_checkpoint(checkpoint);
+    EXPECT_EQ(resumed.snapshot()->tick, checkpoint.tick);
+    resumed.run_headless(5);
+    std::remove(path.c_str());
+}
+
+// Точки, снятые на ходу, согласованы: снимок, генераторы и ожидающие бои одного момента
+TEST(CheckpointTest, CapturesDuringThreadedRunRestore) {
+    Game game(12, true);
+    game.set_timing(std::chrono::milliseconds(2), std::chrono::milliseconds(200));
+    
+    std::vector<GameCheckpoint> captured;
+    std::atomic<bool> finished{false};
+    std::thread capturer([&]() {
+        while (!finished) {
+            captured.push_back(game.capture_checkpoint());
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+    game.start();
+    finished = true;
+    capturer.join();
+    
+    ASSERT_FALSE(captured.empty());
+    for (const auto& checkpoint : captured) {
+        Game resumed(1, true);
+        ASSERT_NO_THROW(resumed.restore_checkpoint(checkpoint));
+        EXPECT_EQ(resumed.snapshot()->tick, checkpoint.tick);
+        size_t alive = 0;
+        for (const auto& record : checkpoint.npcs) {
+            alive += record.alive ? 1 : 0;
+        }
+        EXPECT_EQ(resumed.population().alive(), alive);
+        resumed.run_headless(2);
+    }
+}
@@ -0,0 +1,126 @@
+#include "../include/game/contact_tracker.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST(ContactTrackerTest, SimpleContacts) {
+    ContactTracker tracker(50, 50, 10);
+    tracker.update(0, Point(0, 0), 10);
+    tracker.update(1, Point(6, 8), 5);   // расстояние 10 <= max(10, 5)
+    tracker.update(2, Point(40, 40), 5);
+    tracker.refresh();
+    
+    auto contacts = tracker.contacts();
+    ASSERT_EQ(contacts.size(), 1u);
+    EXPECT_EQ(contacts[0], std::make_pair(0u, 1u));
+}
+
+TEST(ContactTrackerTest, RemoveDropsContacts) {
+    ContactTracker tracker(50, 50, 10);
+    tracker.update(0, Point(10, 10), 10);
+    tracker.update(1, Point(12, 12), 10);
+    tracker.update(2, Point(14, 14), 10);
+    tracker.refresh();
+    EXPECT_EQ(tracker.contacts().size(), 3u);
+    
+    tracker.remove(1);
+    EXPECT_EQ(tracker.contacts().size(), 1u);
+    EXPECT_EQ(tracker.contacts(), tracker.brute_force_contacts());
+}
+
+TEST(ContactTrackerTest, NearVisitsCoveringCellsOnly) {
+    ContactTracker tracker(100, 100, 10);
+    tracker.update(0, Point(5, 5), 10);
+    tracker.update(1, Point(19, 12), 10);  // соседняя ячейка
+    tracker.update(2, Point(95, 95), 10);
+    tracker.update(3, Point(8, 2), 10);
+    tracker.remove(3);
+    
+    std::vector<uint32_t> near;
+    tracker.for_each_near(Point(4, 4), 10, [&](uint32_t id) { near.push_back(id); });
+    std::sort(near.begin(), near.end());
+    EXPECT_EQ(near, (std::vector<uint32_t>{0, 1}));
+    
+    near.clear();
+    tracker.for_each_near(Point(99, 99), 0, [&](uint32_t id) { near.push_back(id); });
+    EXPECT_EQ(near, (std::vector<uint32_t>{2}));
+}
+
+TEST(ContactTrackerTest, StationaryEntitiesAreNotRechecked) {
+    ContactTracker tracker(100, 100, 10);
+    for (uint32_t id = 0; id < 20; ++id) {
+        tracker.update(id, Point(id * 5 % 100, id * 7 % 100), 10);
+    }
+    tracker.refresh();
+    EXPECT_EQ(tracker.last_dirty_count(), 20u);
+    
+    // Те же положения - ничего не пересчитывается
+    for (uint32_t id = 0; id < 20; ++id) {
+        tracker.update(id, Point(id * 5 % 100, id * 7 % 100), 10);
+    }
+    tracker.refresh();
+    EXPECT_EQ(tracker.last_dirty_count(), 0u);
+    EXPECT_EQ(tracker.last_pair_checks(), 0u);
+    
+    tracker.update(3, Point(50, 50), 10);
+    tracker.refresh();
+    EXPECT_EQ(tracker.last_dirty_count(), 1u);
+    EXPECT_EQ(tracker.contacts(), tracker.brute_force_contacts());
+}
+
+// Стенд эквивалентности: случайные блуждания, часть сущностей стоит,
+// появляются и исчезают; после каждого тика контакты равны полному перебору
+TEST(ContactTrackerTest, IncrementalMatchesFullRebuild) {
+    const int width = 200;
+    const int height = 120;
+    const uint32_t count = 300;
+    ContactTracker tracker(width, height, 10);
+    
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> x_dist(0, width - 1);
+    std::uniform_int_distribution<int> y_dist(0, height - 1);
+    std::uniform_int_distribution<int> step(-10, 10);
+    std::uniform_int_distribution<int> reach_dist(0, 2);
+    std::uniform_int_distribution<int> percent(0, 99);
+    const int reaches[] = {5, 10, 10};
+    
+    std::vector<Point> positions(count);
+    std::vector<int> reach(count);
+    std::vector<bool> present(count, true);
+    for (uint32_t id = 0; id < count; ++id) {
+        positions[id] = Point(x_dist(rng), y_dist(rng));
+        reach[id] = reaches[reach_dist(rng)];
+        tracker.update(id, positions[id], reach[id]);
+    }
+    tracker.refresh();
+    ASSERT_EQ(tracker.contacts(), tracker.brute_force_contacts());
+    
+    for (int tick = 0; tick < 100; ++tick) {
+        for (uint32_t id = 0; id < count; ++id) {
+            int roll = percent(rng);
+            if (!present[id]) {
+                if (roll < 10) {
+                    present[id] = true;
+                    positions[id] = Point(x_dist(rng), y_dist(rng));
+                    tracker.update(id, positions[id], reach[id]);
+                }
+                continue;
+            }
+            if (roll < 3) {
+                present[id] = false;
+                tracker.remove(id);
+            } else if (roll < 50) {
+                // Стоит на месте
+                tracker.update(id, positions[id], reach[id]);
+            } else {
+                int nx = std::clamp(positions[id].get_x() + step(rng), 0, width - 1);
+                int ny = std::clamp(positions[id].get_y() + step(rng), 0, height - 1);
+                positions[id] = Point(nx, ny);
+                tracker.update(id, positions[id], reach[id]);
+            }
+        }
+        tracker.refresh();
+        ASSERT_EQ(tracker.contacts(), tracker.brute_force_contacts()) << "тик " << tick;
+    }
+}
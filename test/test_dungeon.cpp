@@ -1,4 +1,5 @@
 #include "../include/dungeon/dungeon.h"
+#include "../include/npc/npc.h"
 #include "../include/geometry/point.h"
 #include <gtest/gtest.h>
 #include <memory>
@@ -131,3 +132,73 @@ TEST_F(DungeonEditorTest, LoadFromNonExistentFile) {
     EXPECT_TRUE(output.find("Ошибка при загрузке") != std::string::npos);
 }
 
+
+TEST_F(DungeonEditorTest, SpatialQueries) {
+    testing::internal::CaptureStdout();
+    editor.add_npc("Орк", "Орк1", 10, 10);
+    editor.add_npc("Орк", "Орк2", 12, 11);
+    editor.add_npc("Белка", "Белка1", 15, 10);
+    editor.add_npc("Друид", "Друид1", 100, 100);
+    testing::internal::GetCapturedStdout();
+    
+    auto in_rect = editor.find_in_rect(0, 0, 20, 20);
+    EXPECT_EQ(in_rect.size(), 3u);
+    for (const NPC* npc : in_rect) {
+        EXPECT_LE(npc->get_position().get_x(), 20);
+    }
+    
+    auto nearest = editor.find_nearest(99, 99, 2);
+    ASSERT_EQ(nearest.size(), 2u);
+    EXPECT_EQ(nearest[0]->get_name(), "Друид1");
+    EXPECT_EQ(nearest[1]->get_name(), "Белка1");
+    
+    auto counts = editor.count_by_type_in_radius(11, 10, 4.0);
+    EXPECT_EQ(counts["Орк"], 2u);
+    EXPECT_EQ(counts["Белка"], 1u);
+    EXPECT_EQ(counts.count("Друид"), 0u);
+}
+
+TEST_F(DungeonEditorTest, SpatialIndexFollowsBattlesAndLoads) {
+    testing::internal::CaptureStdout();
+    for (int i = 0; i < 30; ++i) {
+        editor.add_npc(i % 3 == 0 ? "Орк" : (i % 3 == 1 ? "Друид" : "Белка"),
+                       "NPC" + std::to_string(i), i % 6, i / 6);
+    }
+    editor.start_battle(50.0);
+    testing::internal::GetCapturedStdout();
+    
+    // Индекс содержит ровно оставшихся живых
+    auto all = editor.find_in_rect(-1000, -1000, 1000, 1000);
+    EXPECT_EQ(all.size(), editor.get_alive_count());
+    for (const NPC* npc : all) {
+        EXPECT_TRUE(npc->is_alive());
+        EXPECT_TRUE(editor.is_name_exists(npc->get_name()));
+    }
+    
+    testing::internal::CaptureStdout();
+    editor.save_to_file("test_save.txt");
+    DungeonEditor loaded;
+    loaded.load_from_file("test_save.txt");
+    testing::internal::GetCapturedStdout();
+    EXPECT_EQ(loaded.find_nearest(0, 0, 1000).size(), editor.get_alive_count());
+}
+
+TEST_F(DungeonEditorTest, PopulationCountersFollowBattles) {
+    testing::internal::CaptureStdout();
+    editor.add_npc("Орк", "Орк1", 0, 0);
+    editor.add_npc("Друид", "Друид1", 1, 1);
+    editor.add_npc("Белка", "Белка1", 2, 2);
+    editor.add_npc("Белка", "Белка2", 500, 500);
+    EXPECT_EQ(editor.population().alive_of("Белка"), 2u);
+    
+    editor.start_battle(10.0);
+    testing::internal::GetCapturedStdout();
+    
+    size_t alive = 0;
+    for (const auto& type : editor.population().types()) {
+        alive += editor.population().alive_of(type);
+    }
+    EXPECT_EQ(alive, editor.get_alive_count());
+    EXPECT_EQ(editor.find_in_rect(-1000, -1000, 1000, 1000).size(), editor.get_alive_count());
+    EXPECT_LT(editor.get_alive_count(), 4u);
+}
@@ -1,12 +1,17 @@
 #include "../include/npc/npc_factory.h"
+#include "../include/npc/npc_archive.h"
 #include "../include/npc/druid.h"
 #include "../include/npc/orc.h"
 #include "../include/npc/squirrel.h"
 #include "../include/geometry/point.h"
 #include <gtest/gtest.h>
+#include <cstring>
 #include <memory>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <random>
+#include <tuple>
 
 TEST(NPCFactoryTest, CreateDruid) {
     NPCFactory factory;
@@ -106,6 +111,7 @@ protected:
         cleanupFile("empty.txt");
         cleanupFile("special_names.txt");
         cleanupFile("output.txt");
+        cleanupFile("output.npcz");
     }
     
     void createTestFile(const std::string& filename, const std::vector<std::string>& lines) {
@@ -351,3 +357,214 @@ TEST(NPCFactoryTest, CreateMultipleNPCs) {
     EXPECT_EQ(squirrel->get_type(), "Белка");
 }
 
+
+namespace {
+
+using NPCRecord = std::tuple<std::string, std::string, int, int>;
+
+// Сжатое сохранение меняет порядок NPC, сравниваем отсортированные записи
+std::vector<NPCRecord> records_of(const std::vector<std::unique_ptr<NPC>>& npcs, bool alive_only) {
+    std::vector<NPCRecord> records;
+    for (const auto& npc : npcs) {
+        if (alive_only && !npc->is_alive()) continue;
+        records.emplace_back(npc->get_name(), npc->get_type(),
+                             npc->get_position().get_x(), npc->get_position().get_y());
+    }
+    std::sort(records.begin(), records.end());
+    return records;
+}
+
+std::vector<std::unique_ptr<NPC>> random_npcs(const NPCFactory& factory, size_t count) {
+    auto types = factory.get_types();
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> coord(-500, 1500);
+    std::vector<std::unique_ptr<NPC>> npcs;
+    for (size_t i = 0; i < count; ++i) {
+        const std::string& type = types[i % types.size()];
+        npcs.push_back(factory.create(type, type + "_" + std::to_string(rng() % 10000),
+                                      Point(coord(rng), coord(rng))));
+    }
+    return npcs;
+}
+
+} // namespace
+
+TEST(BlockCodecTest, RoundTrip) {
+    std::mt19937 rng(3);
+    std::vector<uint8_t> repetitive;
+    for (int i = 0; i < 100000; ++i) {
+        repetitive.push_back(static_cast<uint8_t>("Орк_Друид_Белка"[i % 20] + (i / 5000)));
+    }
+    std::vector<uint8_t> noise(70000);
+    for (auto& byte : noise) byte = static_cast<uint8_t>(rng());
+    
+    for (const auto& input : {repetitive, noise, std::vector<uint8_t>{}, std::vector<uint8_t>{42}}) {
+        for (auto kind : {BlockCodec::Kind::NONE, BlockCodec::Kind::LZ, BlockCodec::Kind::ZSTD}) {
+            if (!BlockCodec::is_available(kind)) continue;
+            std::vector<uint8_t> packed;
+            BlockCodec::compress(kind, input.data(), input.size(), packed);
+            EXPECT_LE(packed.size(), BlockCodec::max_compressed_size(kind, input.size()));
+            
+            std::vector<uint8_t> unpacked(input.size());
+            BlockCodec::decompress(kind, packed.data(), packed.size(), unpacked.data(), unpacked.size());
+            EXPECT_EQ(unpacked, input);
+        }
+    }
+    
+    std::vector<uint8_t> packed;
+    BlockCodec::compress(BlockCodec::Kind::LZ, repetitive.data(), repetitive.size(), packed);
+    EXPECT_LT(packed.size() * 10, repetitive.size());
+}
+
+TEST_F(NPCFactoryFileTest, CompressedSaveRoundTrip) {
+    auto npcs = random_npcs(factory, 20000); // несколько блоков
+    npcs[5]->kill();
+    npcs[777]->kill();
+    
+    factory.save_compressed("output.npcz", npcs);
+    auto loaded = factory.load_compressed("output.npcz", 4);
+    
+    EXPECT_EQ(loaded.size(), npcs.size() - 2);
+    EXPECT_EQ(records_of(loaded, false), records_of(npcs, true));
+    EXPECT_EQ(records_of(factory.load_compressed("output.npcz", 1), false), records_of(loaded, false));
+}
+
+TEST_F(NPCFactoryFileTest, CompressedSaveIsSmallerThanText) {
+    auto npcs = random_npcs(factory, 5000);
+    factory.save_to_file("output.txt", npcs);
+    factory.save_compressed("output.npcz", npcs);
+    EXPECT_LT(std::filesystem::file_size("output.npcz") * 2, std::filesystem::file_size("output.txt"));
+    
+    // Без сжатия формат тоже читается
+    factory.save_compressed("output.npcz", npcs, BlockCodec::Kind::NONE);
+    EXPECT_EQ(records_of(factory.load_compressed("output.npcz"), false), records_of(npcs, true));
+}
+
+TEST_F(NPCFactoryFileTest, CompressedSaveEmpty) {
+    factory.save_compressed("output.npcz", {});
+    EXPECT_TRUE(factory.load_compressed("output.npcz").empty());
+}
+
+TEST_F(NPCFactoryFileTest, CompressedLoadRejectsCorruption) {
+    auto npcs = random_npcs(factory, 3000);
+    factory.save_compressed("output.npcz", npcs);
+    
+    std::vector<char> bytes;
+    {
+        std::ifstream in("output.npcz", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    bytes[bytes.size() / 2] ^= 0x21;
+    {
+        std::ofstream out("output.npcz", std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    
+    EXPECT_THROW(factory.load_compressed("output.npcz"), std::runtime_error);
+    EXPECT_THROW(factory.load_compressed("no_such_file.npcz"), std::runtime_error);
+}
+
+// Число записей блока вне контрольной суммы: огромное значение - ошибка формата, а не bad_alloc
+TEST_F(NPCFactoryFileTest, CompressedLoadRejectsHugeRecordCount) {
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.push_back(factory.create("Орк", "Орк_1", Point(3, 4)));
+    factory.save_compressed("output.npcz", npcs, BlockCodec::Kind::NONE);
+    
+    std::vector<char> bytes;
+    {
+        std::ifstream in("output.npcz", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // Заголовок единственного блока без сжатия: сырой размер = сжатому, одна запись
+    auto u32_at = [&bytes](size_t offset) {
+        uint32_t value = 0;
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    };
+    size_t records = 0;
+    for (size_t offset = 0; offset + 12 <= bytes.size(); ++offset) {
+        if (u32_at(offset) != 0 && u32_at(offset) == u32_at(offset + 4) && u32_at(offset + 8) == 1) {
+            records = offset + 8;
+            break;
+        }
+    }
+    ASSERT_NE(records, 0u);
+    uint32_t huge = 0xF0000000u;
+    std::memcpy(bytes.data() + records, &huge, sizeof(huge));
+    {
+        std::ofstream out("output.npcz", std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    
+    EXPECT_THROW(factory.load_compressed("output.npcz"), std::runtime_error);
+}
+
+// Сырой размер блока тоже вне контрольной суммы: проверяется до выделения буфера
+TEST_F(NPCFactoryFileTest, CompressedLoadRejectsCorruptedRawSize) {
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.push_back(factory.create("Орк", "Орк_1", Point(3, 4)));
+    factory.save_compressed("output.npcz", npcs, BlockCodec::Kind::NONE);
+    
+    std::vector<char> original;
+    {
+        std::ifstream in("output.npcz", std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto u32_at = [&original](size_t offset) {
+        uint32_t value = 0;
+        std::memcpy(&value, original.data() + offset, sizeof(value));
+        return value;
+    };
+    size_t raw_size = 0;
+    for (size_t offset = 0; offset + 12 <= original.size(); ++offset) {
+        if (u32_at(offset) != 0 && u32_at(offset) == u32_at(offset + 4) && u32_at(offset + 8) == 1) {
+            raw_size = offset;
+            break;
+        }
+    }
+    ASSERT_NE(raw_size, 0u);
+    
+    // Больше двух блоков и расхождение со сжатым размером без кодека
+    for (uint32_t corrupted : {0xF0000000u, static_cast<uint32_t>(NPCArchive::MAX_BLOCK_SIZE + 1), u32_at(raw_size) + 4}) {
+        std::vector<char> bytes = original;
+        std::memcpy(bytes.data() + raw_size, &corrupted, sizeof(corrupted));
+        {
+            std::ofstream out("output.npcz", std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        EXPECT_THROW(factory.load_compressed("output.npcz"), std::runtime_error) << corrupted;
+    }
+    
+    // Запись длиннее MAX_BLOCK_SIZE не сохраняется
+    npcs.push_back(factory.create("Орк", std::string(NPCArchive::MAX_BLOCK_SIZE, 'x'), Point(0, 0)));
+    EXPECT_THROW(factory.save_compressed("output.npcz", npcs), std::runtime_error);
+}
+
+TEST_F(NPCFactoryFileTest, ParallelSaveIsByteIdentical) {
+    auto read_all = [](const std::string& filename) {
+        std::ifstream in(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    };
+    
+    auto npcs = random_npcs(factory, 10000);
+    for (size_t i = 0; i < npcs.size(); i += 7) {
+        npcs[i]->kill();
+    }
+    factory.save_to_file("output.txt", npcs);
+    std::string expected = read_all("output.txt");
+    
+    for (unsigned threads : {1u, 3u, 8u, 0u}) {
+        factory.save_to_file_parallel("output.npcz", npcs, threads);
+        EXPECT_EQ(read_all("output.npcz"), expected) << threads << " потоков";
+    }
+    
+    // Потоков больше, чем NPC, и пустой список
+    std::vector<std::unique_ptr<NPC>> few;
+    few.push_back(factory.create("Орк", "Один", Point(-3, 4)));
+    factory.save_to_file_parallel("output.npcz", few, 16);
+    EXPECT_EQ(read_all("output.npcz"), "Один Орк -3 4\n");
+    factory.save_to_file_parallel("output.npcz", {}, 4);
+    EXPECT_TRUE(read_all("output.npcz").empty());
+    
+    EXPECT_THROW(factory.save_to_file_parallel("/nonexistent/dir/out.txt", npcs), std::runtime_error);
+}
@@ -0,0 +1,100 @@
+#include "../include/game/flow_field.h"
+#include "../include/game/terrain.h"
+#include "../include/game/game.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+
+TEST(FlowFieldTest, OpenMapDistanceIsChebyshev) {
+    FlowField field(40, 30);
+    field.rebuild({Point(5, 5), Point(30, 20)});
+    
+    for (int y = 0; y < 30; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            uint32_t expected = static_cast<uint32_t>(std::min(
+                std::max(std::abs(x - 5), std::abs(y - 5)),
+                std::max(std::abs(x - 30), std::abs(y - 20))));
+            ASSERT_EQ(field.distance(Point(x, y)), expected) << x << "," << y;
+        }
+    }
+    EXPECT_EQ(field.last_visited(), 40u * 30u);
+    EXPECT_EQ(field.distance(Point(-1, 0)), FlowField::UNREACHABLE);
+}
+
+TEST(FlowFieldTest, WallsForceDetour) {
+    TerrainMap map(20, 20);
+    map.fill_rect(10, 0, 10, 17, TerrainMap::Cell::WALL);
+    FlowField field(20, 20);
+    field.rebuild({Point(5, 0)}, &map);
+    
+    // Обход через проход внизу стены
+    EXPECT_EQ(field.distance(Point(15, 0)), 36u);
+    EXPECT_EQ(field.distance(Point(10, 5)), FlowField::UNREACHABLE);
+    
+    // Спуск по полю приводит к источнику, подъем - уводит от него
+    Point p(15, 0);
+    for (int i = 0; i < 36; ++i) {
+        auto [dx, dy] = field.descend(p);
+        ASSERT_TRUE(dx != 0 || dy != 0);
+        p = Point(p.get_x() + dx, p.get_y() + dy);
+        ASSERT_TRUE(map.is_passable(p));
+    }
+    EXPECT_EQ(field.distance(p), 0u);
+    auto [dx, dy] = field.descend(p);
+    EXPECT_EQ(dx, 0);
+    EXPECT_EQ(dy, 0);
+    
+    Point q(6, 1);
+    auto [ax, ay] = field.ascend(q);
+    EXPECT_GT(field.distance(Point(q.get_x() + ax, q.get_y() + ay)), field.distance(q));
+}
+
+TEST(FlowFieldTest, NoSourcesMeansNoDirection) {
+    FlowField field(10, 10);
+    field.rebuild({});
+    EXPECT_EQ(field.distance(Point(3, 3)), FlowField::UNREACHABLE);
+    auto [dx, dy] = field.descend(Point(3, 3));
+    EXPECT_EQ(dx, 0);
+    EXPECT_EQ(dy, 0);
+}
+
+// Орки выслеживают друидов быстрее случайного блуждания, белки уходят от друидов
+TEST(GameFlowTest, PredatorsHuntAndPreyFlees) {
+    size_t random_druids = 0, hunted_druids = 0;
+    size_t random_squirrels = 0, fleeing_squirrels = 0;
+    for (unsigned seed = 1; seed <= 10; ++seed) {
+        Game random_walk(seed, true);
+        random_walk.run_headless(6);
+        random_druids += random_walk.population().alive_of("Друид");
+        random_squirrels += random_walk.population().alive_of("Белка");
+        
+        Game hunting(seed, true);
+        hunting.set_flow_movement(true);
+        hunting.run_headless(6);
+        hunted_druids += hunting.population().alive_of("Друид");
+        fleeing_squirrels += hunting.population().alive_of("Белка");
+    }
+    EXPECT_LT(hunted_druids, random_druids);
+    EXPECT_GT(fleeing_squirrels, random_squirrels);
+    
+    Game game(1, true);
+    EXPECT_THROW(game.set_flow_movement(true, 0), std::invalid_argument);
+}
+
+TEST(GameFlowTest, TypeBucketsFollowSameFields) {
+    Game plain(6, true);
+    Game bucketed(6, true);
+    plain.set_flow_movement(true, 2);
+    bucketed.set_flow_movement(true, 2);
+    bucketed.set_type_buckets(true);
+    plain.run_headless(25);
+    bucketed.run_headless(25);
+    
+    auto a = plain.snapshot();
+    auto b = bucketed.snapshot();
+    ASSERT_EQ(a->npcs.size(), b->npcs.size());
+    for (size_t i = 0; i < a->npcs.size(); ++i) {
+        EXPECT_EQ(a->npcs[i].position.get_x(), b->npcs[i].position.get_x());
+        EXPECT_EQ(a->npcs[i].position.get_y(), b->npcs[i].position.get_y());
+        EXPECT_EQ(a->npcs[i].alive, b->npcs[i].alive);
+    }
+}
@@ -6,6 +6,9 @@
 #include "../include/geometry/point.h"
 #include <thread>
 #include <chrono>
+#include <map>
+#include <atomic>
+#include <algorithm>
 
 // Тест проверки расстояний хода и убийства
 TEST(GameTest, NPCMoveAndKillDistances) {
@@ -106,3 +109,423 @@ TEST(GameTest, DistanceCalculation) {
     EXPECT_EQ(pos2.get_y(), 4);
 }
 
+
+// Тест снимка мира: читатель получает согласованное состояние без блокировок
+TEST(GameTest, SnapshotMatchesSurvivors) {
+    Game game;
+    
+    auto world = game.snapshot();
+    ASSERT_NE(world, nullptr);
+    EXPECT_EQ(world->npcs.size(), static_cast<size_t>(Game::NUM_NPCS));
+    EXPECT_EQ(world->alive_count(), game.get_survivors().size());
+    EXPECT_EQ(world->tick, 0u);
+    
+    for (const auto& npc : world->npcs) {
+        EXPECT_GE(npc.position.get_x(), 0);
+        EXPECT_LT(npc.position.get_x(), Game::MAP_WIDTH);
+        EXPECT_GE(npc.position.get_y(), 0);
+        EXPECT_LT(npc.position.get_y(), Game::MAP_HEIGHT);
+    }
+}
+
+// Снимки делят строки имен и словарь типов, а не копируют их
+TEST(GameTest, SnapshotsShareNamesAndTypes) {
+    Game game(8, true);
+    auto before = game.snapshot();
+    game.step();
+    auto after = game.snapshot();
+    ASSERT_NE(before, after);
+    EXPECT_EQ(before->types, after->types);
+
+    std::map<uint64_t, const NPCState*> earlier;
+    for (const auto& npc : before->npcs) {
+        earlier[(uint64_t{npc.handle.index} << 32) | npc.handle.generation] = &npc;
+    }
+    size_t shared = 0;
+    for (const auto& npc : after->npcs) {
+        if (!npc.alive) continue;
+        auto it = earlier.find((uint64_t{npc.handle.index} << 32) | npc.handle.generation);
+        ASSERT_NE(it, earlier.end());
+        EXPECT_EQ(it->second->name.get(), npc.name.get());
+        EXPECT_FALSE(after->type_name(npc).empty());
+        EXPECT_EQ(WorldSnapshot::name_of(npc).rfind(after->type_name(npc) + "_", 0), 0u);
+        ++shared;
+    }
+    EXPECT_GT(shared, 0u);
+}
+
+// Тест сохранения снимка в файл в формате NPCFactory
+TEST(GameTest, SaveSnapshotToFile) {
+    const std::string test_file = "game_snapshot_test.txt";
+    Game game;
+    
+    game.save_to_file(test_file);
+    
+    NPCFactory factory;
+    auto loaded = factory.load_from_file(test_file);
+    EXPECT_EQ(loaded.size(), game.get_survivors().size());
+    
+    std::remove(test_file.c_str());
+}
+
+namespace {
+
+// Наблюдатель, считающий события боев из потока боев
+class CountingObserver : public Observer {
+public:
+    void notify(const BattleEvent& event) const override {
+        ++events;
+        if (event.enqueued_at > std::chrono::steady_clock::now()) {
+            ++future_timestamps;
+        }
+    }
+    
+    mutable std::atomic<int> events{0};
+    mutable std::atomic<int> future_timestamps{0};
+};
+
+} // namespace
+
+// Потоковая игра с быстрыми тиками (запускается и под ThreadSanitizer)
+TEST(GameThreadsTest, FastTicksRunAndStopCleanly) {
+    Game game(5, true);
+    CountingObserver observer;
+    game.subscribe(&observer);
+    game.set_timing(std::chrono::milliseconds(2), std::chrono::milliseconds(200));
+    
+    auto started = std::chrono::steady_clock::now();
+    game.start();
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    
+    EXPECT_LT(elapsed, std::chrono::seconds(5));
+    EXPECT_GT(game.snapshot()->tick, 0u);
+    EXPECT_GT(observer.events.load(), 0);
+    EXPECT_EQ(observer.future_timestamps.load(), 0);
+    EXPECT_EQ(game.snapshot()->alive_count(), game.get_survivors().size());
+}
+
+// Повторная остановка и остановка без запуска безопасны
+TEST(GameThreadsTest, StopIsIdempotent) {
+    Game game(6, true);
+    EXPECT_NO_THROW({
+        game.stop();
+        game.stop();
+    });
+}
+
+// Матрица убийств строится по правилам NPC::vs
+TEST(KillMatrixTest, MatchesVsRules) {
+    NPCFactory factory;
+    KillMatrix matrix(factory);
+    
+    int orc = matrix.type_index("Орк");
+    int druid = matrix.type_index("Друид");
+    int squirrel = matrix.type_index("Белка");
+    ASSERT_GE(orc, 0);
+    ASSERT_GE(druid, 0);
+    ASSERT_GE(squirrel, 0);
+    EXPECT_EQ(matrix.type_index("Рыцарь"), -1);
+    
+    EXPECT_TRUE(matrix.can_kill(orc, druid));
+    EXPECT_TRUE(matrix.can_kill(druid, squirrel));
+    EXPECT_FALSE(matrix.can_kill(druid, orc));
+    EXPECT_FALSE(matrix.can_kill(orc, squirrel));
+    EXPECT_FALSE(matrix.can_kill(orc, orc));
+    EXPECT_FALSE(matrix.is_predator(squirrel));
+    EXPECT_TRUE(matrix.is_predator(orc));
+}
+
+// Предфильтр отбрасывает невозможные пары и сообщает об экономии
+TEST(GameTest, PairFilterDropsImpossiblePairs) {
+    Game game(11, true);
+    game.run_headless(10);
+    
+    PairFilterStats stats = game.pair_filter_stats();
+    EXPECT_GT(stats.candidates, 0u);
+    EXPECT_GT(stats.impossible, 0u);
+    EXPECT_EQ(stats.pushed + stats.saved(), stats.candidates);
+    // В синхронном режиме очередь разбирается каждый тик - дубликатов нет
+    EXPECT_EQ(stats.duplicates, 0u);
+}
+
+// Поколенческие дескрипторы переживают уплотнение и отвергают устаревшие ссылки
+TEST(NPCPoolTest, HandlesSurviveCompaction) {
+    NPCPool pool;
+    NPCHandle first = pool.insert(std::make_unique<Orc>("Орк1", Point(0, 0)), 0);
+    NPCHandle second = pool.insert(std::make_unique<Druid>("Друид1", Point(1, 1)), 1);
+    NPCHandle third = pool.insert(std::make_unique<Squirrel>("Белка1", Point(2, 2)), 2);
+    
+    pool.get(first)->kill();
+    EXPECT_EQ(pool.compact(), 1u);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.retained(), 1u);
+    
+    EXPECT_EQ(pool.get(first), nullptr);
+    EXPECT_FALSE(pool.contains(first));
+    ASSERT_NE(pool.get(second), nullptr);
+    ASSERT_NE(pool.get(third), nullptr);
+    EXPECT_EQ(pool.get(second)->get_name(), "Друид1");
+    EXPECT_EQ(pool.get(third)->get_name(), "Белка1");
+}
+
+TEST(NPCPoolTest, ReusedSlotGetsNewGeneration) {
+    NPCPool pool;
+    NPCHandle old_handle = pool.insert(std::make_unique<Orc>("Старый", Point(0, 0)), 0);
+    pool.get(old_handle)->kill();
+    pool.compact();
+    
+    NPCHandle new_handle = pool.recycle(0, "Новый", Point(5, 5));
+    EXPECT_EQ(new_handle.index, old_handle.index);
+    EXPECT_NE(new_handle.generation, old_handle.generation);
+    EXPECT_EQ(pool.get(old_handle), nullptr);
+    EXPECT_EQ(pool.get(new_handle)->get_name(), "Новый");
+    EXPECT_TRUE(pool.get(new_handle)->is_alive());
+    EXPECT_EQ(pool.get(new_handle)->get_position().get_x(), 5);
+    EXPECT_EQ(pool.slot_capacity(), 1u);
+    EXPECT_EQ(pool.retained(), 0u);
+    
+    // Для другого типа сохраненного объекта нет
+    EXPECT_TRUE(pool.recycle(1, "Друид", Point(0, 0)).is_null());
+    
+    EXPECT_EQ(pool.get(NPCHandle{}), nullptr);
+}
+
+// Уплотнение стабильно: живые сохраняют взаимный порядок
+TEST(NPCPoolTest, CompactionKeepsAliveOrder) {
+    NPCPool pool;
+    std::vector<NPCHandle> handles;
+    for (int i = 0; i < 6; ++i) {
+        handles.push_back(pool.insert(std::make_unique<Orc>("Орк" + std::to_string(i), Point(i, 0)), 0));
+    }
+    pool.get(handles[1])->kill();
+    pool.get(handles[4])->kill();
+    
+    EXPECT_EQ(pool.compact(), 2u);
+    ASSERT_EQ(pool.size(), 4u);
+    EXPECT_EQ(pool.at(0)->get_name(), "Орк0");
+    EXPECT_EQ(pool.at(1)->get_name(), "Орк2");
+    EXPECT_EQ(pool.at(2)->get_name(), "Орк3");
+    EXPECT_EQ(pool.at(3)->get_name(), "Орк5");
+    EXPECT_EQ(pool.get(handles[5]), pool.at(3));
+    
+    // Вставка после уплотнения встает в конец активной области
+    NPCHandle added = pool.insert(std::make_unique<Druid>("Друид", Point(0, 0)), 1);
+    EXPECT_EQ(pool.size(), 5u);
+    EXPECT_EQ(pool.retained(), 2u);
+    EXPECT_EQ(pool.at(4), pool.get(added));
+}
+
+// Списки погибших ведутся по типам и ограничены пределом на тип
+TEST(NPCPoolTest, RetainedObjectsAreCappedPerType) {
+    NPCPool pool(2);
+    std::vector<NPCHandle> orcs;
+    for (int i = 0; i < 5; ++i) {
+        orcs.push_back(pool.insert(std::make_unique<Orc>("Орк" + std::to_string(i), Point(i, 0)), 0));
+    }
+    NPCHandle druid = pool.insert(std::make_unique<Druid>("Друид", Point(0, 0)), 1);
+    for (auto handle : orcs) {
+        pool.get(handle)->kill();
+    }
+    pool.get(druid)->kill();
+    
+    EXPECT_EQ(pool.compact(), 6u);
+    EXPECT_EQ(pool.size(), 0u);
+    EXPECT_EQ(pool.retained_of(0), 2u); // лишние орки разрушены
+    EXPECT_EQ(pool.retained_of(1), 1u);
+    EXPECT_EQ(pool.retained(), 3u);
+    
+    // Оживление берет объект своего типа, не перебирая чужие
+    EXPECT_FALSE(pool.recycle(1, "Друид2", Point(1, 1)).is_null());
+    EXPECT_TRUE(pool.recycle(1, "Друид3", Point(1, 1)).is_null());
+    EXPECT_FALSE(pool.recycle(0, "Орк5", Point(1, 1)).is_null());
+    EXPECT_EQ(pool.retained(), 1u);
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+// Поразрядная сортировка по ключам устойчива и не портит дескрипторы
+TEST(NPCPoolTest, SortActiveKeepsHandles) {
+    NPCPool pool;
+    std::vector<NPCHandle> handles;
+    for (int i = 0; i < 300; ++i) {
+        handles.push_back(pool.insert(std::make_unique<Orc>("Орк" + std::to_string(i), Point(i, 0)), 0));
+    }
+    pool.get(handles[7])->kill();
+    pool.compact();
+    ASSERT_EQ(pool.retained(), 1u);
+    
+    // Ключи с повторами и разными старшими байтами
+    std::vector<uint64_t> keys(pool.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = (static_cast<uint64_t>(i % 5) << 40) | ((keys.size() - i) % 3);
+    }
+    std::vector<std::pair<uint64_t, std::string>> expected;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        expected.emplace_back(keys[i], pool.at(i)->get_name());
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    pool.sort_active(keys);
+    ASSERT_EQ(pool.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(pool.at(i)->get_name(), expected[i].second);
+        EXPECT_EQ(pool.get(pool.handle_at(i)), pool.at(i));
+    }
+    for (int i = 0; i < 300; ++i) {
+        if (i == 7) continue;
+        EXPECT_EQ(pool.get(handles[i])->get_name(), "Орк" + std::to_string(i));
+    }
+    EXPECT_EQ(pool.get(handles[7]), nullptr);
+    EXPECT_EQ(pool.retained(), 1u);
+    EXPECT_TRUE(pool.recycle(0, "Новый", Point(0, 0)).index == handles[7].index);
+    
+    EXPECT_THROW(pool.sort_active({1, 2}), std::invalid_argument);
+}
+
+// Хранилище периодически переставляется в Z-порядке, бои по дескрипторам не ломаются
+TEST(GameTest, StorageIsReorderedByLocation) {
+    Game game(8, true);
+    game.run_headless(20);
+    EXPECT_GT(game.locality_reorders(), 0u);
+    
+    auto snapshot = game.snapshot();
+    EXPECT_EQ(snapshot->alive_count(), game.population().alive());
+    for (const auto& state : snapshot->npcs) {
+        EXPECT_FALSE(state.handle.is_null());
+    }
+}
+
+// Погибшие NPC убираются из активной области между тиками
+TEST(GameTest, DeadNPCsAreCompacted) {
+    Game game(21, true);
+    game.run_headless(Game::GAME_DURATION_SECONDS);
+    
+    // Гарантированное уплотнение: интервал тиков истекает
+    for (int i = 0; i < Game::COMPACTION_INTERVAL_TICKS; ++i) {
+        game.step();
+    }
+    
+    EXPECT_LT(game.storage_size(), static_cast<size_t>(Game::NUM_NPCS));
+    EXPECT_EQ(game.storage_size() + game.retained_size(), static_cast<size_t>(Game::NUM_NPCS));
+}
+
+// Бесконечная симуляция с респавном работает в постоянной памяти
+TEST(GameTest, RespawnRecyclesDeadSlots) {
+    Game game(33, true);
+    
+    std::map<std::string, size_t> initial;
+    auto start = game.snapshot();
+    for (const auto& npc : start->npcs) {
+        ++initial[start->type_name(npc)];
+    }
+    
+    int spawned = 0;
+    for (int tick = 0; tick < 500; ++tick) {
+        game.step();
+        
+        std::map<std::string, size_t> alive;
+        auto world = game.snapshot();
+        for (const auto& npc : world->npcs) {
+            if (npc.alive) ++alive[world->type_name(npc)];
+        }
+        // Возвращаем погибших того же типа
+        for (const auto& [type, count] : initial) {
+            for (size_t i = alive[type]; i < count; ++i) {
+                game.spawn(type, "Новичок_" + std::to_string(spawned), Point(spawned % 50, tick % 50));
+                ++spawned;
+            }
+        }
+    }
+    
+    EXPECT_GT(spawned, Game::NUM_NPCS);
+    EXPECT_EQ(game.snapshot()->alive_count(), static_cast<size_t>(Game::NUM_NPCS));
+    // Объектов не больше, чем живых плюс погибших между двумя уплотнениями
+    EXPECT_LE(game.storage_size() + game.retained_size(), static_cast<size_t>(2 * Game::NUM_NPCS));
+}
+
+TEST(GameTest, SpawnUnknownTypeThrows) {
+    Game game(1, true);
+    EXPECT_THROW(game.spawn("Рыцарь", "Артур", Point(0, 0)), std::invalid_argument);
+}
+
+TEST(GameTest, PopulationCountersTrackSpawnsAndKills) {
+    Game game(21, true);
+    
+    auto expect_matches_snapshot = [&game]() {
+        auto world = game.snapshot();
+        std::map<std::string, size_t> per_type;
+        for (const auto& npc : world->npcs) {
+            if (npc.alive) ++per_type[world->type_name(npc)];
+        }
+        const PopulationCounters& population = game.population();
+        EXPECT_EQ(population.alive(), world->alive_count());
+        for (const auto& type : population.types()) {
+            EXPECT_EQ(population.alive_of(type), per_type[type]) << type;
+        }
+    };
+    
+    expect_matches_snapshot();
+    for (int tick = 0; tick < 60; ++tick) {
+        game.step();
+        if (tick % 10 == 0) {
+            game.spawn("Друид", "Друид_" + std::to_string(tick), Point(tick % 50, 25));
+        }
+        expect_matches_snapshot();
+    }
+}
+
+TEST(GameTest, ObserversReadPopulationFromEvents) {
+    struct PopulationObserver : Observer {
+        mutable size_t last_alive = 0;
+        mutable size_t kills = 0;
+        void notify(const BattleEvent& event) const override {
+            if (event.killed && event.population) {
+                last_alive = event.population->alive();
+                ++kills;
+            }
+        }
+    };
+    
+    Game game(4, true);
+    PopulationObserver observer;
+    game.subscribe(&observer);
+    game.run_headless(100);
+    
+    ASSERT_GT(observer.kills, 0u);
+    EXPECT_EQ(observer.last_alive, game.snapshot()->alive_count());
+    EXPECT_EQ(observer.kills, static_cast<size_t>(Game::NUM_NPCS) - game.population().alive());
+}
+
+// Обработка по типам дает те же траектории и бои, что и обычная
+TEST(GameTest, TypeBucketsMatchDefaultMode) {
+    static_assert(!is_predator_v<Squirrel>);
+    static_assert(is_predator_v<Orc> && is_predator_v<Druid>);
+    
+    for (unsigned seed : {3u, 17u, 29u}) {
+        Game plain(seed, true);
+        Game bucketed(seed, true);
+        bucketed.set_type_buckets(true);
+        
+        for (int tick = 0; tick < 40; ++tick) {
+            plain.step();
+            bucketed.step();
+            if (tick == 20) {
+                plain.spawn("Орк", "Орк_новый", Point(10, 10));
+                bucketed.spawn("Орк", "Орк_новый", Point(10, 10));
+            }
+        }
+        
+        auto a = plain.snapshot();
+        auto b = bucketed.snapshot();
+        ASSERT_EQ(a->npcs.size(), b->npcs.size());
+        for (size_t i = 0; i < a->npcs.size(); ++i) {
+            EXPECT_EQ(WorldSnapshot::name_of(a->npcs[i]), WorldSnapshot::name_of(b->npcs[i]));
+            EXPECT_EQ(a->npcs[i].position.get_x(), b->npcs[i].position.get_x());
+            EXPECT_EQ(a->npcs[i].position.get_y(), b->npcs[i].position.get_y());
+            EXPECT_EQ(a->npcs[i].alive, b->npcs[i].alive);
+        }
+        EXPECT_EQ(plain.pair_filter_stats().pushed, bucketed.pair_filter_stats().pushed);
+        // Невозможные пары в режиме по типам не проверяются
+        EXPECT_EQ(bucketed.pair_filter_stats().impossible, 0u);
+    }
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "../include/game/game.h"
+#include "../include/game/kill_matrix.h"
+#include "../include/npc/npc_factory.h"
+#include "../include/npc/druid.h"
+#include <memory>
+#include <vector>
+
+namespace {
+
+// Мир без друидов: орки и белки друг другу не враги - все NPC спокойны
+void remove_druids(Game& game) {
+    GameCheckpoint checkpoint = game.capture_checkpoint();
+    for (auto& record : checkpoint.npcs) {
+        if (checkpoint.types[record.type] == Druid::TYPE_NAME) {
+            record.alive = false;
+        }
+    }
+    game.restore_checkpoint(checkpoint);
+}
+
+// Каждая враждебная пара в пределах расстояния боя обновляется каждый тик
+void expect_fights_at_full_rate(const Game& game, const KillMatrix& matrix) {
+    auto snapshot = game.snapshot();
+    for (const auto& a : snapshot->npcs) {
+        if (!a.alive) continue;
+        size_t type_a = static_cast<size_t>(matrix.type_index(snapshot->type_name(a)));
+        for (const auto& b : snapshot->npcs) {
+            if (!b.alive) continue;
+            size_t type_b = static_cast<size_t>(matrix.type_index(snapshot->type_name(b)));
+            if (!matrix.can_kill(type_a, type_b)) continue;
+            if (!a.position.within(b.position, matrix.kill_distance(type_a))) continue;
+            EXPECT_EQ(game.update_period(a.handle), 1) << *a.name << " рядом с " << *b.name;
+            EXPECT_EQ(game.update_period(b.handle), 1) << *b.name << " рядом с " << *a.name;
+        }
+    }
+}
+
+} // namespace
+
+TEST(LevelOfDetailTest, CalmWorldUpdatesRarely) {
+    Game game(7, true);
+    remove_druids(game);
+    game.set_level_of_detail(true);
+    game.run_headless(32);
+
+    LevelOfDetailStats stats = game.level_of_detail_stats();
+    EXPECT_EQ(stats.full_updates, 0u);
+    EXPECT_GT(stats.aggregated_updates, 0u);
+    // Период 8 с первого тика: на одно обновление семь пропусков
+    EXPECT_EQ(stats.skipped, 7 * stats.aggregated_updates);
+    for (const auto& npc : game.snapshot()->npcs) {
+        if (npc.alive) {
+            EXPECT_EQ(game.update_period(npc.handle), Game::LOD_MAX_PERIOD);
+        }
+    }
+    EXPECT_EQ(game.update_period(NPCHandle{}), 0);
+}
+
+TEST(LevelOfDetailTest, ThreatsRestoreFullRate) {
+    NPCFactory factory;
+    KillMatrix matrix(factory);
+    for (unsigned seed : {3u, 11u, 42u}) {
+        Game game(seed, true);
+        remove_druids(game);
+        game.set_level_of_detail(true);
+
+        for (int tick = 0; tick < 60; ++tick) {
+            game.step();
+            expect_fights_at_full_rate(game, matrix);
+            if (tick == 13) {
+                // Посреди окна спокойных NPC: соседи в радиусе угрозы перепланируются на следующем тике
+                game.spawn("Друид", "Друид_новый", Point(25, 25));
+                game.spawn("Друид", "Друид_угловой", Point(2, 47));
+            }
+        }
+        EXPECT_GT(game.level_of_detail_stats().full_updates, 0u);
+    }
+}
+
+TEST(LevelOfDetailTest, TypeBucketsMatchDefaultMode) {
+    for (unsigned seed : {3u, 29u}) {
+        Game plain(seed, true);
+        Game bucketed(seed, true);
+        bucketed.set_type_buckets(true);
+        for (Game* game : {&plain, &bucketed}) {
+            remove_druids(*game);
+            game->set_level_of_detail(true);
+        }
+
+        for (int tick = 0; tick < 40; ++tick) {
+            plain.step();
+            bucketed.step();
+            if (tick == 20) {
+                plain.spawn("Друид", "Друид_новый", Point(10, 10));
+                bucketed.spawn("Друид", "Друид_новый", Point(10, 10));
+            }
+        }
+
+        auto a = plain.snapshot();
+        auto b = bucketed.snapshot();
+        ASSERT_EQ(a->npcs.size(), b->npcs.size());
+        for (size_t i = 0; i < a->npcs.size(); ++i) {
+            EXPECT_EQ(WorldSnapshot::name_of(a->npcs[i]), WorldSnapshot::name_of(b->npcs[i]));
+            EXPECT_EQ(a->npcs[i].position.get_x(), b->npcs[i].position.get_x());
+            EXPECT_EQ(a->npcs[i].position.get_y(), b->npcs[i].position.get_y());
+            EXPECT_EQ(a->npcs[i].alive, b->npcs[i].alive);
+        }
+        EXPECT_EQ(plain.level_of_detail_stats().skipped, bucketed.level_of_detail_stats().skipped);
+    }
+}
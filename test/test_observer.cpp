@@ -1,6 +1,8 @@
 #include "../include/battle/battle_visitor.h"
 #include "../include/battle/console_observer.h"
 #include "../include/battle/file_observer.h"
+#include "../include/battle/event_manager.h"
+#include "../include/battle/variant_battle.h"
 #include "../include/npc/druid.h"
 #include "../include/npc/orc.h"
 #include "../include/npc/squirrel.h"
@@ -9,6 +11,11 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
 
 
 class BattleVisitorTest : public ::testing::Test {
@@ -304,3 +311,217 @@ TEST_F(BattleVisitorTest, StateImmutability) {
     EXPECT_EQ(attacker.get_name(), original_attacker_name);
     EXPECT_EQ(target.get_name(), original_target_name);
 }
+
+// Наблюдатель, считающий вызовы notify и notify_batch
+class CountingObserver : public Observer {
+public:
+    explicit CountingObserver(bool batched = false) : batched(batched) {}
+    
+    void notify(const BattleEvent&) const override {
+        events.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    void notify_batch(std::span<const BattleEvent> batch) const override {
+        if (!batched) {
+            Observer::notify_batch(batch);
+            return;
+        }
+        batches.fetch_add(1, std::memory_order_relaxed);
+        events.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+    
+    bool batched;
+    mutable std::atomic<size_t> events{0};
+    mutable std::atomic<size_t> batches{0};
+};
+
+TEST(EventManagerTest, PublishBatchDeliversWholeBatch) {
+    EventManager manager;
+    CountingObserver batched(true);
+    CountingObserver plain;
+    manager.subscribe(&batched);
+    manager.subscribe(&plain);
+    
+    std::vector<BattleEvent> events(5);
+    manager.publish_batch(events);
+    manager.publish(events.front());
+    
+    EXPECT_EQ(batched.batches.load(), 1u);
+    EXPECT_EQ(batched.events.load(), 6u);
+    // Реализация по умолчанию разворачивает пакет в notify
+    EXPECT_EQ(plain.batches.load(), 0u);
+    EXPECT_EQ(plain.events.load(), 6u);
+    
+    manager.unsubscribe(&batched);
+    manager.publish_batch(events);
+    EXPECT_EQ(batched.events.load(), 6u);
+    EXPECT_EQ(plain.events.load(), 11u);
+}
+
+TEST(EventManagerTest, SubscribeDuringPublish) {
+    EventManager manager;
+    CountingObserver permanent;
+    manager.subscribe(&permanent);
+    
+    std::atomic<bool> stop{false};
+    std::thread publisher([&] {
+        std::vector<BattleEvent> events(8);
+        while (!stop.load()) {
+            manager.publish_batch(events);
+        }
+    });
+    while (permanent.events.load() == 0) {
+        std::this_thread::yield();
+    }
+    
+    // После unsubscribe наблюдатель уничтожается сразу - публикации его уже не видят
+    for (int i = 0; i < 200; ++i) {
+        auto transient = std::make_unique<CountingObserver>(i % 2 == 0);
+        manager.subscribe(transient.get());
+        manager.unsubscribe(transient.get());
+    }
+    stop.store(true);
+    publisher.join();
+    
+    EXPECT_EQ(permanent.events.load() % 8, 0u);
+}
+
+// Наблюдатель, отписывающийся из собственного notify
+class SelfRemovingObserver : public Observer {
+public:
+    explicit SelfRemovingObserver(EventManager& manager) : manager(manager) {}
+    
+    void notify(const BattleEvent&) const override {
+        try {
+            manager.unsubscribe(const_cast<SelfRemovingObserver*>(this));
+        } catch (const std::logic_error&) {
+            rejected = true;
+        }
+    }
+    
+    EventManager& manager;
+    mutable bool rejected = false;
+};
+
+// Наблюдатель, который держит публикацию до сигнала
+class BlockingObserver : public Observer {
+public:
+    void notify(const BattleEvent&) const override {
+        entered.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    }
+    
+    mutable std::atomic<bool> entered{false};
+    mutable std::atomic<bool> release{false};
+};
+
+TEST(EventManagerTest, UnsubscribeFromNotifyThrows) {
+    EventManager manager;
+    SelfRemovingObserver observer(manager);
+    manager.subscribe(&observer);
+    
+    manager.publish(BattleEvent{});
+    EXPECT_TRUE(observer.rejected);
+    
+    // Вне публикации отписка работает
+    manager.unsubscribe(&observer);
+    observer.rejected = false;
+    manager.publish(BattleEvent{});
+    EXPECT_FALSE(observer.rejected);
+}
+
+TEST(EventManagerTest, UnsubscribeWaitsForRunningPublish) {
+    EventManager manager;
+    BlockingObserver blocking;
+    CountingObserver counting;
+    manager.subscribe(&blocking);
+    manager.subscribe(&counting);
+    
+    std::thread publisher([&] { manager.publish(BattleEvent{}); });
+    while (!blocking.entered.load()) {
+        std::this_thread::yield();
+    }
+    
+    std::atomic<bool> unsubscribed{false};
+    std::thread remover([&] {
+        manager.unsubscribe(&counting);
+        unsubscribed.store(true);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(unsubscribed.load());
+    
+    blocking.release.store(true);
+    remover.join();
+    publisher.join();
+    EXPECT_TRUE(unsubscribed.load());
+    EXPECT_EQ(counting.events.load(), 1u);
+}
+
+// Наблюдатель, запоминающий тексты событий
+class RecordingObserver : public Observer {
+public:
+    void notify(const BattleEvent& event) const override {
+        actions.push_back(event.action);
+    }
+    
+    mutable std::vector<std::string> actions;
+};
+
+TEST(VariantBattleTest, KillRulesMatchVirtualVs) {
+    std::vector<std::unique_ptr<NPC>> npcs;
+    npcs.push_back(std::make_unique<Orc>("Орк", Point(0, 0)));
+    npcs.push_back(std::make_unique<Druid>("Друид", Point(0, 0)));
+    npcs.push_back(std::make_unique<Squirrel>("Белка", Point(0, 0)));
+    
+    for (auto& attacker : npcs) {
+        for (auto& target : npcs) {
+            NPCVariant a = to_variant(*attacker);
+            NPCVariant t = to_variant(*target);
+            bool rule = std::visit([](const auto& x, const auto& y) {
+                return kills_v<std::decay_t<decltype(x)>, std::decay_t<decltype(y)>>;
+            }, a, t);
+            EXPECT_EQ(rule, attacker->vs(*target).has_value())
+                << attacker->get_type() << " -> " << target->get_type();
+        }
+    }
+}
+
+TEST(VariantBattleTest, SameOutcomeAsVisitor) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, 40);
+    std::vector<std::unique_ptr<NPC>> npcs;
+    for (int i = 0; i < 120; ++i) {
+        std::string name = "NPC_" + std::to_string(i);
+        Point position(coord(rng), coord(rng));
+        if (i % 3 == 0) npcs.push_back(std::make_unique<Orc>(name, position));
+        else if (i % 3 == 1) npcs.push_back(std::make_unique<Druid>(name, position));
+        else npcs.push_back(std::make_unique<Squirrel>(name, position));
+    }
+    std::vector<NPCVariant> variants;
+    for (auto& npc : npcs) variants.push_back(to_variant(*npc));
+    
+    RecordingObserver virtual_log;
+    RecordingObserver variant_log;
+    BattleVisitor visitor(5.0);
+    visitor.subscribe(&virtual_log);
+    VariantBattle battle(5.0);
+    battle.subscribe(&variant_log);
+    EXPECT_EQ(battle.get_radius(), 5.0);
+    
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        for (size_t j = i + 1; j < npcs.size(); ++j) {
+            visitor.set_attacker(npcs[i].get());
+            npcs[j]->accept(visitor);
+            battle.fight(variants[i], variants[j]);
+        }
+    }
+    
+    EXPECT_FALSE(variant_log.actions.empty());
+    EXPECT_EQ(variant_log.actions, virtual_log.actions);
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        EXPECT_EQ(as_npc(variants[i]).is_alive(), npcs[i]->is_alive());
+        EXPECT_EQ(as_npc(variants[i]).get_type(), npcs[i]->get_type());
+    }
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "../include/game/game.h"
+#include "../include/game/placement.h"
+#include "../include/npc/npc_arena.h"
+#include "../include/npc/orc.h"
+#include "../include/npc/squirrel.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(PlacementTest, ParsesSysfsCpuLists) {
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parse_cpu_list("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+    EXPECT_THROW(parse_cpu_list("3-1"), std::invalid_argument);
+    EXPECT_THROW(parse_cpu_list("0-x"), std::invalid_argument);
+}
+
+TEST(PlacementTest, TopologyHasUsableNode) {
+    NumaTopology topology = NumaTopology::detect();
+    ASSERT_FALSE(topology.nodes().empty());
+    const NumaNode& first = topology.nodes().front();
+    EXPECT_EQ(topology.find(first.id), &first);
+    EXPECT_EQ(topology.find(-5), nullptr);
+    
+    // Привязка проверяется на отдельном потоке: главный поток gtest остается свободным
+    std::thread scratch([&] {
+        EXPECT_NO_THROW(pin_current_thread(first.cpus));
+        EXPECT_THROW(pin_current_thread({}), std::runtime_error);
+    });
+    scratch.join();
+}
+
+TEST(NPCArenaTest, NPCsLiveInScopedHeapAndReuseBlocks) {
+    NPCArena::HeapLease heap = NPCArena::instance().acquire();
+    void* first = nullptr;
+    {
+        NPCArena::Scope scope(*heap);
+        auto orc = std::make_unique<Orc>("Орк_1", Point(1, 1));
+        std::unique_ptr<NPC> squirrel = std::make_unique<Squirrel>("Белка_1", Point(2, 2));
+        EXPECT_EQ(heap->objects_in_use(), 2u);
+        EXPECT_TRUE(NPCArena::owns(orc.get()));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(orc.get()) % alignof(Orc), 0u);
+        first = orc.get();
+    }
+    EXPECT_EQ(heap->objects_in_use(), 0u);
+    EXPECT_GE(heap->reserved_bytes(), NPCArena::CHUNK_BYTES);
+
+    // Освобожденный блок класса выдается снова
+    NPCArena::Scope scope(*heap);
+    auto again = std::make_unique<Orc>("Орк_2", Point(0, 0));
+    EXPECT_EQ(static_cast<void*>(again.get()), first);
+}
+
+TEST(NPCArenaTest, OutsideScopeNPCsUseOrdinaryHeap) {
+    EXPECT_EQ(NPCArena::current(), nullptr);
+    auto orc = std::make_unique<Orc>("Орк", Point(1, 1));
+    EXPECT_FALSE(NPCArena::owns(orc.get()));
+
+    NPCArena::HeapLease outer = NPCArena::instance().acquire();
+    NPCArena::HeapLease inner = NPCArena::instance().acquire();
+    {
+        NPCArena::Scope a(*outer);
+        {
+            NPCArena::Scope b(*inner);
+            EXPECT_EQ(NPCArena::current(), inner.get());
+        }
+        {
+            NPCArena::Scope plain(nullptr); // игра без области арены
+            auto other = std::make_unique<Orc>("Орк", Point(2, 2));
+            EXPECT_FALSE(NPCArena::owns(other.get()));
+        }
+        EXPECT_EQ(NPCArena::current(), outer.get());
+    }
+    EXPECT_EQ(NPCArena::current(), nullptr);
+}
+
+TEST(NPCArenaTest, BlockReturnsToOwningHeapFromAnyThread) {
+    NPCArena::HeapLease owner = NPCArena::instance().acquire();
+    NPCArena::HeapLease other = NPCArena::instance().acquire();
+    std::unique_ptr<NPC> orc;
+    {
+        NPCArena::Scope scope(*owner);
+        orc = std::make_unique<Orc>("Орк", Point(3, 3));
+    }
+    std::thread releaser([&] {
+        NPCArena::Scope scope(*other); // область потока не важна - блок знает владельца
+        orc.reset();
+    });
+    releaser.join();
+    EXPECT_EQ(owner->objects_in_use(), 0u);
+    EXPECT_EQ(other->objects_in_use(), 0u);
+}
+
+TEST(NPCArenaTest, ReleasedHeapIsReusedWithDefaultSettings) {
+    NPCArena& arena = NPCArena::instance();
+    int node = NumaTopology::detect().nodes().front().id;
+    NPCHeap* released = nullptr;
+    {
+        NPCArena::HeapLease heap = arena.acquire();
+        heap->set_huge_pages(HugePages::Transparent);
+        heap->bind_to_node(node);
+        released = heap.get();
+    }
+    size_t heaps = arena.heap_count();
+    NPCArena::HeapLease again = arena.acquire();
+    EXPECT_EQ(again.get(), released);
+    EXPECT_EQ(arena.heap_count(), heaps);
+    EXPECT_EQ(again->huge_pages(), HugePages::None);
+    EXPECT_EQ(again->bound_node(), -1);
+}
+
+TEST(NPCArenaTest, HugePagesAndBindingKeepAllocationsWorking) {
+    NPCArena::HeapLease heap = NPCArena::instance().acquire();
+    int node = NumaTopology::detect().nodes().front().id;
+
+    heap->set_huge_pages(HugePages::Explicit);
+    heap->bind_to_node(node);
+    EXPECT_EQ(heap->huge_pages(), HugePages::Explicit);
+    EXPECT_EQ(heap->bound_node(), node);
+    EXPECT_THROW(heap->bind_to_node(NPCArena::MAX_NODES), std::invalid_argument);
+
+    // Больше куска: область отображает новые куски в режиме Explicit
+    // (без резерва hugetlbfs - прозрачные большие страницы)
+    NPCArena::Scope scope(*heap);
+    std::vector<std::unique_ptr<Orc>> orcs;
+    size_t chunks = NPCArena::CHUNK_BYTES / sizeof(Orc) + 1;
+    for (size_t i = 0; i < chunks; ++i) {
+        orcs.push_back(std::make_unique<Orc>("Орк", Point(static_cast<int>(i % 50), 0)));
+    }
+    EXPECT_EQ(orcs.back()->get_position().get_x(), static_cast<int>((chunks - 1) % 50));
+    EXPECT_GE(heap->reserved_bytes(), 2 * NPCArena::CHUNK_BYTES);
+    EXPECT_EQ(heap->objects_in_use(), chunks);
+
+    std::vector<size_t> pages = heap->pages_per_node();
+    if (!pages.empty()) {
+        EXPECT_GT(std::accumulate(pages.begin(), pages.end(), size_t{0}), 0u);
+    }
+}
+
+TEST(GamePlacementTest, PinnedThreadsRunAndStopCleanly) {
+    int node = NumaTopology::detect().nodes().front().id;
+    Game game(5, true);
+    Game neighbour(6, true);
+    EXPECT_THROW(game.set_placement(PlacementOptions{1000, -1, -1, HugePages::None}), std::invalid_argument);
+    // Без больших страниц и узла памяти арена не нужна
+    game.set_placement(PlacementOptions{-1, node, node, HugePages::None});
+    EXPECT_EQ(game.npc_memory(), nullptr);
+
+    // Первый запрос берет область и переносит в нее уже созданных NPC
+    game.set_placement(PlacementOptions{node, node, node, HugePages::Transparent});
+    ASSERT_NE(game.npc_memory(), nullptr);
+    EXPECT_EQ(game.npc_memory()->objects_in_use(), game.snapshot()->npcs.size());
+    EXPECT_EQ(game.npc_memory()->bound_node(), node);
+    EXPECT_EQ(neighbour.npc_memory(), nullptr); // память другой игры не тронута
+    game.set_timing(std::chrono::milliseconds(2), std::chrono::milliseconds(100));
+    game.start();
+
+    EXPECT_GT(game.snapshot()->tick, 0u);
+    EXPECT_EQ(game.snapshot()->alive_count(), game.get_survivors().size());
+}
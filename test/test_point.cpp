@@ -146,4 +146,47 @@ TEST(PointTest, Test13) {
     p.set_y(20);
     EXPECT_EQ(p.get_x(), 10);
     EXPECT_EQ(p.get_y(), 20);
-}
\ No newline at end of file
+}
+TEST(PointTest, DistanceSq) {
+    constexpr Point origin(0, 0);
+    constexpr Point p(3, 4);
+    static_assert(origin.distance_sq(p) == 25);
+    
+    EXPECT_EQ(p.distance_sq(origin), 25);
+    EXPECT_EQ(Point(-2, 5).distance_sq(Point(3, -1)), 61);
+    EXPECT_EQ(Point(-50000, 0).distance_sq(Point(50000, 0)), 10000000000LL);
+}
+
+TEST(PointTest, Within) {
+    constexpr Point origin(0, 0);
+    static_assert(origin.within(Point(10, 0), 10));
+    static_assert(!origin.within(Point(10, 1), 10));
+    
+    EXPECT_TRUE(origin.within(Point(6, 8), 10));
+    EXPECT_FALSE(origin.within(Point(6, 9), 10));
+    EXPECT_TRUE(origin.within(Point(0, 0), 0));
+    EXPECT_FALSE(origin.within(Point(0, 0), -1));
+    EXPECT_TRUE(origin.within(Point(1, 1), 1.5));
+    EXPECT_FALSE(origin.within(Point(1, 1), 1.4));
+}
+
+TEST(PointTest, BatchOperations) {
+    const Point origin(0, 0);
+    const Point points[] = {Point(1, 0), Point(10, 10), Point(3, 4), Point(-5, 0)};
+    
+    int64_t distances[4] = {};
+    distance_sq_batch(origin, points, distances);
+    EXPECT_EQ(distances[0], 1);
+    EXPECT_EQ(distances[1], 200);
+    EXPECT_EQ(distances[2], 25);
+    EXPECT_EQ(distances[3], 25);
+    
+    EXPECT_EQ(count_within(origin, points, 5), 3u);
+    
+    uint32_t indices[4] = {};
+    size_t found = select_within(origin, points, 5, indices);
+    ASSERT_EQ(found, 3u);
+    EXPECT_EQ(indices[0], 0u);
+    EXPECT_EQ(indices[1], 2u);
+    EXPECT_EQ(indices[2], 3u);
+}
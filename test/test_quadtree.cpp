@@ -0,0 +1,103 @@
+#include "../include/geometry/quadtree.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Item {
+    Point position;
+    int id;
+};
+
+std::vector<int> ids_of(std::vector<int> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+TEST(QuadtreeTest, RectQueryMatchesBruteForce) {
+    PointQuadtree<Item> tree(4);
+    std::vector<Item> items;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> coord(-1000, 1000);
+    for (int id = 0; id < 3000; ++id) {
+        items.push_back({Point(coord(rng), coord(rng)), id});
+        tree.insert(items.back());
+    }
+    EXPECT_EQ(tree.size(), items.size());
+    
+    for (int query = 0; query < 50; ++query) {
+        int x0 = coord(rng), y0 = coord(rng);
+        int x1 = x0 + static_cast<int>(rng() % 400), y1 = y0 + static_cast<int>(rng() % 400);
+        
+        std::vector<int> found, expected;
+        tree.for_each_in_rect(x0, y0, x1, y1, [&found](const Item& item) { found.push_back(item.id); });
+        for (const auto& item : items) {
+            int x = item.position.get_x(), y = item.position.get_y();
+            if (x >= x0 && x <= x1 && y >= y0 && y <= y1) expected.push_back(item.id);
+        }
+        EXPECT_EQ(ids_of(found), ids_of(expected));
+    }
+}
+
+TEST(QuadtreeTest, NearestIsSortedAndExact) {
+    PointQuadtree<Item> tree;
+    std::vector<Item> items;
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> coord(0, 5000);
+    for (int id = 0; id < 5000; ++id) {
+        items.push_back({Point(coord(rng), coord(rng)), id});
+        tree.insert(items.back());
+    }
+    
+    Point target(2500, 2500);
+    auto nearest = tree.nearest(target, 10);
+    ASSERT_EQ(nearest.size(), 10u);
+    
+    std::vector<int64_t> distances;
+    for (const auto& item : items) distances.push_back(item.position.distance_sq(target));
+    std::sort(distances.begin(), distances.end());
+    for (size_t i = 0; i < nearest.size(); ++i) {
+        EXPECT_EQ(nearest[i]->position.distance_sq(target), distances[i]);
+    }
+    EXPECT_EQ(tree.nearest(target, 100000).size(), items.size());
+}
+
+TEST(QuadtreeTest, RemoveCollapsesAndKeepsOthers) {
+    PointQuadtree<Item> tree(2);
+    std::vector<Item> items;
+    for (int id = 0; id < 200; ++id) {
+        items.push_back({Point(id % 20, id / 20), id});
+        tree.insert(items.back());
+    }
+    // Несколько элементов в одной точке
+    tree.insert({Point(5, 5), 1000});
+    tree.insert({Point(5, 5), 1001});
+    
+    EXPECT_TRUE(tree.remove(Point(5, 5), [](const Item& item) { return item.id == 1001; }));
+    EXPECT_FALSE(tree.remove(Point(5, 5), [](const Item& item) { return item.id == 1001; }));
+    for (int id = 0; id < 200; id += 2) {
+        EXPECT_TRUE(tree.remove(items[id].position, [id](const Item& item) { return item.id == id; }));
+    }
+    EXPECT_EQ(tree.size(), 101u);
+    
+    std::vector<int> found;
+    tree.for_each_in_rect(-100, -100, 100, 100, [&found](const Item& item) { found.push_back(item.id); });
+    std::vector<int> expected = {1000};
+    for (int id = 1; id < 200; id += 2) expected.push_back(id);
+    EXPECT_EQ(ids_of(found), ids_of(expected));
+}
+
+TEST(QuadtreeTest, RadiusQueryIsInclusive) {
+    PointQuadtree<Item> tree;
+    tree.insert({Point(0, 0), 0});
+    tree.insert({Point(3, 4), 1});   // ровно 5
+    tree.insert({Point(4, 4), 2});   // дальше 5
+    
+    std::vector<int> found;
+    tree.for_each_in_radius(Point(0, 0), 5.0, [&found](const Item& item) { found.push_back(item.id); });
+    EXPECT_EQ(ids_of(found), (std::vector<int>{0, 1}));
+}
@@ -0,0 +1,151 @@
+#include "../include/shard/shard_launcher.h"
+#include "../include/game/kill_matrix.h"
+#include "../include/npc/npc_factory.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <sys/socket.h>
+
+namespace {
+
+ShardConfig small_world(int shards) {
+    ShardConfig config;
+    config.seed = 7;
+    config.width = 200;
+    config.height = 200;
+    config.npc_count = 1500;
+    config.shards = shards;
+    return config;
+}
+
+} // namespace
+
+TEST(StripShardTest, StripsCoverMapOnce) {
+    ShardConfig config = small_world(3);
+    size_t total = 0;
+    int expected_begin = 0;
+    for (int i = 0; i < config.shards; ++i) {
+        StripShard shard(config, i);
+        EXPECT_EQ(shard.row_begin(), expected_begin);
+        expected_begin = shard.row_end();
+        for (const ShardNPC& npc : shard.owned()) {
+            EXPECT_GE(npc.position.get_y(), shard.row_begin());
+            EXPECT_LT(npc.position.get_y(), shard.row_end());
+        }
+        total += shard.owned().size();
+    }
+    EXPECT_EQ(expected_begin, config.height);
+    EXPECT_EQ(total, config.npc_count);
+}
+
+TEST(StripShardTest, RejectsStripsThinnerThanMove) {
+    ShardConfig config = small_world(20); // 10 строк меньше хода орка
+    EXPECT_THROW(StripShard(config, 0), std::invalid_argument);
+    EXPECT_THROW(ShardLauncher::run(config, 1), std::invalid_argument);
+    EXPECT_THROW(StripShard(small_world(2), 2), std::invalid_argument);
+}
+
+// Полосы и Game пользуются одними правилами типов
+TEST(StripShardTest, RulesMatchGameKillMatrix) {
+    NPCFactory factory;
+    KillMatrix game_rules(factory);
+    const KillMatrix& shard_rules = KillMatrix::closed_set();
+    ASSERT_EQ(shard_rules.type_count(), game_rules.type_count());
+    for (size_t a = 0; a < shard_rules.type_count(); ++a) {
+        EXPECT_EQ(StripShard::type_name(static_cast<uint8_t>(a)), shard_rules.type_name(a));
+        int ga = game_rules.type_index(shard_rules.type_name(a));
+        ASSERT_GE(ga, 0) << shard_rules.type_name(a);
+        EXPECT_EQ(shard_rules.kill_distance(a), game_rules.kill_distance(ga));
+        EXPECT_EQ(shard_rules.move_distance(a), game_rules.move_distance(ga));
+        for (size_t t = 0; t < shard_rules.type_count(); ++t) {
+            int gt = game_rules.type_index(shard_rules.type_name(t));
+            EXPECT_EQ(shard_rules.can_kill(a, t), game_rules.can_kill(ga, gt));
+        }
+    }
+    EXPECT_EQ(StripShard::halo_distance(), game_rules.max_kill_distance());
+    EXPECT_THROW(StripShard::type_name(static_cast<uint8_t>(shard_rules.type_count())), std::out_of_range);
+}
+
+// Бои одной полосы против перебора всех пар без сетки и ореола
+TEST(StripShardTest, BattlesMatchBruteForce) {
+    ShardConfig config = small_world(1);
+    const KillMatrix& rules = KillMatrix::closed_set();
+    StripShard shard(config, 0);
+    size_t total_kills = 0;
+
+    for (uint64_t tick = 0; tick < 20; ++tick) {
+        shard.move();
+        std::vector<ShardNPC> before = shard.owned();
+        std::vector<ShardNPC> expected;
+        for (const ShardNPC& target : before) {
+            bool killed = false;
+            for (const ShardNPC& attacker : before) {
+                if (rules.can_kill(attacker.type, target.type) &&
+                    attacker.position.within(target.position, rules.kill_distance(attacker.type)) &&
+                    StripShard::attack_wins(config.seed, tick, attacker.id, target.id)) {
+                    killed = true;
+                    break;
+                }
+            }
+            if (!killed) expected.push_back(target);
+        }
+        total_kills += before.size() - expected.size();
+
+        shard.resolve_battles({});
+        std::vector<ShardNPC> actual = shard.owned();
+        auto by_id = [](const ShardNPC& a, const ShardNPC& b) { return a.id < b.id; };
+        std::sort(expected.begin(), expected.end(), by_id);
+        std::sort(actual.begin(), actual.end(), by_id);
+        ASSERT_EQ(actual, expected) << "тик " << tick;
+    }
+    EXPECT_GT(total_kills, 0u);
+}
+
+TEST(ShardLinkTest, ExchangeLargeMessagesBothWays) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ShardLink left(fds[0]);
+    ShardLink right(fds[1]);
+
+    // Больше буфера сокета: встречная блокирующая отправка зависла бы
+    std::vector<ShardNPC> npcs(200000);
+    for (uint32_t i = 0; i < npcs.size(); ++i) {
+        npcs[i].id = i;
+        npcs[i].type = static_cast<uint8_t>(i % 3);
+        npcs[i].position = Point(static_cast<int>(i % 1000), -static_cast<int>(i / 1000));
+    }
+    std::vector<uint8_t> payload;
+    ByteWriter writer(payload);
+    ShardLink::encode(npcs, writer);
+
+    left.post(payload);
+    right.post(payload);
+    std::thread peer([&right]() { ShardLink::exchange({&right}); });
+    ShardLink::exchange({&left});
+    peer.join();
+
+    for (ShardLink* link : {&left, &right}) {
+        std::vector<ShardNPC> decoded;
+        ByteReader reader(link->received().data(), link->received().size(), "test");
+        ShardLink::decode(reader, decoded);
+        EXPECT_TRUE(reader.done());
+        EXPECT_EQ(decoded, npcs);
+    }
+}
+
+TEST(ShardLauncherTest, ShardedRunMatchesSingleProcess) {
+    const int ticks = 30;
+    ShardedRunResult single = ShardLauncher::run_single_process(small_world(1), ticks);
+    ASSERT_FALSE(single.summary.kills.empty());
+    ASSERT_LT(single.survivors.size(), small_world(1).npc_count);
+
+    for (int shards : {2, 4}) {
+        ShardedRunResult sharded = ShardLauncher::run(small_world(shards), ticks);
+        EXPECT_GT(sharded.migrations, 0u);
+        EXPECT_GT(sharded.halo_records, 0u);
+        EXPECT_EQ(sharded.survivors, single.survivors) << shards << " полос";
+        EXPECT_EQ(sharded.summary.kills, single.summary.kills) << shards << " полос";
+        EXPECT_EQ(sharded.summary.survivors, single.summary.survivors);
+    }
+}
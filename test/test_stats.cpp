@@ -0,0 +1,156 @@
+#include "../include/battle/battle_stats.h"
+#include "../include/battle/battle_event.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+BattleEvent make_event(const std::string& attacker, const std::string& target,
+                       int x, int y, int attack, int defense, bool killed, uint64_t tick) {
+    BattleEvent event;
+    event.attacker_type = attacker;
+    event.target_type = target;
+    event.location = Point(x, y);
+    event.attack_roll = attack;
+    event.defense_roll = defense;
+    event.killed = killed;
+    event.tick = tick;
+    return event;
+}
+
+std::string read_file(const std::string& filename) {
+    std::ifstream file(filename);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+} // namespace
+
+TEST(BattleStatsTest, EmptySummary) {
+    BattleStats stats(50, 50, 10);
+    auto summary = stats.summary();
+    
+    EXPECT_EQ(summary.fights, 0u);
+    EXPECT_TRUE(summary.kills.empty());
+    EXPECT_EQ(summary.regions_x, 5);
+    EXPECT_EQ(summary.regions_y, 5);
+    EXPECT_EQ(summary.heatmap.size(), 25u);
+}
+
+TEST(BattleStatsTest, KillsDiceAndHeatmap) {
+    BattleStats stats(50, 50, 10);
+    
+    stats.notify(make_event("Орк", "Друид", 5, 5, 6, 2, true, 1));
+    stats.notify(make_event("Орк", "Друид", 15, 5, 1, 3, false, 1));
+    stats.notify(make_event("Друид", "Белка", 49, 49, 4, 3, true, 2));
+    
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.fights, 3u);
+    EXPECT_EQ((summary.kills[{"Орк", "Друид"}]), 1u);
+    EXPECT_EQ((summary.kills[{"Друид", "Белка"}]), 1u);
+    EXPECT_EQ(summary.attack_rolls[5], 1u);
+    EXPECT_EQ(summary.attack_rolls[0], 1u);
+    EXPECT_EQ(summary.defense_rolls[2], 2u);
+    EXPECT_EQ(summary.heatmap[0], 1u);
+    EXPECT_EQ(summary.heatmap[1], 1u);
+    EXPECT_EQ(summary.heatmap[24], 1u);
+}
+
+TEST(BattleStatsTest, SurvivalCurve) {
+    BattleStats stats(50, 50, 10);
+    stats.add_population("Друид", 3);
+    
+    stats.notify(make_event("Орк", "Друид", 0, 0, 5, 1, true, 2));
+    stats.notify(make_event("Орк", "Друид", 0, 0, 5, 1, true, 2));
+    stats.notify(make_event("Орк", "Друид", 0, 0, 5, 1, true, 7));
+    
+    auto summary = stats.summary();
+    ASSERT_EQ(summary.survival.size(), 3u);
+    EXPECT_EQ(summary.survival[0].tick, 0u);
+    EXPECT_EQ(summary.survival[0].alive, 3);
+    EXPECT_EQ(summary.survival[1].tick, 2u);
+    EXPECT_EQ(summary.survival[1].alive, 1);
+    EXPECT_EQ(summary.survival[2].tick, 7u);
+    EXPECT_EQ(summary.survival[2].alive, 0);
+}
+
+TEST(BattleStatsTest, PerThreadAccumulatorsMergeOnRead) {
+    BattleStats stats(50, 50, 10);
+    const int threads_count = 4;
+    const int events_per_thread = 1000;
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&stats, t]() {
+            for (int i = 0; i < events_per_thread; ++i) {
+                stats.notify(make_event("Орк", "Друид", t * 10, 0, 1 + i % 6, 1, i % 2 == 0, i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.fights, static_cast<uint64_t>(threads_count * events_per_thread));
+    EXPECT_EQ((summary.kills[{"Орк", "Друид"}]), static_cast<uint64_t>(threads_count * events_per_thread / 2));
+    for (int t = 0; t < threads_count; ++t) {
+        EXPECT_EQ(summary.heatmap[t], static_cast<uint64_t>(events_per_thread));
+    }
+}
+
+// Шард завершившегося потока переходит к следующему писателю вместе с данными
+TEST(BattleStatsTest, FinishedThreadShardIsReused) {
+    BattleStats stats(50, 50, 10);
+    const int rounds = 8;
+    for (int t = 0; t < rounds; ++t) {
+        std::thread([&stats, t]() {
+            stats.notify(make_event(t % 2 ? "Орк" : "Друид", "Белка", 0, 0, 6, 1, true, t));
+        }).join();
+    }
+    EXPECT_EQ(stats.shard_count(), 1u);
+
+    // Экземпляр, разрушенный после записи, не мешает новому
+    {
+        BattleStats temporary(50, 50, 10);
+        temporary.notify(make_event("Орк", "Друид", 0, 0, 6, 1, true, 0));
+    }
+    BattleStats fresh(50, 50, 10);
+    fresh.notify(make_event("Орк", "Друид", 0, 0, 6, 1, true, 0));
+    EXPECT_EQ(fresh.summary().fights, 1u);
+
+    auto summary = stats.summary();
+    EXPECT_EQ(summary.fights, static_cast<uint64_t>(rounds));
+    EXPECT_EQ((summary.kills[{"Орк", "Белка"}]), static_cast<uint64_t>(rounds / 2));
+    EXPECT_EQ((summary.kills[{"Друид", "Белка"}]), static_cast<uint64_t>(rounds / 2));
+}
+
+TEST(BattleStatsTest, ExportCsvAndJson) {
+    const std::string csv_file = "stats_test.csv";
+    const std::string json_file = "stats_test.json";
+    
+    BattleStats stats(20, 20, 10);
+    stats.add_population("Белка", 1);
+    stats.notify(make_event("Друид", "Белка", 3, 3, 5, 2, true, 4));
+    
+    stats.export_csv(csv_file);
+    stats.export_json(json_file);
+    
+    std::string csv = read_file(csv_file);
+    EXPECT_NE(csv.find("section,key,subkey,value"), std::string::npos);
+    EXPECT_NE(csv.find("kills,Друид,Белка,1"), std::string::npos);
+    EXPECT_NE(csv.find("survival,Белка,4,0"), std::string::npos);
+    EXPECT_NE(csv.find("heatmap,0,0,1"), std::string::npos);
+    
+    std::string json = read_file(json_file);
+    EXPECT_NE(json.find("\"fights\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"killer\": \"Друид\""), std::string::npos);
+    EXPECT_NE(json.find("\"attack_rolls\": [0, 0, 0, 0, 1, 0]"), std::string::npos);
+    
+    std::remove(csv_file.c_str());
+    std::remove(json_file.c_str());
+}
@@ -0,0 +1,219 @@
+#include "../include/stream/frame_codec.h"
+#include "../include/stream/world_streamer.h"
+#include "../include/game/game.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Применяет все кадры буфера (с префиксами длины) к декодеру
+size_t apply_frames(FrameDecoder& decoder, const std::vector<uint8_t>& buffer) {
+    size_t offset = 0;
+    size_t count = 0;
+    while (offset + 4 <= buffer.size()) {
+        uint32_t length = 0;
+        std::memcpy(&length, buffer.data() + offset, sizeof(length));
+        decoder.apply(buffer.data() + offset + 4, length);
+        offset += 4 + length;
+        ++count;
+    }
+    return count;
+}
+
+void expect_matches(const FrameDecoder& decoder, const WorldSnapshot& snapshot) {
+    EXPECT_EQ(decoder.state().size(), snapshot.alive_count());
+    for (const auto& npc : snapshot.npcs) {
+        if (!npc.alive) continue;
+        auto it = decoder.state().find(npc.handle.index);
+        ASSERT_NE(it, decoder.state().end());
+        EXPECT_EQ(it->second.type, snapshot.type_name(npc));
+        EXPECT_EQ(it->second.name, WorldSnapshot::name_of(npc));
+        EXPECT_EQ(it->second.x, npc.position.get_x());
+        EXPECT_EQ(it->second.y, npc.position.get_y());
+    }
+}
+
+std::shared_ptr<WorldSnapshot> make_snapshot(uint64_t tick, size_t count, int shift) {
+    auto snapshot = std::make_shared<WorldSnapshot>();
+    snapshot->tick = tick;
+    snapshot->types = std::make_shared<const std::vector<std::string>>(1, "Orc");
+    for (size_t i = 0; i < count; ++i) {
+        NPCState state;
+        state.handle = NPCHandle{static_cast<uint32_t>(i), 0};
+        state.name = std::make_shared<const std::string>("NPC_" + std::to_string(i));
+        state.position = Point(static_cast<int>(i % 500) + shift, static_cast<int>(i / 500));
+        state.alive = true;
+        snapshot->npcs.push_back(state);
+    }
+    return snapshot;
+}
+
+int connect_to(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string socket_path(const char* name) {
+    return "/tmp/lab6_" + std::string(name) + "_" + std::to_string(::getpid()) + ".sock";
+}
+
+} // namespace
+
+TEST(FrameCodecTest, KeyframeAndDeltasReproduceGame) {
+    Game game(42, true);
+    auto previous = game.snapshot();
+    
+    std::vector<uint8_t> buffer;
+    FrameEncoder::encode_keyframe(*previous, buffer);
+    FrameDecoder decoder;
+    apply_frames(decoder, buffer);
+    expect_matches(decoder, *previous);
+    
+    for (int tick = 0; tick < 30; ++tick) {
+        game.step();
+        auto current = game.snapshot();
+        buffer.clear();
+        FrameEncoder::encode_delta(*previous, *current, buffer);
+        apply_frames(decoder, buffer);
+        expect_matches(decoder, *current);
+        previous = current;
+    }
+}
+
+// Между кадрами NPC гибнет, уплотнение освобождает его слот, спавн занимает слот заново
+TEST(FrameCodecTest, RecycledSlotBetweenFramesKeepsNewNPC) {
+    Game game(33, true);
+    auto previous = game.snapshot();
+    std::vector<uint8_t> buffer;
+    FrameEncoder::encode_keyframe(*previous, buffer);
+    FrameDecoder decoder;
+    apply_frames(decoder, buffer);
+
+    size_t recycled = 0;
+    int spawned = 0;
+    for (int tick = 1; tick <= 300; ++tick) {
+        game.step();
+        for (size_t i = game.snapshot()->alive_count(); i < static_cast<size_t>(Game::NUM_NPCS); ++i) {
+            game.spawn("Белка", "Новичок_" + std::to_string(spawned), Point(spawned % 50, tick % 50));
+            ++spawned;
+        }
+        if (tick % 5 != 0) continue; // несколько тиков на кадр: гибель, уплотнение и спавн
+
+        auto current = game.snapshot();
+        for (const auto& old : previous->npcs) {
+            for (const auto& npc : current->npcs) {
+                if (old.alive && npc.alive && old.handle.index == npc.handle.index &&
+                    old.handle.generation != npc.handle.generation) {
+                    ++recycled;
+                }
+            }
+        }
+        buffer.clear();
+        FrameEncoder::encode_delta(*previous, *current, buffer);
+        apply_frames(decoder, buffer);
+        expect_matches(decoder, *current);
+        previous = current;
+    }
+    EXPECT_GT(recycled, 0u);
+}
+
+TEST(FrameCodecTest, DeltaIsSmallerThanKeyframe) {
+    auto first = make_snapshot(1, 1000, 0);
+    auto second = make_snapshot(2, 1000, 0);
+    second->npcs[3].position = Point(10, 10);
+    second->npcs[7].alive = false;
+    
+    std::vector<uint8_t> key, delta;
+    FrameEncoder::encode_keyframe(*second, key);
+    FrameEncoder::encode_delta(*first, *second, delta);
+    EXPECT_LT(delta.size() * 100, key.size());
+    
+    FrameDecoder decoder;
+    std::vector<uint8_t> start;
+    FrameEncoder::encode_keyframe(*first, start);
+    apply_frames(decoder, start);
+    auto info = decoder.apply(delta.data() + 4, delta.size() - 4);
+    EXPECT_FALSE(info.keyframe);
+    EXPECT_EQ(info.moved, 1u);
+    EXPECT_EQ(info.died, 1u);
+    expect_matches(decoder, *second);
+}
+
+TEST(FrameCodecTest, CorruptedFrameThrows) {
+    std::vector<uint8_t> buffer;
+    FrameEncoder::encode_keyframe(*make_snapshot(1, 10, 0), buffer);
+    
+    FrameDecoder decoder;
+    EXPECT_THROW(decoder.apply(buffer.data() + 4, buffer.size() / 2), std::runtime_error);
+    
+    buffer[4] ^= 0xFF; // испорченная сигнатура
+    EXPECT_THROW(decoder.apply(buffer.data() + 4, buffer.size() - 4), std::runtime_error);
+}
+
+TEST(WorldStreamerTest, ClientReceivesKeyframeThenDeltas) {
+    std::string path = socket_path("stream");
+    WorldStreamer streamer(path);
+    int fd = connect_to(path);
+    ASSERT_GE(fd, 0);
+    
+    auto first = make_snapshot(1, 20, 0);
+    auto second = make_snapshot(2, 20, 1);
+    streamer.publish(first);
+    streamer.publish(first); // тот же снимок - без кадра
+    streamer.publish(second);
+    EXPECT_EQ(streamer.frames_sent(), 2u);
+    EXPECT_EQ(streamer.client_count(), 1u);
+    
+    std::vector<uint8_t> received(1 << 16);
+    size_t total = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    FrameDecoder decoder;
+    while (std::chrono::steady_clock::now() < deadline) {
+        ssize_t got = ::recv(fd, received.data() + total, received.size() - total, MSG_DONTWAIT);
+        if (got > 0) total += static_cast<size_t>(got);
+        std::vector<uint8_t> chunk(received.begin(), received.begin() + total);
+        FrameDecoder probe;
+        if (total > 0 && apply_frames(probe, chunk) == 2) {
+            apply_frames(decoder, chunk);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    expect_matches(decoder, *second);
+    ::close(fd);
+}
+
+TEST(WorldStreamerTest, SlowConsumerIsDropped) {
+    std::string path = socket_path("slow");
+    WorldStreamer streamer(path);
+    int fd = connect_to(path); // клиент никогда не читает
+    ASSERT_GE(fd, 0);
+    
+    // Большие ключевые кадры быстро переполняют буфер сокета
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < 200 && streamer.dropped_clients() == 0; ++tick) {
+        auto snapshot = make_snapshot(tick, 5000, static_cast<int>(tick % 2));
+        streamer.publish(snapshot);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    EXPECT_EQ(streamer.dropped_clients(), 1u);
+    EXPECT_EQ(streamer.client_count(), 0u);
+    EXPECT_LT(elapsed, std::chrono::seconds(5)); // публикация не блокируется
+    ::close(fd);
+}
@@ -0,0 +1,182 @@
+#include "../include/game/terrain.h"
+#include "../include/game/game.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+
+namespace {
+
+// Эталон: клетка за клеткой по тому же отрезку
+bool reference_sight(const TerrainMap& map, const Point& a, const Point& b) {
+    for (const Point& p : map.line_cells(a, b)) {
+        if (map.cell(p.get_x(), p.get_y()) == TerrainMap::Cell::WALL) return false;
+    }
+    return true;
+}
+
+// Эталон walk: последняя проходимая клетка из line_cells
+Point reference_walk(const TerrainMap& map, const Point& from, const Point& to) {
+    Point reached = from;
+    if (!map.is_passable(from)) return reached;
+    std::vector<Point> cells = map.line_cells(from, to);
+    for (size_t i = 1; i < cells.size() && map.is_passable(cells[i]); ++i) {
+        reached = cells[i];
+    }
+    return reached;
+}
+
+} // namespace
+
+TEST(TerrainMapTest, LineCellsConnectEndpoints) {
+    TerrainMap map(300, 300);
+    std::vector<Point> cells = map.line_cells(Point(2, 3), Point(200, 40));
+    ASSERT_EQ(cells.size(), 199u);
+    EXPECT_EQ(cells.front().get_x(), 2);
+    EXPECT_EQ(cells.front().get_y(), 3);
+    EXPECT_EQ(cells.back().get_x(), 200);
+    EXPECT_EQ(cells.back().get_y(), 40);
+    for (size_t i = 1; i < cells.size(); ++i) {
+        EXPECT_LE(std::abs(cells[i].get_x() - cells[i - 1].get_x()), 1);
+        EXPECT_LE(std::abs(cells[i].get_y() - cells[i - 1].get_y()), 1);
+    }
+}
+
+TEST(TerrainMapTest, LineOfSightMatchesCellWalk) {
+    std::mt19937 rng(5);
+    TerrainMap map(300, 200);
+    std::uniform_int_distribution<int> x_dist(0, 299);
+    std::uniform_int_distribution<int> y_dist(0, 199);
+    for (int i = 0; i < 600; ++i) {
+        map.set(x_dist(rng), y_dist(rng), TerrainMap::Cell::WALL);
+    }
+    map.fill_rect(150, 20, 150, 180, TerrainMap::Cell::WALL);
+    map.fill_rect(10, 100, 60, 105, TerrainMap::Cell::WATER);
+    
+    size_t blocked = 0;
+    for (int i = 0; i < 20000; ++i) {
+        Point a(x_dist(rng), y_dist(rng));
+        Point b = i % 2 ? Point(x_dist(rng), y_dist(rng))
+                        : Point(std::clamp(a.get_x() + x_dist(rng) % 21 - 10, 0, 299),
+                                std::clamp(a.get_y() + y_dist(rng) % 21 - 10, 0, 199));
+        bool sight = map.line_of_sight(a, b);
+        ASSERT_EQ(sight, reference_sight(map, a, b))
+            << a.get_x() << "," << a.get_y() << " -> " << b.get_x() << "," << b.get_y();
+        ASSERT_EQ(sight, map.line_of_sight(b, a));
+        Point walked = map.walk(a, b);
+        Point expected = reference_walk(map, a, b);
+        ASSERT_EQ(walked.get_x(), expected.get_x());
+        ASSERT_EQ(walked.get_y(), expected.get_y());
+        if (!sight) ++blocked;
+    }
+    EXPECT_GT(blocked, 0u);
+    EXPECT_FALSE(map.line_of_sight(Point(-1, 0), Point(5, 5)));
+}
+
+TEST(TerrainMapTest, WaterBlocksMovementButNotSight) {
+    TerrainMap map(50, 50);
+    map.fill_rect(20, 0, 20, 49, TerrainMap::Cell::WATER);
+    map.fill_rect(0, 30, 49, 30, TerrainMap::Cell::WALL);
+    
+    EXPECT_TRUE(map.line_of_sight(Point(10, 10), Point(30, 10)));
+    Point stop = map.walk(Point(10, 10), Point(30, 10));
+    EXPECT_EQ(stop.get_x(), 19);
+    EXPECT_EQ(stop.get_y(), 10);
+    
+    EXPECT_FALSE(map.line_of_sight(Point(10, 25), Point(10, 35)));
+    EXPECT_EQ(map.walk(Point(10, 25), Point(10, 35)).get_y(), 29);
+    
+    EXPECT_FALSE(map.is_passable(Point(20, 5)));
+    EXPECT_FALSE(map.is_passable(Point(50, 5)));
+    EXPECT_EQ(map.cell(20, 5), TerrainMap::Cell::WATER);
+    Point nearest = map.nearest_passable(Point(20, 5));
+    EXPECT_TRUE(map.is_passable(nearest));
+    EXPECT_EQ(std::abs(nearest.get_x() - 20), 1);
+}
+
+TEST(TerrainMapTest, SaveLoadRoundTrip) {
+    const std::string filename = "test_terrain.txt";
+    TerrainMap map(70, 9);
+    map.fill_rect(3, 2, 68, 2, TerrainMap::Cell::WALL);
+    map.set(0, 8, TerrainMap::Cell::WATER);
+    map.save(filename);
+    
+    TerrainMap loaded = TerrainMap::load(filename);
+    ASSERT_EQ(loaded.width(), 70);
+    ASSERT_EQ(loaded.height(), 9);
+    for (int y = 0; y < 9; ++y) {
+        for (int x = 0; x < 70; ++x) {
+            EXPECT_EQ(loaded.cell(x, y), map.cell(x, y));
+        }
+    }
+    
+    {
+        std::ofstream bad(filename);
+        bad << "3 2\n.#.\n.X.\n";
+    }
+    EXPECT_THROW(TerrainMap::load(filename), std::runtime_error);
+    
+    // Заголовок с "\r\n" и пробелами в конце читается, лишнее в нем - ошибка
+    {
+        std::ofstream crlf(filename, std::ios::binary);
+        crlf << "3 2  \r\n.#.\r\n~..\r\n";
+    }
+    TerrainMap windows = TerrainMap::load(filename);
+    EXPECT_EQ(windows.cell(1, 0), TerrainMap::Cell::WALL);
+    EXPECT_EQ(windows.cell(0, 1), TerrainMap::Cell::WATER);
+    {
+        std::ofstream bad(filename);
+        bad << "3 2 7\n.#.\n...\n";
+    }
+    EXPECT_THROW(TerrainMap::load(filename), std::runtime_error);
+    EXPECT_THROW(TerrainMap::load("no_such_terrain.txt"), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
+TEST(TerrainMapTest, LargeMapIsCompact) {
+    TerrainMap map(10000, 10000);
+    map.fill_rect(5000, 0, 5000, 9999, TerrainMap::Cell::WALL);
+    EXPECT_LE(map.memory_bytes(), 13u * 1000 * 1000);
+    EXPECT_FALSE(map.line_of_sight(Point(0, 7000), Point(9999, 3000)));
+    EXPECT_TRUE(map.line_of_sight(Point(0, 7000), Point(4999, 3000)));
+}
+
+// Стена поперек карты: NPC не переходят ее и не убивают сквозь нее
+TEST(GameTerrainTest, WallSplitsTheMap) {
+    TerrainMap map(Game::MAP_WIDTH, Game::MAP_HEIGHT);
+    map.fill_rect(25, 0, 25, Game::MAP_HEIGHT - 1, TerrainMap::Cell::WALL);
+    
+    Game game(12, true);
+    game.set_terrain(map);
+    std::map<uint32_t, bool> left_side;
+    for (const auto& state : game.snapshot()->npcs) {
+        ASSERT_TRUE(map.is_passable(state.position));
+        left_side[state.handle.index] = state.position.get_x() < 25;
+    }
+    
+    for (int tick = 0; tick < 60; ++tick) {
+        game.step();
+        for (const auto& state : game.snapshot()->npcs) {
+            if (!state.alive) continue;
+            ASSERT_TRUE(map.is_passable(state.position));
+            EXPECT_EQ(state.position.get_x() < 25, left_side[state.handle.index]);
+        }
+    }
+    
+    EXPECT_THROW(game.spawn("Орк", "В стене", Point(25, 10)), std::invalid_argument);
+    EXPECT_THROW(game.set_terrain(TerrainMap(10, 10)), std::invalid_argument);
+    
+    // Карта без проходимых клеток отвергается, прежний рельеф и позиции остаются
+    auto before = game.snapshot();
+    TerrainMap solid(Game::MAP_WIDTH, Game::MAP_HEIGHT);
+    solid.fill_rect(0, 0, Game::MAP_WIDTH - 1, Game::MAP_HEIGHT - 1, TerrainMap::Cell::WALL);
+    EXPECT_THROW(game.set_terrain(solid), std::runtime_error);
+    auto after = game.snapshot();
+    ASSERT_EQ(after->npcs.size(), before->npcs.size());
+    for (size_t i = 0; i < after->npcs.size(); ++i) {
+        EXPECT_EQ(after->npcs[i].position.get_x(), before->npcs[i].position.get_x());
+        EXPECT_EQ(after->npcs[i].position.get_y(), before->npcs[i].position.get_y());
+    }
+    EXPECT_THROW(game.spawn("Орк", "В стене", Point(25, 10)), std::invalid_argument);
+}